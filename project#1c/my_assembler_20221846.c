@@ -16,16 +16,261 @@
 #include <string.h>
 #include <stdbool.h>
 #include <ctype.h>
+#include <time.h>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
 
 /* 파일명의 "00000000"은 자신의 학번으로 변경할 것 */
 #include "my_assembler_20221846.h"
 
-#define HEADER_RECORD 'H'
-#define TEXT_RECORD 'T'
-#define END_RECORD 'E'
-#define DEFINE_RECORD 'D'
-#define REFERENCE_RECORD 'R'
-#define MODIFY_RECORD 'M'
+/** --stats로 출력할 단계별 시간과 카운터 */
+static assem_stats run_stats;
+
+/** 검색 함수의 호출 횟수를 셀지 여부 (--stats, 지정하지 않으면 검색 경로에서 세지 않는다) */
+static bool lookup_counting = false;
+
+/** 할당 위치별 기록을 남길지 여부 (--alloc-sites) */
+static bool alloc_tracking = false;
+
+/*
+ * NO_ASSEMBLER_INSTRUMENTATION을 정의하고 이 파일을 포함하면 (my_microbench_20221846.c)
+ * 검색 횟수 카운터와 할당 함수 래퍼를 빼고 컴파일하여 계측하지 않은 코드를 잰다.
+ */
+#ifdef NO_ASSEMBLER_INSTRUMENTATION
+#define COUNT_LOOKUP(counter) ((void)0)
+#else
+#define COUNT_LOOKUP(counter) ((void)(lookup_counting && run_stats.counter++))
+#endif
+
+/** --perf-counters로 읽는 하드웨어 카운터 이름 (phase_timer.counters와 같은 순서) */
+static const char *perf_counter_names[PERF_COUNTER_COUNT] = {
+    "cycles", "instructions", "l1d_read_misses", "llc_misses", "branch_misses",
+};
+
+/** 열린 하드웨어 카운터의 파일 디스크립터 (-1 = 열지 못함) */
+static int perf_counter_fds[PERF_COUNTER_COUNT] = {-1, -1, -1, -1, -1};
+
+/** 현재 단계를 시작할 때 읽은 하드웨어 카운터 값 */
+static long long phase_counter_start[PERF_COUNTER_COUNT];
+
+/**
+ * @brief --memory가 단계마다 크기를 재는 main의 테이블
+ */
+typedef struct _memory_tables {
+    char **input;
+    const int *input_length;
+    token **tokens;
+    const int *tokens_length;
+    symbol **symbol_table;
+    const int *symbol_table_length;
+    literal **literal_table;
+    const int *literal_table_length;
+    const object_code *obj_code; /** 패스 2가 채우기 전에는 NULL */
+} memory_tables;
+
+/** --memory로 크기를 잴 테이블 (main이 등록한다) */
+static memory_tables measured_tables;
+
+/** --trace: 메인 스레드의 트레이스 이벤트 버퍼 (어셈블러는 한 스레드로만 동작한다) */
+static trace_buffer main_trace = {NULL, 0, 0, 1};
+
+#ifndef NO_ASSEMBLER_INSTRUMENTATION
+/**
+ * @brief --alloc-sites가 추적하는 아직 해제되지 않은 블록 하나
+ */
+typedef struct _alloc_block {
+    void *ptr;   /** 블록 주소 (NULL = 빈 칸) */
+    int site;    /** run_stats.alloc_sites의 인덱스 */
+    size_t size; /** 요청한 바이트 수 */
+} alloc_block;
+
+/** 해제되지 않은 블록의 주소를 키로 하는 선형 탐사 해시 테이블 (크기는 2의 거듭제곱) */
+static alloc_block *alloc_blocks = NULL;
+static size_t alloc_block_capacity = 0;
+static size_t alloc_block_count = 0;
+
+/**
+ * @brief file:line 할당 위치의 run_stats.alloc_sites 인덱스를 찾고, 없으면 추가한다.
+ * @return 인덱스 (위치 테이블이 가득 찼으면 -1)
+ */
+static int find_alloc_site(const char *file, int line, const char *function) {
+    for (int i = 0; i < run_stats.alloc_site_count; i++) {
+        alloc_site *site = &run_stats.alloc_sites[i];
+        if (site->line == line && (site->file == file || strcmp(site->file, file) == 0)) {
+            return i;
+        }
+    }
+    if (run_stats.alloc_site_count >= MAX_ALLOC_SITES) {
+        return -1;
+    }
+    run_stats.alloc_sites[run_stats.alloc_site_count].file = file;
+    run_stats.alloc_sites[run_stats.alloc_site_count].line = line;
+    run_stats.alloc_sites[run_stats.alloc_site_count].function = function;
+    return run_stats.alloc_site_count++;
+}
+
+static size_t alloc_block_slot(const void *ptr) {
+    // malloc이 돌려주는 주소는 하위 비트가 항상 0이므로 섞은 뒤 자른다
+    unsigned long long key = (unsigned long long)(size_t)ptr;
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    return (size_t)key & (alloc_block_capacity - 1);
+}
+
+/**
+ * @brief 새로 할당한 블록 ptr을 할당 위치의 기록에 더하고 해시 테이블에 넣는다.
+ */
+static void track_allocation(void *ptr, size_t size, const char *file, int line, const char *function) {
+    int site = find_alloc_site(file, line, function);
+
+    if (ptr == NULL || site < 0) {
+        return;
+    }
+    run_stats.alloc_sites[site].allocations++;
+    run_stats.alloc_sites[site].bytes += size;
+
+    // 해시 테이블을 절반 이하로 채워 탐사 길이를 짧게 유지한다
+    if ((alloc_block_count + 1) * 2 > alloc_block_capacity) {
+        size_t old_capacity = alloc_block_capacity;
+        alloc_block *old_blocks = alloc_blocks;
+        size_t capacity = old_capacity == 0 ? 1024 : old_capacity * 2;
+        alloc_block *blocks = (alloc_block *)calloc(capacity, sizeof(alloc_block));
+
+        if (blocks == NULL) {
+            return;
+        }
+        alloc_blocks = blocks;
+        alloc_block_capacity = capacity;
+        for (size_t i = 0; i < old_capacity; i++) {
+            if (old_blocks[i].ptr != NULL) {
+                size_t slot = alloc_block_slot(old_blocks[i].ptr);
+                while (alloc_blocks[slot].ptr != NULL) {
+                    slot = (slot + 1) & (alloc_block_capacity - 1);
+                }
+                alloc_blocks[slot] = old_blocks[i];
+            }
+        }
+        free(old_blocks);
+    }
+
+    size_t slot = alloc_block_slot(ptr);
+    while (alloc_blocks[slot].ptr != NULL) {
+        slot = (slot + 1) & (alloc_block_capacity - 1);
+    }
+    alloc_blocks[slot].ptr = ptr;
+    alloc_blocks[slot].site = site;
+    alloc_blocks[slot].size = size;
+    alloc_block_count++;
+    run_stats.alloc_sites[site].live++;
+    run_stats.alloc_sites[site].live_bytes += size;
+}
+
+/**
+ * @brief 해제하는 블록 ptr을 해시 테이블에서 빼고 할당한 위치의 해제 횟수에 더한다.
+ * 추적하지 않은 블록(옵션 처리 전에 할당했거나 라이브러리가 할당한 블록)은 무시한다.
+ */
+static void untrack_allocation(const void *ptr) {
+    size_t mask = alloc_block_capacity - 1;
+    size_t slot;
+
+    if (ptr == NULL || alloc_block_capacity == 0) {
+        return;
+    }
+    for (slot = alloc_block_slot(ptr); alloc_blocks[slot].ptr != ptr; slot = (slot + 1) & mask) {
+        if (alloc_blocks[slot].ptr == NULL) {
+            return;
+        }
+    }
+
+    alloc_site *site = &run_stats.alloc_sites[alloc_blocks[slot].site];
+    site->frees++;
+    site->live--;
+    site->live_bytes -= alloc_blocks[slot].size;
+    alloc_block_count--;
+
+    // 무덤 표시 없이, 뒤따르는 블록 중 원래 칸이 빈 칸 앞에 있는 블록을 당겨 채운다
+    size_t hole = slot;
+    alloc_blocks[hole].ptr = NULL;
+    for (size_t next = (hole + 1) & mask; alloc_blocks[next].ptr != NULL; next = (next + 1) & mask) {
+        size_t home = alloc_block_slot(alloc_blocks[next].ptr);
+        if (((next - home) & mask) >= ((next - hole) & mask)) {
+            alloc_blocks[hole] = alloc_blocks[next];
+            alloc_blocks[next].ptr = NULL;
+            hole = next;
+        }
+    }
+}
+
+static void *counted_malloc(size_t size, const char *file, int line, const char *function) {
+    void *ptr = malloc(size);
+
+    run_stats.allocations++;
+    run_stats.allocated_bytes += size;
+    if (alloc_tracking) {
+        track_allocation(ptr, size, file, line, function);
+    }
+    return ptr;
+}
+
+static void *counted_calloc(size_t count, size_t size, const char *file, int line, const char *function) {
+    void *ptr = calloc(count, size);
+
+    run_stats.allocations++;
+    run_stats.allocated_bytes += count * size;
+    if (alloc_tracking) {
+        track_allocation(ptr, count * size, file, line, function);
+    }
+    return ptr;
+}
+
+static void *counted_realloc(void *ptr, size_t size, const char *file, int line, const char *function) {
+    void *moved;
+
+    // realloc 이후에는 ptr이 해제되었을 수 있으므로 먼저 기록에서 뺀다
+    // (실패하면 원래 블록은 추적하지 않은 채로 남지만, 호출한 쪽은 곧 오류로 종료한다)
+    if (alloc_tracking) {
+        untrack_allocation(ptr);
+    }
+    moved = realloc(ptr, size);
+
+    run_stats.allocations++;
+    run_stats.allocated_bytes += size;
+    if (alloc_tracking) {
+        track_allocation(moved, size, file, line, function);
+    }
+    return moved;
+}
+
+static char *counted_strdup(const char *str, const char *file, int line, const char *function) {
+    char *copy = strdup(str);
+
+    run_stats.allocations++;
+    run_stats.allocated_bytes += strlen(str) + 1;
+    if (alloc_tracking) {
+        track_allocation(copy, strlen(str) + 1, file, line, function);
+    }
+    return copy;
+}
+
+static void counted_free(void *ptr) {
+    if (alloc_tracking) {
+        untrack_allocation(ptr);
+    }
+    free(ptr);
+}
+
+// 이 파일의 모든 동적 할당을 세고 --alloc-sites에서 호출 위치를 구분하기 위해 할당 함수를 감싼다
+#define malloc(size) counted_malloc(size, __FILE__, __LINE__, __func__)
+#define calloc(count, size) counted_calloc(count, size, __FILE__, __LINE__, __func__)
+#define realloc(ptr, size) counted_realloc(ptr, size, __FILE__, __LINE__, __func__)
+#define strdup(str) counted_strdup(str, __FILE__, __LINE__, __func__)
+#define free(ptr) counted_free(ptr)
+#endif
 
 void print_operands(FILE* fp, const token* tok);
 static int add_inst_to_table(inst *inst_table[], int *inst_table_length,
@@ -39,15 +284,92 @@ static int process_token(const token *tok, const inst *inst_table[], int inst_ta
                         symbol *symbol_table[], int *num_symbols, 
                         literal *literal_table[], int *num_literals, int locctr, char *current_csect);
 
+static int relax_token_formats(token *tokens[], int tokens_length,
+                               const inst *inst_table[], int inst_table_length,
+                               symbol *symbol_table[], int *symbol_table_length,
+                               literal *literal_table[], int *literal_table_length,
+                               bool candidate[], bool original[], int addresses[],
+                               relax_result *result);
+static int assign_addresses(token *tokens[], int tokens_length,
+                            const inst *inst_table[], int inst_table_length,
+                            symbol *symbol_table[], int *symbol_table_length,
+                            literal *literal_table[], int *literal_table_length, int addresses[]);
+static int set_instruction_format(token *tok, bool extended,
+                                  const inst *inst_table[], int inst_table_length);
+static int instruction_bytes(token *tokens[], int tokens_length,
+                             const inst *inst_table[], int inst_table_length);
+static int base_address(const token *tok, const symbol *symbol_table[], int symbol_table_length,
+                        const char *current_csect, int locctr);
+static int far_literal_references(token *tokens[], int tokens_length, const int addresses[],
+                                  const inst *inst_table[], int inst_table_length,
+                                  literal *literal_table[], int literal_table_length, bool far[]);
+static bool uses_base_register(token *tokens[], int first, int last,
+                               const inst *inst_table[], int inst_table_length);
+static bool pick_section_base(token *tokens[], int first, int last,
+                              const inst *inst_table[], int inst_table_length,
+                              symbol *symbol_table[], int symbol_table_length,
+                              literal *literal_table[], int literal_table_length,
+                              char *base_symbol);
+static bool is_base_load_point(token *tokens[], int first, int index);
+static token *make_token(const char *label, const char *operator, const char *operand,
+                         const inst *inst_table[], int inst_table_length);
+static int resolve_equates(token *tokens[], int tokens_length,
+                           symbol *symbol_table[], int symbol_table_length);
+static int order_equates(symbol *nodes[], const expression *exprs[], int count,
+                         symbol *symbol_table[], int symbol_table_length,
+                         int indegree[], int edge_start[], int edges[], int queue[]);
+static int find_equate(symbol *nodes[], int count, const symbol *sym);
+static void free_token(token *tok);
+static long long monotonic_ns(void);
+static long long begin_phase(void);
+static void record_phase(const char *name, long long started);
+static int open_perf_counters(void);
+static void read_perf_counters(long long values[]);
+static void close_perf_counters(void);
+static void measure_memory(const memory_tables *tables, memory_snapshot *snapshot);
+static int write_stats_report(long long started);
+static void trace_record(trace_buffer *buffer, const char *category, const char *name,
+                         long long started, long long finished);
+static void trace_csect(const char *prev_csect, const char *current_csect, long long *section_started);
+static int write_trace_report(long long started);
+static int size_source(const inst *inst_table[], int inst_table_length, const char *source,
+                       char *input[], token *tokens[], symbol *symbol_table[], literal *literal_table[]);
+static int print_section_summary(FILE *fp, const char *source, const token *tokens[], int first, int last,
+                                 const char *csect, int start_address, int length,
+                                 const symbol *symbol_table[], int symbol_table_length);
+static int arrange_section_blocks(token *tokens[], int first, int last, signed char blocks[],
+                                  token *rebuilt[], int *rebuilt_length, block_result *result);
+static int process_macro_line(macro_table *table, const char *line, token *tok,
+                              token *tokens[], int *tokens_length);
+static int define_macro(macro_table *table, const char *name, const char *params);
+static int add_macro_line(macro *mac, token *tok, const char *line);
+static int expand_macro(macro_table *table, const macro *mac, const char *label, const char *arguments,
+                        token *tokens[], int *tokens_length, int depth);
+static token *instantiate_macro_line(const macro *mac, const macro_line *line,
+                                     char *values[], int expansion);
+static char *substitute_macro_text(const char *text, const macro *mac, char *values[], int expansion);
+static macro *find_macro(const macro_table *table, const char *name);
+static int split_arguments(const char *text, char *items[], int max_items);
+static char *operand_field(const char *line);
+static void free_macros(macro_table *table);
+static bool same_operands(const token *a, const token *b);
+static int peephole_store_load(token *tokens[], int first, int second);
+static int peephole_clear_load(token *tokens[], int first, int second);
+static int peephole_jump_next(token *tokens[], int first, int second);
+
 void add_symbol(symbol **sym_table, int *sym_count, const char *name, int addr, const char *csect);
-void add_literal(literal **lit_table, int *lit_count, const char *lit, int addr);
+void add_literal(literal **lit_table, int *lit_count, const char *lit, int addr, const char *csect);
 
 symbol* search_symbol(symbol** symbol_table, int num_symbols, const char* name, const char* csect);
-literal* search_literal(literal** literal_table, int num_literals, const char* name);
-void generate_directive_object_code(char *buffer, const token *tok,
-                                    literal *literal_table[], int literal_table_length);
+literal* search_literal(literal** literal_table, int num_literals, const char* name, const char* csect);
+static int literal_length(const char *lit);
+static bool immediate_constant(const char *operand, int *value);
+static bool push_expr_item(expression *expr, char kind, int value, const char *name, int name_length);
+static int operator_precedence(char op);
+static void literal_object_code(char *buffer, const char *lit);
+void generate_directive_object_code(char *buffer, const token *tok);
 int reg_code(const char *reg);
-void format3or4(char *buffer, const token *tok, int opcode, int format, int locctr,
+void format3or4(char *buffer, const token *tok, int opcode, int format, int locctr, int base,
                 const symbol *symbol_table[], int symbol_table_length, 
                 const literal *literal_table[], int literal_table_length, const char *current_csect);
 
@@ -57,6 +379,142 @@ int calculate_target_address(const char *operand, int locctr, int format,
                              const literal *literal_table[], int literal_table_length);
 void add_record(object_code *obj_code, char record_type, int section_index, const char *data);
 
+/**
+ * @brief 바이너리 오브젝트 파일을 만들 때 사용하는 가변 길이 바이트 버퍼
+ */
+typedef struct _byte_buffer {
+    unsigned char *data;
+    int length;
+    int capacity;
+} byte_buffer;
+
+static int buffer_put(byte_buffer *buf, const void *data, int length);
+static int buffer_put_varint(byte_buffer *buf, unsigned int value);
+static int buffer_put_record(byte_buffer *buf, char record_type, const byte_buffer *payload);
+static int intern_name(char (*names)[MAX_OBJECT_CODE_STRING + 1], int *name_count, const char *name);
+static int hex_field(const char *str, int length);
+
+/**
+ * @brief 패스 2에서 만들어 가는 중인 T 레코드 하나
+ */
+typedef struct _text_builder {
+    char data[MAX_TEXT_RECORD_LENGTH * 2 + 1];            /** 지금까지 모은 오브젝트 코드 (hex) */
+    int length;                                           /** data의 hex 문자 수 */
+    int start_address;                                    /** 레코드의 시작 주소 */
+    unsigned char mask[RELOCATION_MASK_SIZE];             /** 재배치 비트마스크 */
+    FILE *out;                                            /** 닫은 레코드를 바로 쓸 파일 (NULL = obj_code에 모은다) */
+} text_builder;
+
+static int flush_text_record(object_code *obj_code, int section, text_builder *text);
+static int append_text_record(object_code *obj_code, int section, text_builder *text,
+                              int addr, const char *hex, int reloc_offset);
+static int word_relocation(char records[][MAX_OBJECT_CODE_STRING + 1], int *count,
+                           const expression *expr, const expr_value *value, int addr,
+                           const char *current_csect);
+
+/**
+ * @brief --one-pass 모드에서 아직 정의되지 않은 심볼을 기다리는 명령어 또는 WORD 하나
+ */
+typedef struct _fixup {
+    token *tok;          /** 심볼이 정의되면 다시 인코딩할 토큰 */
+    int addr;            /** 토큰의 주소 */
+    int base;            /** 토큰 위치에서의 BASE 값 (-1 = NOBASE) */
+    struct _fixup *next; /** 같은 심볼을 기다리는 다음 항목 */
+} fixup;
+
+/**
+ * @brief 정의되지 않은 심볼(또는 주소가 없는 리터럴) 하나에 걸린 fixup 체인
+ */
+typedef struct _fixup_chain {
+    char name[20];             /** 심볼 이름 또는 리터럴 */
+    fixup *head;               /** 체인의 첫 항목 */
+    struct _fixup_chain *next; /** 다음 체인 */
+} fixup_chain;
+
+/**
+ * @brief --one-pass 모드의 진행 상태
+ *
+ * @details
+ * 소스 라인은 읽는 즉시 처리하고 해제하므로, 전방 참조를 가진 토큰만 체인에
+ * 남는다. 체인은 현재 컨트롤 섹션의 것만 유지된다. 레코드는 출력 파일에 바로
+ * 쓰고, 섹션이 끝날 때 H 레코드의 길이와 D 레코드의 주소를 fseek로 채운다.
+ * T 레코드 뒤에 와야 하는 M 레코드만 섹션이 끝날 때까지 모아 둔다.
+ */
+typedef struct _one_pass_state {
+    const inst **inst_table;
+    int inst_table_length;
+    symbol **symbol_table;
+    int *symbol_table_length;
+    literal **literal_table;
+    int *literal_table_length;
+    one_pass_result *result;
+
+    FILE *out;            /** 오브젝트 코드 출력 파일 */
+    long header_pos;      /** 현재 섹션 H 레코드의 길이 필드 위치 (-1 = 열린 섹션 없음) */
+    long body_pos;        /** 현재 섹션의 H/D 레코드가 끝나는 위치 */
+    text_builder text;    /** 아직 출력하지 않은 T 레코드 (직접 고칠 수 있다) */
+    int section;          /** 현재 컨트롤 섹션 인덱스 */
+    char csect[20];       /** 현재 컨트롤 섹션 이름 */
+    int start_address;    /** 현재 컨트롤 섹션의 시작 주소 */
+    int locctr;
+    int base;             /** BASE 지시어로 지정된 값 (-1 = NOBASE) */
+    char extref[MAX_RECORDS][10]; /** 현재 섹션의 EXTREF 심볼 */
+    int extref_count;
+    char extdef[MAX_RECORDS][MAX_OPERAND_PER_INST][10]; /** 현재 섹션의 EXTDEF 라인별 심볼 */
+    long extdef_pos[MAX_RECORDS]; /** EXTDEF 라인별 D 레코드의 파일 위치 */
+    int extdef_count;
+    char modification[MAX_RECORDS][MAX_OBJECT_CODE_STRING + 1]; /** 현재 섹션의 M 레코드 */
+    int modify_count;
+    fixup_chain *chains;  /** 해결을 기다리는 체인 목록 */
+    int pending;          /** 해결을 기다리는 fixup 수 */
+} one_pass_state;
+
+static int one_pass_line(one_pass_state *state, token *tok);
+static int one_pass_encode(one_pass_state *state, const token *tok, int addr, int base,
+                           char *buffer, char *missing);
+static int one_pass_defer(one_pass_state *state, fixup *entry, const char *name);
+static int one_pass_define(one_pass_state *state, const char *name);
+static int one_pass_patch(one_pass_state *state, int addr, const char *hex);
+static int one_pass_place_literals(one_pass_state *state);
+static int one_pass_close_section(one_pass_state *state);
+static bool one_pass_is_extref(const one_pass_state *state, const char *name);
+static int add_modification(char records[][MAX_OBJECT_CODE_STRING + 1], int *count, int addr,
+                            int half_bytes, char sign, const char *name);
+
+/** 명령행으로 지정된 어셈블러 옵션 */
+static assem_option option = {
+    .binary_object = false,
+    .text_record_length = DEFAULT_TEXT_RECORD_LENGTH,
+    .pack_text = false,
+    .relocation_bitmask = false,
+    .relax = false,
+    .auto_base = false,
+    .literal_pools = false,
+    .peephole = false,
+    .one_pass = false,
+    .size_only = false,
+    .stats_path = NULL,
+    .perf_counters = false,
+    .alloc_sites = false,
+    .memory = false,
+    .module_stats_path = NULL,
+    .trace_path = NULL,
+};
+
+/** --peephole 모드의 핍홀 최적화 규칙 테이블 */
+static peephole_rule peephole_rules[] = {
+    { "STA X / LDA X", peephole_store_load, 0, 0 },
+    { "CLEAR r / LDr", peephole_clear_load, 0, 0 },
+    { "다음 명령어로의 점프", peephole_jump_next, 0, 0 },
+};
+#define PEEPHOLE_RULE_COUNT ((int)(sizeof(peephole_rules) / sizeof(peephole_rules[0])))
+
+/** 패스 1의 매크로 처리 결과 */
+static macro_result macro_stats;
+
+/** 패스 1의 프로그램 블록 배치 결과 */
+static block_result block_stats;
+
 /**
  * @brief 사용자로부터 SIC/XE 소스코드를 받아서 object code를 출력한다.
  *
@@ -65,31 +523,137 @@ void add_record(object_code *obj_code, char record_type, int section_index, cons
  * 없는 한 변경하지 말 것.
  */
 int main(int argc, char **argv) {
+    /** 단계별 시간 측정 기준 (--stats) */
+    long long run_started = monotonic_ns();
+    long long started;
+
     /** SIC/XE 머신의 instruction 정보를 저장하는 테이블 */
     inst *inst_table[MAX_INST_TABLE_LENGTH];
-    int inst_table_length;
+    int inst_table_length = 0;
 
     /** SIC/XE 소스코드를 저장하는 테이블 */
     char *input[MAX_INPUT_LINES];
-    int input_length;
+    int input_length = 0;
 
     /** 소스코드의 각 라인을 토큰 전환하여 저장하는 테이블 */
     token *tokens[MAX_INPUT_LINES];
-    int tokens_length;
+    int tokens_length = 0;
 
     /** 소스코드 내의 심볼을 저장하는 테이블 */
     symbol *symbol_table[MAX_TABLE_LENGTH];
-    int symbol_table_length;
+    int symbol_table_length = 0;
 
     /** 소스코드 내의 리터럴을 저장하는 테이블 */
     literal *literal_table[MAX_TABLE_LENGTH];
-    int literal_table_length;
+    int literal_table_length = 0;
 
     /** 오브젝트 코드를 저장하는 변수 */
     object_code *obj_code = (object_code *)malloc(sizeof(object_code));
 
+    /** --size-only로 크기를 계산할 소스 파일 목록 */
+    const char **sources = (const char **)malloc(argc * sizeof(const char *));
+    int source_count = 0;
+
     int err = 0;
 
+    // 명령행 옵션 처리
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--binary") == 0) {
+            option.binary_object = true;
+        } else if (strcmp(argv[i], "--text-length") == 0 && i + 1 < argc) {
+            option.text_record_length = (int)strtol(argv[++i], NULL, 0);
+            if (option.text_record_length < 1 || option.text_record_length > MAX_TEXT_RECORD_LENGTH) {
+                fprintf(stderr, "T 레코드 길이는 1 ~ 0x%X 사이여야 합니다.\n", MAX_TEXT_RECORD_LENGTH);
+                return -1;
+            }
+        } else if (strcmp(argv[i], "--pack-text") == 0) {
+            option.pack_text = true;
+        } else if (strcmp(argv[i], "--reloc-bitmask") == 0) {
+            option.relocation_bitmask = true;
+        } else if (strcmp(argv[i], "--relax") == 0) {
+            option.relax = true;
+        } else if (strcmp(argv[i], "--auto-base") == 0) {
+            option.relax = true;
+            option.auto_base = true;
+        } else if (strcmp(argv[i], "--literal-pools") == 0) {
+            option.literal_pools = true;
+        } else if (strcmp(argv[i], "--peephole") == 0) {
+            option.peephole = true;
+        } else if (strcmp(argv[i], "--one-pass") == 0) {
+            option.one_pass = true;
+        } else if (strcmp(argv[i], "--size-only") == 0) {
+            option.size_only = true;
+        } else if (strcmp(argv[i], "--stats") == 0 && i + 1 < argc) {
+            option.stats_path = argv[++i];
+        } else if (strcmp(argv[i], "--perf-counters") == 0) {
+            option.perf_counters = true;
+        } else if (strcmp(argv[i], "--alloc-sites") == 0) {
+            option.alloc_sites = true;
+        } else if (strcmp(argv[i], "--memory") == 0) {
+            option.memory = true;
+        } else if (strcmp(argv[i], "--module-stats") == 0 && i + 1 < argc) {
+            option.module_stats_path = argv[++i];
+        } else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            option.trace_path = argv[++i];
+        } else if (argv[i][0] != '-' && sources != NULL) {
+            sources[source_count++] = argv[i];
+        } else {
+            fprintf(stderr, "사용법: %s [--binary] [--text-length N] [--pack-text] "
+                            "[--reloc-bitmask] [--relax] [--auto-base] [--literal-pools] "
+                            "[--peephole] [--one-pass] [--size-only [소스파일...]] "
+                            "[--stats 파일 [--perf-counters] [--alloc-sites] [--memory]] [--module-stats 파일] [--trace 파일]\n", argv[0]);
+            return -1;
+        }
+    }
+    if (source_count > 0 && !option.size_only) {
+        fprintf(stderr, "소스 파일은 --size-only와 함께만 지정할 수 있습니다.\n");
+        return -1;
+    }
+    if (option.perf_counters && option.stats_path == NULL) {
+        fprintf(stderr, "--perf-counters는 --stats와 함께만 사용할 수 있습니다.\n");
+        return -1;
+    }
+    if (option.alloc_sites && option.stats_path == NULL) {
+        fprintf(stderr, "--alloc-sites는 --stats와 함께만 사용할 수 있습니다.\n");
+        return -1;
+    }
+    if (option.memory && option.stats_path == NULL) {
+        fprintf(stderr, "--memory는 --stats와 함께만 사용할 수 있습니다.\n");
+        return -1;
+    }
+    alloc_tracking = option.alloc_sites;
+    lookup_counting = option.stats_path != NULL;
+    measured_tables = (memory_tables){input, &input_length, tokens, &tokens_length,
+                                      symbol_table, &symbol_table_length,
+                                      literal_table, &literal_table_length, NULL};
+    // 명령어 통계는 assem_pass2에서 모은다
+    if (option.module_stats_path != NULL && (option.one_pass || option.size_only)) {
+        fprintf(stderr, "--module-stats는 --one-pass, --size-only와 함께 사용할 수 없습니다.\n");
+        return -1;
+    }
+    if (option.size_only && option.one_pass) {
+        fprintf(stderr, "--size-only는 --one-pass와 함께 사용할 수 없습니다.\n");
+        return -1;
+    }
+    // 토큰 테이블 전체가 필요한 옵션, 겹쳐 쓴 레코드를 해석해야 하는 옵션과
+    // 모아 둔 오브젝트 코드로 출력하는 옵션은 한 번에 어셈블할 수 없다
+    if (option.one_pass && (option.relax || option.literal_pools || option.peephole ||
+                            option.pack_text || option.relocation_bitmask || option.binary_object)) {
+        fprintf(stderr, "--one-pass는 --relax, --auto-base, --literal-pools, --peephole, "
+                        "--pack-text, --reloc-bitmask, --binary와 함께 사용할 수 없습니다.\n");
+        return -1;
+    }
+    // 재배치 필드(3바이트)와 4형식 명령어가 한 레코드 안에 들어가야 한다
+    if (option.relocation_bitmask && option.text_record_length < 4) {
+        fprintf(stderr, "--reloc-bitmask를 사용하려면 T 레코드 길이가 4 이상이어야 합니다.\n");
+        return -1;
+    }
+
+    if (option.perf_counters) {
+        open_perf_counters();
+    }
+
+    started = begin_phase();
     if ((err = init_inst_table(inst_table, &inst_table_length,
                                "inst_table.txt")) < 0) {
         fprintf(stderr,
@@ -98,15 +662,58 @@ int main(int argc, char **argv) {
                 err);
         return -1;
     }
+    record_phase("init_inst_table", started);
+
+    // 빌드 계획용: 패스 1까지만 수행하고 오브젝트 코드는 만들지 않는다
+    if (option.size_only) {
+        if (source_count == 0) {
+            sources[source_count++] = "input.txt";
+        }
+        started = begin_phase();
+        if ((err = assem_size_only((const inst **)inst_table, inst_table_length,
+                                   sources, source_count)) < 0) {
+            fprintf(stderr,
+                    "assem_size_only: 크기 계산 과정에서 실패했습니다. "
+                    "(error_code: %d)\n",
+                    err);
+            return -1;
+        }
+        record_phase("assem_size_only", started);
+        if ((err = write_stats_report(run_started)) < 0) {
+            return err;
+        }
+        return write_trace_report(run_started);
+    }
 
-    if ((err = init_input(input, &input_length, "input.txt")) < 0) {
+    started = begin_phase();
+    if (option.one_pass) {
+        one_pass_result one_pass;
+        if ((err = assem_one_pass((const inst **)inst_table, inst_table_length, "input.txt",
+                                  symbol_table, &symbol_table_length,
+                                  literal_table, &literal_table_length, "output_objectcode.txt",
+                                  &one_pass)) < 0) {
+            fprintf(stderr,
+                    "assem_one_pass: 한 번에 어셈블하는 과정에서 실패했습니다. "
+                    "(error_code: %d)\n",
+                    err);
+            return -1;
+        }
+        printf("assem_one_pass: 라인 %d개, 전방 참조 %d개 (T 레코드 직접 수정 %d개, "
+               "수정용 T 레코드 %d개), 동시에 기다린 참조 최대 %d개\n",
+               one_pass.lines, one_pass.forward_refs, one_pass.patched_in_place,
+               one_pass.patch_records, one_pass.max_pending);
+        run_stats.lines = run_stats.tokens = one_pass.lines;
+    } else if ((err = init_input(input, &input_length, "input.txt")) < 0) {
         fprintf(stderr,
                 "init_input: 소스코드 입력에 실패했습니다. (error_code: %d)\n",
                 err);
         return -1;
     }
+    record_phase(option.one_pass ? "assem_one_pass" : "init_input", started);
 
-    if ((err = assem_pass1((const inst **)inst_table, inst_table_length,
+    started = begin_phase();
+    if (!option.one_pass &&
+        (err = assem_pass1((const inst **)inst_table, inst_table_length,
                            (const char **)input, input_length, tokens,
                            &tokens_length, symbol_table, &symbol_table_length,
                            literal_table, &literal_table_length)) < 0) {
@@ -115,6 +722,86 @@ int main(int argc, char **argv) {
                 err);
         return -1;
     }
+    if (!option.one_pass) {
+        record_phase("assem_pass1", started);
+        run_stats.tokens = tokens_length;
+    }
+
+    if (macro_stats.definitions > 0) {
+        printf("expand_macros: 매크로 %d개 정의, 호출 %d회, 라인 %d개 생성\n",
+               macro_stats.definitions, macro_stats.invocations, macro_stats.generated_lines);
+    }
+
+    if (block_stats.blocks > 0) {
+        printf("arrange_program_blocks: 프로그램 블록 %d개, 라인 %d개를 기본 블록 뒤로 배치\n",
+               block_stats.blocks, block_stats.moved_lines);
+    }
+
+    if (option.peephole) {
+        int hits = 0;
+        int bytes_saved = 0;
+        for (int i = 0; i < PEEPHOLE_RULE_COUNT; i++) {
+            printf("optimize_peephole: %s %d회, %d 바이트\n",
+                   peephole_rules[i].name, peephole_rules[i].hits, peephole_rules[i].bytes_saved);
+            hits += peephole_rules[i].hits;
+            bytes_saved += peephole_rules[i].bytes_saved;
+        }
+        printf("optimize_peephole: 명령어 %d개 제거, %d 바이트 절약\n", hits, bytes_saved);
+    }
+
+    if (option.literal_pools) {
+        pool_result pools;
+        started = begin_phase();
+        if ((err = place_literal_pools(tokens, &tokens_length, (const inst **)inst_table,
+                                       inst_table_length, symbol_table, &symbol_table_length,
+                                       literal_table, &literal_table_length, &pools)) < 0) {
+            fprintf(stderr,
+                    "place_literal_pools: 리터럴 풀 배치 과정에서 실패했습니다. "
+                    "(error_code: %d)\n",
+                    err);
+            return -1;
+        }
+        record_phase("place_literal_pools", started);
+        printf("place_literal_pools: LTORG %d개 추가, PC 상대 주소로 닿지 않는 리터럴 참조 "
+               "%d개 -> %d개 (4형식 %d개 방지)\n",
+               pools.pools, pools.far_before, pools.far_after, pools.far_before - pools.far_after);
+    }
+
+    if (option.relax) {
+        relax_result relax;
+        started = begin_phase();
+        if ((err = relax_formats(tokens, tokens_length, (const inst **)inst_table,
+                                 inst_table_length, symbol_table, &symbol_table_length,
+                                 literal_table, &literal_table_length, &relax)) < 0) {
+            fprintf(stderr,
+                    "relax_formats: 명령어 형식 결정 과정에서 실패했습니다. "
+                    "(error_code: %d)\n",
+                    err);
+            return -1;
+        }
+        record_phase("relax_formats", started);
+        printf("relax_formats: 4형식 -> 3형식 %d개, 3형식 -> 4형식 %d개, "
+               "주소 계산 %d회, %d 바이트 절약\n",
+               relax.shortened, relax.lengthened, relax.iterations, relax.bytes_saved);
+    }
+
+    if (option.auto_base) {
+        base_result base;
+        started = begin_phase();
+        if ((err = choose_base_registers(tokens, &tokens_length, (const inst **)inst_table,
+                                         inst_table_length, symbol_table, &symbol_table_length,
+                                         literal_table, &literal_table_length, &base)) < 0) {
+            fprintf(stderr,
+                    "choose_base_registers: 베이스 레지스터 분석 과정에서 실패했습니다. "
+                    "(error_code: %d)\n",
+                    err);
+            return -1;
+        }
+        record_phase("choose_base_registers", started);
+        printf("choose_base_registers: 섹션 %d개에 BASE 적용, LDB %d개 추가, "
+               "4형식 -> 3형식 %d개, %d 바이트 절약\n",
+               base.sections, base.load_points, base.shortened, base.bytes_saved);
+    }
 
     /** 프로젝트1에서는 불필요함 */
     /*
@@ -129,6 +816,10 @@ int main(int argc, char **argv) {
     }
     */
 
+    run_stats.symbols = symbol_table_length;
+    run_stats.literals = literal_table_length;
+
+    started = begin_phase();
     if ((err = make_symbol_table_output("output_symtab.txt",
                                         (const symbol **)symbol_table,
                                         symbol_table_length)) < 0) {
@@ -138,7 +829,9 @@ int main(int argc, char **argv) {
                 err);
         return -1;
     }
+    record_phase("make_symbol_table_output", started);
 
+    started = begin_phase();
     if ((err = make_literal_table_output("output_littab.txt",
                                          (const literal **)literal_table,
                                          literal_table_length)) < 0) {
@@ -148,8 +841,11 @@ int main(int argc, char **argv) {
                 err);
         return -1;
     }
+    record_phase("make_literal_table_output", started);
 
-    if ((err = assem_pass2((const token **)tokens, tokens_length,
+    started = begin_phase();
+    if (!option.one_pass &&
+        (err = assem_pass2((const token **)tokens, tokens_length,
                            (const inst **)inst_table, inst_table_length,
                            (const symbol **)symbol_table, symbol_table_length,
                            (const literal **)literal_table,
@@ -159,88 +855,473 @@ int main(int argc, char **argv) {
                 err);
         return -1;
     }
+    if (!option.one_pass) {
+        measured_tables.obj_code = obj_code;
+        record_phase("assem_pass2", started);
+    }
+
+    if (option.pack_text) {
+        int before = 0;
+        int after = 0;
+        long before_size = 0;
+        long after_size = 0;
+        for (int i = 0; i < obj_code->num_sections; i++) {
+            before += obj_code->text_count[i];
+            for (int j = 0; j < obj_code->text_count[i]; j++) before_size += strlen(obj_code->text[i][j]) + 1;
+        }
+
+        started = begin_phase();
+        if ((err = pack_text_records(obj_code)) < 0) {
+            fprintf(stderr,
+                    "pack_text_records: T 레코드 병합 과정에서 실패했습니다. "
+                    "(error_code: %d)\n",
+                    err);
+            return -1;
+        }
+        record_phase("pack_text_records", started);
+
+        for (int i = 0; i < obj_code->num_sections; i++) {
+            after += obj_code->text_count[i];
+            for (int j = 0; j < obj_code->text_count[i]; j++) after_size += strlen(obj_code->text[i][j]) + 1;
+        }
+        // 적재 시간에 미치는 영향은 my_benchmark_20221846 --linker로 잰다
+        printf("pack_text_records: T 레코드 %d개 -> %d개 (%d개 감소), "
+               "T 레코드 크기 %ld -> %ld 바이트, 레코드 길이 제한 0x%X\n",
+               before, after, before - after, before_size, after_size, option.text_record_length);
+    }
 
-    if ((err = make_objectcode_output("output_objectcode.txt",
-                                      (const object_code *)obj_code)) < 0) {
+    started = begin_phase();
+    if (option.one_pass) {
+        // assem_one_pass가 레코드를 만드는 즉시 output_objectcode.txt에 썼다
+    } else if (option.binary_object) {
+        if ((err = make_objectcode_binary_output("output_objectcode.bin",
+                                                 (const object_code *)obj_code)) < 0) {
+            fprintf(stderr,
+                    "make_objectcode_binary_output: 바이너리 오브젝트코드 파일 "
+                    "출력 과정에서 실패했습니다. (error_code: %d)\n",
+                    err);
+            return -1;
+        }
+    } else if ((err = make_objectcode_output("output_objectcode.txt",
+                                             (const object_code *)obj_code)) < 0) {
         fprintf(stderr,
                 "make_objectcode_output: 오브젝트코드 파일 출력 과정에서 "
                 "실패했습니다. (error_code: %d)\n",
                 err);
         return -1;
     }
+    if (!option.one_pass) {
+        record_phase(option.binary_object ? "make_objectcode_binary_output" : "make_objectcode_output",
+                     started);
+    }
 
-    return 0;
+    if (option.module_stats_path != NULL) {
+        started = begin_phase();
+        if ((err = make_module_stats_output(option.module_stats_path, (const object_code *)obj_code,
+                                            (const inst **)inst_table, inst_table_length)) < 0) {
+            fprintf(stderr,
+                    "make_module_stats_output: 명령어 통계 파일 출력 과정에서 실패했습니다. "
+                    "(error_code: %d)\n",
+                    err);
+            return -1;
+        }
+        record_phase("make_module_stats_output", started);
+    }
+
+    if ((err = write_stats_report(run_started)) < 0) {
+        return err;
+    }
+    return write_trace_report(run_started);
 }
 
 /**
- * @brief 기계어 목록 파일(inst_table.txt)을 읽어 기계어 목록
- * 테이블(inst_table)을 생성한다.
- *
- * @param inst_table 기계어 목록 테이블의 시작 주소
- * @param inst_table_length 기계어 목록 테이블의 길이를 저장하는 변수 주소
- * @param inst_table_dir 기계어 목록 파일 경로
- * @return 오류 코드 (정상 종료 = 0)
- *
- * @details
- * 기계어 목록 파일(inst_table.txt)을 읽어 기계어 목록 테이블(inst_table)을
- * 생성한다. 기계어 목록 파일 형식은 자유롭게 구현한다. 예시는 다음과 같다.
- *    ==============================================================
- *           | 이름 | 형식 | 기계어 코드 | 오퍼랜드의 갯수 | \n |
- *    ==============================================================
+ * @brief 단조 시계의 현재 시각을 나노초 단위로 반환한다.
  */
-int init_inst_table(inst *inst_table[], int *inst_table_length,
-                    const char *inst_table_dir) {
-    /* add your code */
-    FILE *fp;
-    int err;
+static long long monotonic_ns(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (long long)now.tv_sec * 1000000000LL + now.tv_nsec;
+}
 
-    char buffer[20];
+/**
+ * @brief 단계 하나를 시작한다. --perf-counters가 지정된 경우 하드웨어 카운터의
+ * 현재 값도 읽어 둔다.
+ * @return record_phase에 넘길 시작 시각
+ */
+static long long begin_phase(void) {
+    if (option.perf_counters) {
+        read_perf_counters(phase_counter_start);
+    }
+    return monotonic_ns();
+}
 
-    // 파일 열기 
-    fp = fopen(inst_table_dir, "r");
-    if (fp == NULL) {
-        fprintf(stderr, "기계 코드목록 파일 열기 실패");
-        return -1;
+/**
+ * @brief started부터 지금까지의 시간을 단계 name의 소요 시간에 더한다.
+ * --perf-counters가 지정된 경우 begin_phase 이후 증가한 하드웨어 카운터 값도 더한다.
+ */
+static void record_phase(const char *name, long long started) {
+    long long elapsed = monotonic_ns() - started;
+    long long counters[PERF_COUNTER_COUNT] = {0};
+    phase_timer *phase = NULL;
+
+    if (option.perf_counters) {
+        read_perf_counters(counters);
+        for (int j = 0; j < PERF_COUNTER_COUNT; j++) {
+            counters[j] -= phase_counter_start[j];
+        }
     }
 
-    // 파일을 읽어 기계어 목록 테이블에 저장
-    while(!feof(fp)) {
-        fgets(buffer, 20, fp);
-        err = add_inst_to_table(inst_table, inst_table_length, buffer);
-        if (err != 0) {
-            fclose(fp);
-            return err;
+    for (int i = 0; i < run_stats.phase_count; i++) {
+        if (strcmp(run_stats.phases[i].name, name) == 0) {
+            phase = &run_stats.phases[i];
+            break;
         }
-    } 
+    }
+    if (phase == NULL && run_stats.phase_count < MAX_STATS_PHASES) {
+        phase = &run_stats.phases[run_stats.phase_count++];
+        memset(phase, 0, sizeof(phase_timer));
+        phase->name = name;
+    }
+    if (phase != NULL) {
+        phase->nanoseconds += elapsed;
+        for (int j = 0; j < PERF_COUNTER_COUNT; j++) {
+            phase->counters[j] += counters[j];
+        }
+        if (option.memory) {
+            measure_memory(&measured_tables, &phase->memory);
+        }
+    }
 
-    return err;
-    
+    if (option.trace_path != NULL) {
+        trace_record(&main_trace, "phase", name, started, started + elapsed);
+    }
 }
 
 /**
- * @brief inst_table.txt의 라인 하나를 입력으로 받아, 해당하는 instruction
- * 정보를 inst_table에 저장함.
+ * @brief perf_counter_names의 하드웨어 카운터를 사용자 영역 전용으로 연다.
+ * @return 연 카운터 수
+ *
+ * @details
+ * 카운터는 각각 따로 열어서, PMU가 없거나 일부 이벤트만 지원하는 환경(가상 머신,
+ * perf_event_paranoid 설정 등)에서도 열 수 있는 카운터는 기록한다. 동시에 셀 수
+ * 있는 카운터보다 많이 열려 커널이 번갈아 셀 때는 read_perf_counters가 측정 시간
+ * 비율로 값을 보정한다. 하나도 열지 못하면 경고만 출력하고 시간만 기록한다.
  */
-static int add_inst_to_table(inst *inst_table[], int *inst_table_length, 
-                             const char *buffer) {
-    char name[10];
-    int format;
-    char op[10];
-    int ops;
-
-    if (*inst_table_length == MAX_INST_TABLE_LENGTH) return -1;
+static int open_perf_counters(void) {
+    int opened = 0;
+#ifdef __linux__
+    static const struct {
+        unsigned int type;
+        unsigned long long config;
+    } events[PERF_COUNTER_COUNT] = {
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+        {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                                 (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+    };
+    struct perf_event_attr attr;
+
+    for (int i = 0; i < PERF_COUNTER_COUNT; i++) {
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = events[i].type;
+        attr.config = events[i].config;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        perf_counter_fds[i] = (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+        if (perf_counter_fds[i] >= 0) {
+            run_stats.counter_available[i] = true;
+            opened++;
+        }
+    }
+#endif
+    if (opened == 0) {
+        fprintf(stderr, "경고: 하드웨어 카운터를 열 수 없어 단계별 시간만 기록합니다. "
+                        "(perf_event_open 미지원 또는 권한 부족)\n");
+    } else if (opened < PERF_COUNTER_COUNT) {
+        fprintf(stderr, "경고: 하드웨어 카운터 %d개 중 %d개만 열었습니다. "
+                        "열지 못한 카운터는 null로 기록합니다.\n", PERF_COUNTER_COUNT, opened);
+    }
 
-    sscanf(buffer, "%s %d %s %d\n", name, &format, op, &ops);
+    return opened;
+}
 
-    if ((inst_table[*inst_table_length] = (inst*)malloc(sizeof(inst))) == NULL) 
-        return -1;
+/**
+ * @brief 열린 하드웨어 카운터의 현재 값을 values에 읽는다. 열지 못한 카운터는 0이다.
+ */
+static void read_perf_counters(long long values[]) {
+    for (int i = 0; i < PERF_COUNTER_COUNT; i++) {
+        values[i] = 0;
+#ifdef __linux__
+        unsigned long long data[3]; // 값, 활성화된 시간, 실제로 센 시간
+        if (perf_counter_fds[i] < 0 || read(perf_counter_fds[i], data, sizeof(data)) != sizeof(data)) {
+            continue;
+        }
+        if (data[2] > 0 && data[2] < data[1]) {
+            values[i] = (long long)((double)data[0] * data[1] / data[2]);
+        } else {
+            values[i] = (long long)data[0];
+        }
+#endif
+    }
+}
 
-    memcpy(inst_table[*inst_table_length]->str, name, 9);
-    inst_table[*inst_table_length]->str[9] = '\0';
+/**
+ * @brief open_perf_counters로 연 하드웨어 카운터를 닫는다.
+ */
+static void close_perf_counters(void) {
+    for (int i = 0; i < PERF_COUNTER_COUNT; i++) {
+#ifdef __linux__
+        if (perf_counter_fds[i] >= 0) {
+            close(perf_counter_fds[i]);
+        }
+#endif
+        perf_counter_fds[i] = -1;
+    }
+}
 
-    inst_table[*inst_table_length]->format = format;
+/**
+ * @brief --stats가 지정된 경우 지금까지의 단계별 시간과 카운터를 JSON으로 저장한다.
+ * @return 오류 코드 (정상 종료 = 0)
+ */
+static int write_stats_report(long long started) {
+    int err;
 
-    inst_table[*inst_table_length]->op = (char)strtol(op, NULL, 16);
+    if (option.stats_path == NULL) {
+        return 0;
+    }
+
+    run_stats.total_nanoseconds = monotonic_ns() - started;
+    close_perf_counters();
+    if ((err = make_stats_output(option.stats_path, &run_stats)) < 0) {
+        fprintf(stderr,
+                "make_stats_output: 통계 파일 출력 과정에서 실패했습니다. "
+                "(error_code: %d)\n",
+                err);
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief 현재 RSS와 테이블별 논리 바이트 수를 잰다. (--memory)
+ *
+ * @details
+ * RSS는 /proc/self/statm, 최대 RSS는 getrusage로 읽으며 Linux가 아니면 -1이다.
+ * 문자열은 소스 라인과 토큰 필드를 각각 따로 세므로 매크로 템플릿과 공유하는
+ * 문자열도 토큰마다 센다.
+ */
+static void measure_memory(const memory_tables *tables, memory_snapshot *snapshot) {
+    memset(snapshot, 0, sizeof(memory_snapshot));
+    snapshot->rss_kb = -1;
+    snapshot->peak_rss_kb = -1;
+#ifdef __linux__
+    FILE *statm = fopen("/proc/self/statm", "r");
+    long pages;
+    if (statm != NULL) {
+        if (fscanf(statm, "%*s %ld", &pages) == 1) {
+            snapshot->rss_kb = pages * (sysconf(_SC_PAGESIZE) / 1024);
+        }
+        fclose(statm);
+    }
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+        // 커널은 최대 RSS를 늦게 갱신하므로 방금 읽은 RSS보다 작으면 RSS를 쓴다
+        snapshot->peak_rss_kb = usage.ru_maxrss > snapshot->rss_kb ? usage.ru_maxrss : snapshot->rss_kb;
+    }
+#endif
+
+    for (int i = 0; i < *tables->input_length; i++) {
+        snapshot->strings += strlen(tables->input[i]) + 1;
+    }
+    for (int i = 0; i < *tables->tokens_length; i++) {
+        const token *tok = tables->tokens[i];
+        snapshot->tokens += sizeof(token) + (tok->expr != NULL ? sizeof(expression) : 0);
+        snapshot->strings += tok->label != NULL ? strlen(tok->label) + 1 : 0;
+        snapshot->strings += tok->operator != NULL ? strlen(tok->operator) + 1 : 0;
+        snapshot->strings += tok->comment != NULL ? strlen(tok->comment) + 1 : 0;
+        for (int j = 0; j < MAX_OPERAND_PER_INST && tok->operand[j] != NULL; j++) {
+            snapshot->strings += strlen(tok->operand[j]) + 1;
+        }
+    }
+    snapshot->symbols = (long long)*tables->symbol_table_length * sizeof(symbol);
+    snapshot->literals = (long long)*tables->literal_table_length * sizeof(literal);
+
+    const object_code *obj_code = tables->obj_code;
+    if (obj_code != NULL) {
+        snapshot->records = sizeof(object_code);
+        for (int s = 0; s < obj_code->num_sections; s++) {
+            for (int r = 0; r < obj_code->text_count[s]; r++) {
+                int length = strlen(obj_code->text[s][r]) + 1;
+                snapshot->records += length;
+                snapshot->records_used += length;
+                if (obj_code->text_mask[s][r] != NULL) {
+                    snapshot->records += ((length - 10) / 2 + 7) / 8;
+                }
+            }
+            for (int r = 0; r < obj_code->header_count[s]; r++) {
+                snapshot->records_used += strlen(obj_code->header[s][r]) + 1;
+            }
+            for (int r = 0; r < obj_code->define_count[s]; r++) {
+                snapshot->records_used += strlen(obj_code->define[s][r]) + 1;
+            }
+            for (int r = 0; r < obj_code->reference_count[s]; r++) {
+                snapshot->records_used += strlen(obj_code->reference[s][r]) + 1;
+            }
+            for (int r = 0; r < obj_code->modify_count[s]; r++) {
+                snapshot->records_used += strlen(obj_code->modification[s][r]) + 1;
+            }
+            for (int r = 0; r < obj_code->end_count[s]; r++) {
+                snapshot->records_used += strlen(obj_code->end[s][r]) + 1;
+            }
+        }
+    }
+}
+
+/**
+ * @brief 구간 하나를 트레이스 버퍼에 덧붙인다. 버퍼가 차면 두 배로 늘린다.
+ * 버퍼는 --alloc-sites의 누수 보고에 섞이지 않도록 감싸지 않은 realloc/free로 관리한다.
+ */
+static void trace_record(trace_buffer *buffer, const char *category, const char *name,
+                         long long started, long long finished) {
+    if (buffer->count == buffer->capacity) {
+        int capacity = buffer->capacity == 0 ? DEFAULT_TRACE_CAPACITY : buffer->capacity * 2;
+        trace_event *events = (trace_event *)(realloc)(buffer->events, capacity * sizeof(trace_event));
+        if (events == NULL) {
+            return; // 트레이스는 진단용이므로 기록하지 못해도 어셈블은 계속한다
+        }
+        buffer->events = events;
+        buffer->capacity = capacity;
+    }
+
+    trace_event *event = &buffer->events[buffer->count++];
+    snprintf(event->name, sizeof(event->name), "%s", name);
+    event->category = category;
+    event->start_ns = started;
+    event->duration_ns = finished - started;
+}
+
+/**
+ * @brief 컨트롤 섹션이 prev_csect에서 current_csect로 바뀌었으면 prev_csect의 구간을
+ * 기록하고 다음 구간의 시작 시각을 갱신한다. (--trace)
+ * START 이전의 초기값 "DEFAULT"는 실제 섹션이 아니므로 구간으로 기록하지 않는다.
+ */
+static void trace_csect(const char *prev_csect, const char *current_csect, long long *section_started) {
+    long long now;
+
+    if (option.trace_path == NULL || strcmp(prev_csect, current_csect) == 0) {
+        return;
+    }
+    now = monotonic_ns();
+    if (strcmp(prev_csect, "DEFAULT") != 0) {
+        trace_record(&main_trace, "csect", prev_csect, *section_started, now);
+    }
+    *section_started = now;
+}
+
+/**
+ * @brief --trace가 지정된 경우 기록한 구간을 Chrome 트레이스 JSON으로 저장한다.
+ * @param started 트레이스의 기준 시각 (0 µs)
+ * @return 오류 코드 (정상 종료 = 0)
+ */
+static int write_trace_report(long long started) {
+    const trace_buffer *buffers[] = {&main_trace};
+    int err;
+
+    if (option.trace_path == NULL) {
+        return 0;
+    }
+
+    err = make_trace_output(option.trace_path, buffers, sizeof(buffers) / sizeof(buffers[0]), started);
+    (free)(main_trace.events);
+    main_trace.events = NULL;
+    main_trace.count = main_trace.capacity = 0;
+    if (err < 0) {
+        fprintf(stderr,
+                "make_trace_output: 트레이스 파일 출력 과정에서 실패했습니다. "
+                "(error_code: %d)\n",
+                err);
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief 기계어 목록 파일(inst_table.txt)을 읽어 기계어 목록
+ * 테이블(inst_table)을 생성한다.
+ *
+ * @param inst_table 기계어 목록 테이블의 시작 주소
+ * @param inst_table_length 기계어 목록 테이블의 길이를 저장하는 변수 주소
+ * @param inst_table_dir 기계어 목록 파일 경로
+ * @return 오류 코드 (정상 종료 = 0)
+ *
+ * @details
+ * 기계어 목록 파일(inst_table.txt)을 읽어 기계어 목록 테이블(inst_table)을
+ * 생성한다. 기계어 목록 파일 형식은 자유롭게 구현한다. 예시는 다음과 같다.
+ *    ==============================================================
+ *           | 이름 | 형식 | 기계어 코드 | 오퍼랜드의 갯수 | \n |
+ *    ==============================================================
+ */
+int init_inst_table(inst *inst_table[], int *inst_table_length,
+                    const char *inst_table_dir) {
+    /* add your code */
+    FILE *fp;
+    int err = 0;
+
+    char buffer[20];
+
+    // 파일 열기 
+    fp = fopen(inst_table_dir, "r");
+    if (fp == NULL) {
+        fprintf(stderr, "기계 코드목록 파일 열기 실패");
+        return -1;
+    }
+
+    // 파일을 읽어 기계어 목록 테이블에 저장
+    while (fgets(buffer, 20, fp) != NULL) {
+        err = add_inst_to_table(inst_table, inst_table_length, buffer);
+        if (err != 0) {
+            fclose(fp);
+            return err;
+        }
+    } 
+
+    fclose(fp);
+
+    return err;
+    
+}
+
+/**
+ * @brief inst_table.txt의 라인 하나를 입력으로 받아, 해당하는 instruction
+ * 정보를 inst_table에 저장함.
+ */
+static int add_inst_to_table(inst *inst_table[], int *inst_table_length, 
+                             const char *buffer) {
+    char name[10];
+    int format;
+    char op[10];
+    int ops;
+
+    if (*inst_table_length == MAX_INST_TABLE_LENGTH) return -1;
+
+    sscanf(buffer, "%s %d %s %d\n", name, &format, op, &ops);
+
+    if ((inst_table[*inst_table_length] = (inst*)malloc(sizeof(inst))) == NULL) 
+        return -1;
+
+    memcpy(inst_table[*inst_table_length]->str, name, 9);
+    inst_table[*inst_table_length]->str[9] = '\0';
+
+    inst_table[*inst_table_length]->format = format;
+
+    inst_table[*inst_table_length]->op = (char)strtol(op, NULL, 16);
 
     inst_table[*inst_table_length]->ops = ops;
 
@@ -261,7 +1342,7 @@ static int add_inst_to_table(inst *inst_table[], int *inst_table_length,
 int init_input(char *input[], int *input_length, const char *input_dir) {
     /* add your code */
     FILE* fp;
-    int err;
+    int err = 0;
     int line_count = 0;
 
 
@@ -278,6 +1359,15 @@ int init_input(char *input[], int *input_length, const char *input_dir) {
     // 파일을 라인 단위로 읽어 소스코드 테이블에 저장
     char line[MAX_INPUT_LINES];
     while (fgets(line, MAX_INPUT_LINES, fp) != NULL) {
+        if (line_count == MAX_INPUT_LINES) {
+            fprintf(stderr, "소스코드 라인이 너무 많습니다. (최대 %d개)\n", MAX_INPUT_LINES);
+            for (int i = 0; i < line_count; i++) {
+                free(input[i]);
+            }
+            fclose(fp);
+            return -1;
+        }
+
         // 소스코드 테이블에 라인 저장
         input[line_count] = strdup(line);
         if (input[line_count] == NULL) {
@@ -291,6 +1381,7 @@ int init_input(char *input[], int *input_length, const char *input_dir) {
 
     // 입력 라인 수 설정
     *input_length = line_count;
+    run_stats.lines += line_count;
 
     fclose(fp);
 
@@ -305,6 +1396,7 @@ void init_token(token *tok) {
         tok->operand[j] = NULL;
     }
     tok->comment = NULL;
+    tok->expr = NULL;
 }
 
 /**
@@ -342,6 +1434,7 @@ int assem_pass1(const inst *inst_table[], int inst_table_length,
     int num_symbols = 0;
     int num_literals = 0;
     char current_csect[20] = "DEFAULT"; // 현재 컨트롤 섹션 이름, 초기값은 "DEFAULT"
+    macro_table macros = { NULL, 0, 0, NULL, 0 };
 
     // 심볼 테이블, 리터럴 테이블 동적 할당
     *symbol_table = (symbol*)calloc(input_length, sizeof(symbol));
@@ -357,31 +1450,89 @@ int assem_pass1(const inst *inst_table[], int inst_table_length,
 
         // 개행 문자 제거
         size_t line_length = strlen(line);
-        if (line[line_length - 1] == '\n') {
-            line[line_length - 1] = '\0'; // 개행 문자 제거
+        while (line_length > 0 && (line[line_length - 1] == '\n' || line[line_length - 1] == '\r')) {
+            line[--line_length] = '\0'; // 개행 문자 제거
         }
 
-        tokens[i] = (token *)malloc(sizeof(token));
-        if (tokens[i] == NULL) {
+        token *tok = (token *)malloc(sizeof(token));
+        if (tok == NULL) {
             fprintf(stderr, "라인 %d에서 메모리 할당 실패. \n", i);
             return -1; 
         }
 
-        init_token(tokens[i]);
+        init_token(tok);
 
-        err = token_parsing(input[i], tokens[i], inst_table, inst_table_length);
+        // 개행 문자를 제거한 라인을 파싱해야 operator만 있는 라인("\tRSUB\n")이 올바르게 분리된다
+        err = token_parsing(line, tok, inst_table, inst_table_length);
         if (err != 0) {
             fprintf(stderr, "라인 %d에서 오류 %d로 파싱 실패. \n", i, err);
+            free(line);
             return err;
         }
-        num_tokens++;
 
+        // 매크로 정의와 호출은 토큰 테이블에 넣지 않고 여기서 처리한다
+        int handled = process_macro_line(&macros, line, tok, tokens, &num_tokens);
+        free(line);
+        if (handled < 0) {
+            fprintf(stderr, "라인 %d의 매크로를 처리하지 못했습니다.\n", i);
+            return -1;
+        }
+        if (handled == 0) {
+            if (num_tokens == MAX_INPUT_LINES) {
+                fprintf(stderr, "토큰이 너무 많습니다. (최대 %d개)\n", MAX_INPUT_LINES);
+                return -1;
+            }
+            tokens[num_tokens++] = tok;
+        }
+    }
+
+    if (macros.defining != NULL) {
+        fprintf(stderr, "매크로 %s의 MEND가 없습니다.\n", macros.defining->name);
+        return -1;
+    }
+    free_macros(&macros);
+
+    // USE로 나눈 프로그램 블록을 블록 순서대로 모아 둔다
+    if ((err = arrange_program_blocks(tokens, &num_tokens, &block_stats)) < 0) {
+        return err;
+    }
+
+    // LOCCTR를 계산하기 전에 토큰 스트림에서 불필요한 명령어를 제거한다
+    if (option.peephole &&
+        (err = optimize_peephole(tokens, &num_tokens, inst_table, inst_table_length,
+                                 peephole_rules, PEEPHOLE_RULE_COUNT)) < 0) {
+        return err;
+    }
+
+    long long section_started = monotonic_ns(); // --trace: 현재 컨트롤 섹션의 시작 시각
+    for (int i = 0; i < num_tokens; ++i) {
         // 각 토큰 라인의 nixbpe 필드 초기화  
         tokens[i]->nixbpe = set_nixbpe(tokens[i], inst_table, inst_table_length);
 
+        // EQU/WORD 피연산자는 여기서 한 번만 파싱하고 이후에는 컴파일된 수식을 평가한다
+        const char *operator = tokens[i]->operator;
+        if (operator != NULL && tokens[i]->operand[0] != NULL &&
+            (strcmp(operator, "EQU") == 0 || strcmp(operator, "WORD") == 0)) {
+            if ((tokens[i]->expr = compile_expression(tokens[i]->operand[0])) == NULL) {
+                return -1;
+            }
+        }
+
         // 심볼 및 리터럴 처리 
+        char prev_csect[20];
+        strcpy(prev_csect, current_csect);
         locctr = process_token(tokens[i], inst_table, inst_table_length,
                             symbol_table, &num_symbols, literal_table, &num_literals, locctr, current_csect);
+        if (locctr < 0) {
+            return -1;
+        }
+        trace_csect(prev_csect, current_csect, &section_started);
+    }
+    trace_csect(current_csect, "", &section_started); // 마지막 컨트롤 섹션의 구간을 닫는다
+
+    // 앞으로 정의되는 심볼을 참조하는 EQU도 계산할 수 있도록 모든 라벨의 주소가 정해진 뒤 계산한다
+    if ((err = resolve_equates(tokens, num_tokens, symbol_table, num_symbols)) < 0) {
+        return err;
     }
 
     *tokens_length = num_tokens;
@@ -391,740 +1542,3678 @@ int assem_pass1(const inst *inst_table[], int inst_table_length,
     return 0;       
 }
 
-
 /**
- * @brief 한 줄의 소스코드를 파싱하여 토큰에 저장한다.
+ * @brief 여러 소스 파일의 컨트롤 섹션별 크기와 외부 정의/참조를 출력한다. (--size-only)
  *
- * @param input 파싱할 소스코드 문자열
- * @param tok 결과를 저장할 토큰 구조체 주소
  * @param inst_table 기계어 목록 테이블의 주소
  * @param inst_table_length 기계어 목록 테이블의 길이
+ * @param sources 소스 파일 경로 목록
+ * @param source_count 소스 파일 수
  * @return 오류 코드 (정상 종료 = 0)
+ *
+ * @details
+ * 빌드 계획에 필요한 섹션 길이와 EXTDEF 주소는 LOCCTR 계산만으로 정해지므로
+ * 패스 1(과 섹션 길이를 바꾸는 --literal-pools, --relax, --auto-base)까지만 수행하고
+ * 패스 2와 레코드 생성, 출력 파일 작성은 모두 건너뛴다. 기계어 목록은 한 번만 읽고,
+ * 파일마다 만든 테이블은 다음 파일로 넘어가기 전에 해제한다. 출력 형식은
+ * make_size_summary_output을 참고한다.
  */
-int token_parsing(const char *input, token *tok, const inst *inst_table[], int inst_table_length) 
-{
-    /* add your code */
-    int input_length = strlen(input);
-
-    tok->label = NULL;
-    tok->operator= NULL;
-    tok->operand[0] = NULL;
-    tok->operand[1] = NULL;
-    tok->operand[2] = NULL;
-    tok->comment = NULL;
+int assem_size_only(const inst *inst_table[], int inst_table_length,
+                    const char *sources[], int source_count) {
+    char **input = (char **)malloc(MAX_INPUT_LINES * sizeof(char *));
+    token **tokens = (token **)malloc(MAX_INPUT_LINES * sizeof(token *));
+    symbol **symbol_table = (symbol **)malloc(MAX_TABLE_LENGTH * sizeof(symbol *));
+    literal **literal_table = (literal **)malloc(MAX_TABLE_LENGTH * sizeof(literal *));
+    int err = 0;
 
-    if (input[0] == '.') {
-        if ((tok->comment = (char *)malloc(input_length)) == NULL)
-            return -1;
-        sscanf(input + 1, " %[^\0]", tok->comment);
-        tok->comment[input_length] = '\0';
-    } else {
-        int token_cnt = 0;
-        for (int st = 0; st < input_length && token_cnt < 3; ++st) {
-            int end = st;
-            for (; input[end] != '\t' && input[end] != '\0'; ++end)
-                ;
+    if (input == NULL || tokens == NULL || symbol_table == NULL || literal_table == NULL) {
+        fprintf(stderr, "메모리 할당 실패\n");
+        err = -1;
+    }
 
-            switch (token_cnt) {
-                case 0:
-                    if (st < end) {
-                        if ((tok->label = (char *)malloc(end - st + 1)) == NULL)
-                            return -1;
-                        memcpy(tok->label, input + st, end - st);
-                        tok->label[end - st] = '\0';
-                    }
-                    break;
+    for (int i = 0; i < source_count && err == 0; i++) {
+        long long job_started = monotonic_ns();
+        err = size_source(inst_table, inst_table_length, sources[i],
+                          input, tokens, symbol_table, literal_table);
+        if (option.trace_path != NULL) {
+            trace_record(&main_trace, "job", sources[i], job_started, monotonic_ns());
+        }
+        if (err < 0) {
+            fprintf(stderr, "%s의 크기를 계산하지 못했습니다.\n", sources[i]);
+        }
+    }
 
-                case 1:
-                    if (st < end) {
-                        if ((tok->operator=(char *) malloc(end - st + 1)) ==
-                            NULL)
-                            return -1;
-                        memcpy(tok->operator, input + st, end - st);
-                        tok->operator[end - st] = '\0';
-                    }
-                    break;
+    free(input);
+    free(tokens);
+    free(symbol_table);
+    free(literal_table);
 
-                case 2:
-                    if (st < end) {
-                        int err;
-                        if ((err = token_operand_parsing(input + st, end - st,
-                                                         tok->operand)) != 0)
-                            return err;
-                    }
+    return err;
+}
 
-                    st = end + 1;
-                    end = input_length;
-                    if (st < end) {
-                        if ((tok->comment = (char *)malloc(end - st + 1)) ==
-                            NULL)
-                            return -1;
-                        memcpy(tok->comment, input + st, end - st);
-                        tok->comment[end - st] = '\0';
-                    }
-            }
+/**
+ * @brief 소스 파일 하나에 대해 패스 1을 수행하고 크기 요약을 출력한 뒤 테이블을 해제한다.
+ */
+static int size_source(const inst *inst_table[], int inst_table_length, const char *source,
+                       char *input[], token *tokens[], symbol *symbol_table[], literal *literal_table[]) {
+    int input_length = 0;
+    int tokens_length = 0;
+    int symbol_table_length = 0;
+    int literal_table_length = 0;
+
+    int err = init_input(input, &input_length, source);
+    if (err == 0) {
+        err = assem_pass1(inst_table, inst_table_length, (const char **)input, input_length,
+                          tokens, &tokens_length, symbol_table, &symbol_table_length,
+                          literal_table, &literal_table_length);
+    }
+    if (err == 0 && option.literal_pools) {
+        pool_result pools;
+        err = place_literal_pools(tokens, &tokens_length, inst_table, inst_table_length,
+                                  symbol_table, &symbol_table_length,
+                                  literal_table, &literal_table_length, &pools);
+    }
+    if (err == 0 && option.relax) {
+        relax_result relax;
+        err = relax_formats(tokens, tokens_length, inst_table, inst_table_length,
+                            symbol_table, &symbol_table_length,
+                            literal_table, &literal_table_length, &relax);
+    }
+    if (err == 0 && option.auto_base) {
+        base_result base;
+        err = choose_base_registers(tokens, &tokens_length, inst_table, inst_table_length,
+                                    symbol_table, &symbol_table_length,
+                                    literal_table, &literal_table_length, &base);
+    }
+    run_stats.tokens += tokens_length;
+    run_stats.symbols += symbol_table_length;
+    run_stats.literals += literal_table_length;
+    if (err == 0) {
+        err = make_size_summary_output(NULL, source, (const token **)tokens, tokens_length,
+                                       inst_table, inst_table_length,
+                                       (const symbol **)symbol_table, symbol_table_length,
+                                       (const literal **)literal_table, literal_table_length);
+    }
 
-            ++token_cnt;
-            st = end;
-        }
+    for (int i = 0; i < input_length; i++) {
+        free(input[i]);
+    }
+    for (int i = 0; i < tokens_length; i++) {
+        free_token(tokens[i]);
+    }
+    for (int i = 0; i < symbol_table_length; i++) {
+        free(symbol_table[i]);
+    }
+    for (int i = 0; i < literal_table_length; i++) {
+        free(literal_table[i]);
     }
 
-    return 0;
+    return err;
 }
 
 /**
- * @brief 피연산자 문자열을 파싱하여 operand에 저장함. 문자열은 \0으로 끝나지
- * 않을 수 있기에, operand_input_length로 문자열의 길이를 전달해야 함.
- */
-static int token_operand_parsing(const char *operand_input,
-                                 int operand_input_length, char *operand[]) {
-    int operand_cnt = 0;
-    int st = 0;
-    while (st < operand_input_length && operand_cnt < 3) {
-        while (st < operand_input_length && (operand_input[st] == ' ' || operand_input[st] == '\t' || operand_input[st] == '\n')) {
-            st++;  // 시작 지점에서 화이트스페이스 및 개행문자 건너뛰기
+ * @brief USE 지시어로 나눈 프로그램 블록을 컨트롤 섹션마다 블록 순서대로 배치한다.
+ *
+ * @param tokens 토큰 테이블의 시작 주소
+ * @param tokens_length 토큰 테이블의 길이를 저장하는 변수 주소 (USE 라인만큼 줄어든다)
+ * @param result 배치 결과를 저장할 구조체 주소
+ * @return 오류 코드 (정상 종료 = 0)
+ *
+ * @details
+ * 블록마다 LOCCTR를 따로 두고 패스 1이 끝난 뒤 블록 시작 주소를 더하는 것과 같은
+ * 결과를 얻기 위해, LOCCTR를 계산하기 전에 각 컨트롤 섹션의 라인을 기본 블록,
+ * 처음 등장한 순서대로의 이름 있는 블록 순으로 안정적으로 재배치한다. 블록 안에서의
+ * 라인 순서는 그대로이므로 블록 기준 주소는 바뀌지 않고, 이후의 LOCCTR 계산과
+ * 패스 2는 블록을 모르는 채로 이어진 주소를 얻는다. 코드 사이에 선언한 RESW/RESB를
+ * 데이터 블록으로 옮기면 코드가 연속으로 놓여 T 레코드가 덜 끊긴다.
+ * 블록 이름은 컨트롤 섹션마다 따로이며 심볼이 아니다. END 라인의 리터럴 풀은
+ * 마지막 블록 뒤에 놓인다.
+ */
+int arrange_program_blocks(token *tokens[], int *tokens_length, block_result *result) {
+    int length = *tokens_length;
+    int rebuilt_length = 0;
+    int first = 0;
+    int err = 0;
+
+    memset(result, 0, sizeof(block_result));
+    if (length == 0) return 0;
+
+    token **rebuilt = (token **)malloc(length * sizeof(token *));
+    signed char *blocks = (signed char *)malloc(length); // 라인별 블록 번호 (-1 = USE 라인)
+    if (rebuilt == NULL || blocks == NULL) {
+        fprintf(stderr, "프로그램 블록 배치를 위한 메모리 할당 실패\n");
+        free(rebuilt);
+        free(blocks);
+        return -1;
+    }
+
+    // START/CSECT부터 다음 CSECT/END 직전까지를 한 컨트롤 섹션으로 본다
+    for (int i = 1; i <= length && err == 0; i++) {
+        const char *operator = i < length ? tokens[i]->operator : NULL;
+        if (i < length && (operator == NULL ||
+                           (strcmp(operator, "CSECT") != 0 && strcmp(operator, "END") != 0))) {
+            continue;
         }
+        err = arrange_section_blocks(tokens, first, i, blocks, rebuilt, &rebuilt_length, result);
+        first = i;
+    }
 
-        int end = st;
-        for (; end < operand_input_length && operand_input[end] != ',' && operand_input[end] != '\t' && 
-               operand_input[end] != '\0' && operand_input[end] != '\n'; ++end)
+    if (err == 0) {
+        memcpy(tokens, rebuilt, rebuilt_length * sizeof(token *));
+        *tokens_length = rebuilt_length;
+    }
+    free(rebuilt);
+    free(blocks);
+
+    return err;
+}
+
+/**
+ * @brief 컨트롤 섹션 하나(tokens[first] ~ tokens[last - 1])의 라인을 블록 순서대로 rebuilt에 추가한다.
+ *
+ * @details
+ * blocks[first] ~ blocks[last - 1]에는 라인별 블록 번호를 기록하며, USE 라인은 해제한다.
+ */
+static int arrange_section_blocks(token *tokens[], int first, int last, signed char blocks[],
+                                  token *rebuilt[], int *rebuilt_length, block_result *result) {
+    char names[MAX_PROGRAM_BLOCKS][10] = { "" };
+    int block_count = 1;
+    int current = 0;
+
+    for (int i = first; i < last; i++) {
+        const token *tok = tokens[i];
+        if (tok->operator == NULL || strcmp(tok->operator, "USE") != 0) {
+            blocks[i] = current;
+            continue;
+        }
+
+        if (tok->label != NULL) {
+            fprintf(stderr, "USE에는 라벨(%s)을 붙일 수 없습니다.\n", tok->label);
+            return -1;
+        }
+
+        const char *name = tok->operand[0] != NULL ? tok->operand[0] : "";
+        if (strlen(name) >= sizeof(names[0])) {
+            fprintf(stderr, "프로그램 블록 이름 %s이(가) 너무 깁니다.\n", name);
+            return -1;
+        }
+
+        for (current = 0; current < block_count && strcmp(names[current], name) != 0; current++)
             ;
+        if (current == block_count) {
+            if (block_count == MAX_PROGRAM_BLOCKS) {
+                fprintf(stderr, "프로그램 블록이 너무 많습니다. (최대 %d개)\n", MAX_PROGRAM_BLOCKS);
+                return -1;
+            }
+            strcpy(names[block_count++], name);
+        }
+        blocks[i] = -1; // USE 라인은 배치 후 버린다
+    }
+
+    for (int b = 0; b < block_count; b++) {
+        for (int i = first; i < last; i++) {
+            if (blocks[i] == b) {
+                rebuilt[(*rebuilt_length)++] = tokens[i];
+                if (b > 0) result->moved_lines++;
+            }
+        }
+    }
+    for (int i = first; i < last; i++) {
+        if (blocks[i] == -1) free_token(tokens[i]);
+    }
+    result->blocks += block_count - 1;
+
+    return 0;
+}
+
+/**
+ * @brief 토큰 스트림에 핍홀 최적화 규칙을 적용한다. (--peephole)
+ *
+ * @param tokens 토큰 테이블의 시작 주소
+ * @param tokens_length 토큰 테이블의 길이를 저장하는 변수 주소
+ * @param inst_table 기계어 목록 테이블의 주소
+ * @param inst_table_length 기계어 목록 테이블의 길이
+ * @param rules 규칙 테이블의 시작 주소 (적용 횟수가 누적된다)
+ * @param rule_count 규칙 테이블의 길이
+ * @return 오류 코드 (정상 종료 = 0)
+ *
+ * @details
+ * 주석 라인을 건너뛰고 바로 이어지는 두 명령어마다 규칙을 순서대로 맞춰 보고,
+ * 일치하면 규칙이 고른 토큰을 제거한다. 제거로 새로 이웃하게 된 명령어끼리도
+ * 규칙이 맞을 수 있으므로 더 이상 제거할 명령어가 없을 때까지 반복한다. 지시어가
+ * 사이에 있는 명령어는 이웃으로 보지 않으므로 섹션 경계를 넘어 적용되는 일은 없다.
+ * 패스 1의 LOCCTR 계산 전에 수행하므로 심볼 주소는 줄어든 코드를 기준으로 정해진다.
+ */
+int optimize_peephole(token *tokens[], int *tokens_length,
+                      const inst *inst_table[], int inst_table_length,
+                      peephole_rule rules[], int rule_count) {
+    int length = *tokens_length;
+    bool changed = true;
+
+    while (changed) {
+        changed = false;
+        int first = -1; // 직전 명령어 토큰의 인덱스
+
+        for (int i = 0; i < length; i++) {
+            const char *operator = tokens[i]->operator;
+            if (operator == NULL) continue; // 주석 라인
+
+            int index = search_opcode(operator, inst_table, inst_table_length);
+            if (index == -1) {
+                first = -1;
+                continue;
+            }
+            if (first == -1) {
+                first = i;
+                continue;
+            }
+
+            int removed = -1;
+            int rule = 0;
+            for (; rule < rule_count && removed == -1; rule++) {
+                removed = rules[rule].match(tokens, first, i);
+            }
+            if (removed == -1) {
+                first = i;
+                continue;
+            }
+
+            const char *removed_operator = tokens[removed]->operator;
+            int removed_index = search_opcode(removed_operator, inst_table, inst_table_length);
+            rules[rule - 1].hits++;
+            rules[rule - 1].bytes_saved += removed_operator[0] == '+' ? 4 : inst_table[removed_index]->format;
+
+            free_token(tokens[removed]);
+            memmove(&tokens[removed], &tokens[removed + 1], (length - removed - 1) * sizeof(token *));
+            length--;
+            changed = true;
+
+            // 남은 명령어를 새 기준으로 다음 명령어와 다시 비교한다
+            first = removed == first ? i - 1 : first;
+            i--;
+        }
+    }
+
+    *tokens_length = length;
+
+    return 0;
+}
+
+/**
+ * @brief 두 토큰의 피연산자가 모두 같은지 확인한다.
+ */
+static bool same_operands(const token *a, const token *b) {
+    for (int i = 0; i < MAX_OPERAND_PER_INST; i++) {
+        if ((a->operand[i] == NULL) != (b->operand[i] == NULL)) return false;
+        if (a->operand[i] != NULL && strcmp(a->operand[i], b->operand[i]) != 0) return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief STr m 바로 다음의 LDr m은 레지스터 값을 바꾸지 않으므로 LDr를 제거한다.
+ * LDr로 점프해 들어오는 경로가 있을 수 있으므로 LDr에 라벨이 없을 때만 적용한다.
+ */
+static int peephole_store_load(token *tokens[], int first, int second) {
+    static const char *pairs[][2] = {
+        { "STA", "LDA" }, { "STX", "LDX" }, { "STL", "LDL" }, { "STB", "LDB" },
+        { "STS", "LDS" }, { "STT", "LDT" }, { "STF", "LDF" },
+    };
+    const char *store = tokens[first]->operator;
+    const char *load = tokens[second]->operator;
+    const char *operand = tokens[first]->operand[0];
+    store = store[0] == '+' ? store + 1 : store;
+    load = load[0] == '+' ? load + 1 : load;
+
+    // 간접 주소는 저장한 값이 포인터 자신을 덮어쓸 수 있다
+    if (tokens[second]->label != NULL || operand == NULL || operand[0] == '#' ||
+        operand[0] == '@' || operand[0] == '=' || !same_operands(tokens[first], tokens[second])) {
+        return -1;
+    }
+    for (int i = 0; i < (int)(sizeof(pairs) / sizeof(pairs[0])); i++) {
+        if (strcmp(store, pairs[i][0]) == 0 && strcmp(load, pairs[i][1]) == 0) {
+            return second;
+        }
+    }
+
+    return -1;
+}
+
+/**
+ * @brief CLEAR r 바로 다음에 r 전체를 다시 적재하면 CLEAR는 효과가 없으므로 제거한다.
+ * CLEAR의 라벨은 적재 명령어로 옮긴다. 적재 명령어가 r을 인덱스로 사용하거나 두
+ * 명령어 모두 라벨이 있으면 적용하지 않는다.
+ */
+static int peephole_clear_load(token *tokens[], int first, int second) {
+    static const char *loads[][2] = {
+        { "A", "LDA" }, { "X", "LDX" }, { "L", "LDL" }, { "B", "LDB" },
+        { "S", "LDS" }, { "T", "LDT" }, { "F", "LDF" },
+    };
+    token *clear = tokens[first];
+    token *load = tokens[second];
+    const char *mnemonic = load->operator[0] == '+' ? load->operator + 1 : load->operator;
+
+    if (strcmp(clear->operator, "CLEAR") != 0 || clear->operand[0] == NULL ||
+        (clear->label != NULL && load->label != NULL)) {
+        return -1;
+    }
+    if (load->operand[1] != NULL && strcmp(load->operand[1], clear->operand[0]) == 0) {
+        return -1;
+    }
+    for (int i = 0; i < (int)(sizeof(loads) / sizeof(loads[0])); i++) {
+        if (strcmp(clear->operand[0], loads[i][0]) == 0 && strcmp(mnemonic, loads[i][1]) == 0) {
+            load->label = load->label != NULL ? load->label : clear->label;
+            clear->label = NULL;
+            return first;
+        }
+    }
+
+    return -1;
+}
+
+/**
+ * @brief 바로 다음 명령어의 라벨로 점프하는 J/JEQ/JGT/JLT는 실행 흐름을 바꾸지 않으므로
+ * 제거한다. 점프 명령어에 라벨이 있으면 적용하지 않는다.
+ */
+static int peephole_jump_next(token *tokens[], int first, int second) {
+    static const char *jumps[] = { "J", "JEQ", "JGT", "JLT" };
+    const token *jump = tokens[first];
+    const char *mnemonic = jump->operator[0] == '+' ? jump->operator + 1 : jump->operator;
+
+    if (jump->label != NULL || tokens[second]->label == NULL || jump->operand[0] == NULL ||
+        jump->operand[1] != NULL || strcmp(jump->operand[0], tokens[second]->label) != 0) {
+        return -1;
+    }
+    for (int i = 0; i < (int)(sizeof(jumps) / sizeof(jumps[0])); i++) {
+        if (strcmp(mnemonic, jumps[i]) == 0) {
+            return first;
+        }
+    }
+
+    return -1;
+}
+
+/**
+ * @brief 패스 1 이후 3/4형식 명령어마다 가장 짧은 형식을 고른다. (--relax)
+ *
+ * @param tokens 토큰 테이블의 시작 주소
+ * @param tokens_length 토큰 테이블의 길이
+ * @param inst_table 기계어 목록 테이블의 주소
+ * @param inst_table_length 기계어 목록 테이블의 길이
+ * @param symbol_table 심볼 테이블의 시작 주소
+ * @param symbol_table_length 심볼 테이블의 길이를 저장하는 변수 주소
+ * @param literal_table 리터럴 테이블의 시작 주소
+ * @param literal_table_length 리터럴 테이블의 길이를 저장하는 변수 주소
+ * @param result 수행 결과를 저장할 구조체 주소
+ * @return 오류 코드 (정상 종료 = 0)
+ *
+ * @details
+ * 같은 섹션의 심볼이나 리터럴을 가리키는 명령어는 모두 3형식으로 시작하고,
+ * 외부 참조와 12비트(0 ~ 0xFFF)를 벗어나는 상수 즉시값("#-5" 포함)은 4형식으로
+ * 정한다. 그 다음 LOCCTR와 심볼 주소를 다시 계산하여 PC 상대 변위도, BASE
+ * 지시어가 지정한 베이스 상대 변위도 범위를 벗어나는 명령어만 4형식으로 늘리는
+ * 과정을 더 이상 바뀌는 명령어가 없을 때까지 반복한다. 명령어는 늘어나기만
+ * 하므로 반복은 반드시 끝난다. 형식은 operator 앞의 '+'로 표시하므로 패스 2는
+ * 바뀐 토큰을 그대로 사용한다.
+ */
+int relax_formats(token *tokens[], int tokens_length,
+                  const inst *inst_table[], int inst_table_length,
+                  symbol *symbol_table[], int *symbol_table_length,
+                  literal *literal_table[], int *literal_table_length,
+                  relax_result *result) {
+    int err = 0;
+    bool *candidate = (bool *)calloc(tokens_length, sizeof(bool));
+    bool *original = (bool *)calloc(tokens_length, sizeof(bool));
+    int *addresses = (int *)malloc(tokens_length * sizeof(int));
+
+    if (candidate == NULL || original == NULL || addresses == NULL) {
+        fprintf(stderr, "메모리 할당 실패\n");
+        err = -1;
+    } else {
+        err = relax_token_formats(tokens, tokens_length, inst_table, inst_table_length,
+                                  symbol_table, symbol_table_length,
+                                  literal_table, literal_table_length,
+                                  candidate, original, addresses, result);
+    }
+
+    free(candidate);
+    free(original);
+    free(addresses);
+
+    return err;
+}
+
+/**
+ * @brief relax_formats의 본체. `candidate`는 변위에 따라 형식이 바뀔 수 있는
+ * 명령어, `original`은 소스에서 4형식이었던 명령어를 표시한다.
+ */
+static int relax_token_formats(token *tokens[], int tokens_length,
+                               const inst *inst_table[], int inst_table_length,
+                               symbol *symbol_table[], int *symbol_table_length,
+                               literal *literal_table[], int *literal_table_length,
+                               bool candidate[], bool original[], int addresses[],
+                               relax_result *result) {
+    int err;
+    char current_csect[20] = "DEFAULT";
+
+    memset(result, 0, sizeof(relax_result));
+    int before = instruction_bytes(tokens, tokens_length, inst_table, inst_table_length);
+
+    // 초기 형식 결정: 같은 섹션의 주소를 가리키는 명령어는 3형식에서 시작
+    for (int i = 0; i < tokens_length; i++) {
+        token *tok = tokens[i];
+        const char *operand = tok->operand[0];
+        if (tok->operator == NULL) continue;
+
+        if (strcmp(tok->operator, "START") == 0 || strcmp(tok->operator, "CSECT") == 0) {
+            strcpy(current_csect, tok->label);
+            continue;
+        }
+
+        int index = search_opcode(tok->operator, inst_table, inst_table_length);
+        if (index == -1 || inst_table[index]->format != 3 || operand == NULL) continue;
+
+        bool extended;
+        int value;
+        original[i] = tok->operator[0] == '+';
+        if (immediate_constant(operand, &value)) {
+            // 상수 즉시값은 12비트(0 ~ 0xFFF)에 들어가면 3형식, 아니면 20비트 필드에 기록한다
+            extended = value < 0 || value > 0xFFF;
+        } else if (operand[0] == '=') {
+            candidate[i] = true;
+            extended = false;
+        } else {
+            const char *name = (operand[0] == '#' || operand[0] == '@') ? operand + 1 : operand;
+            candidate[i] = search_symbol(symbol_table, *symbol_table_length, name, current_csect) != NULL;
+            extended = !candidate[i];
+        }
+
+        if ((err = set_instruction_format(tok, extended, inst_table, inst_table_length)) < 0) {
+            return err;
+        }
+    }
+
+    // 고정점에 도달할 때까지 주소를 다시 계산하고 범위를 벗어난 명령어를 늘린다
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        result->iterations++;
+        if ((err = assign_addresses(tokens, tokens_length, inst_table, inst_table_length,
+                                    symbol_table, symbol_table_length,
+                                    literal_table, literal_table_length, addresses)) < 0) {
+            return err;
+        }
+
+        int base = -1;
+        strcpy(current_csect, "DEFAULT");
+        for (int i = 0; i < tokens_length; i++) {
+            token *tok = tokens[i];
+            if (tok->operator == NULL) continue;
+            if (strcmp(tok->operator, "START") == 0 || strcmp(tok->operator, "CSECT") == 0) {
+                strcpy(current_csect, tok->label);
+                base = -1;
+                continue;
+            }
+            if (strcmp(tok->operator, "NOBASE") == 0) {
+                base = -1;
+            } else if (strcmp(tok->operator, "BASE") == 0) {
+                if ((base = base_address(tok, (const symbol **)symbol_table, *symbol_table_length,
+                                         current_csect, addresses[i])) < 0) {
+                    return -1;
+                }
+            }
+            if (!candidate[i] || tok->operator[0] == '+') continue;
+
+            const char *operand = tok->operand[0];
+            int target;
+            bool absolute = false;
+            if (operand[0] == '=') {
+                literal *lit = search_literal(literal_table, *literal_table_length, operand, current_csect);
+                if (lit == NULL || lit->addr == -1) continue;
+                target = lit->addr;
+            } else {
+                const char *name = (operand[0] == '#' || operand[0] == '@') ? operand + 1 : operand;
+                symbol *sym = search_symbol(symbol_table, *symbol_table_length, name, current_csect);
+                target = sym->addr;
+                absolute = sym->absolute;
+            }
+
+            // 절대값 심볼은 값이 12비트에 들어가야 하고, 그 외에는 PC 상대, BASE 상대
+            // 순서로 시도하여 둘 다 안 되면 4형식
+            int displacement = target - (addresses[i] + 3);
+            bool base_relative = base >= 0 && target - base >= 0 && target - base <= 0xFFF;
+            bool fits = absolute ? (target >= 0 && target <= 0xFFF) :
+                        ((displacement >= -2048 && displacement <= 2047) || base_relative);
+            if (!fits) {
+                if ((err = set_instruction_format(tok, true, inst_table, inst_table_length)) < 0) {
+                    return err;
+                }
+                changed = true;
+            }
+        }
+    }
+
+    for (int i = 0; i < tokens_length; i++) {
+        if (tokens[i]->operator == NULL) continue;
+        bool extended = tokens[i]->operator[0] == '+';
+        if (original[i] && !extended) result->shortened++;
+        if (!original[i] && extended) result->lengthened++;
+    }
+    result->bytes_saved = before - instruction_bytes(tokens, tokens_length, inst_table, inst_table_length);
+
+    return 0;
+}
+
+/**
+ * @brief 리터럴을 사용하는 명령어 가까이에 리터럴 풀(LTORG)을 자동으로 추가한다. (--literal-pools)
+ *
+ * @param tokens 토큰 테이블의 시작 주소
+ * @param tokens_length 토큰 테이블의 길이를 저장하는 변수 주소
+ * @param inst_table 기계어 목록 테이블의 주소
+ * @param inst_table_length 기계어 목록 테이블의 길이
+ * @param symbol_table 심볼 테이블의 시작 주소
+ * @param symbol_table_length 심볼 테이블의 길이를 저장하는 변수 주소
+ * @param literal_table 리터럴 테이블의 시작 주소
+ * @param literal_table_length 리터럴 테이블의 길이를 저장하는 변수 주소
+ * @param result 수행 결과를 저장할 구조체 주소
+ * @return 오류 코드 (정상 종료 = 0)
+ *
+ * @details
+ * 실행 흐름이 이어지지 않는 위치, 즉 J와 RSUB 바로 다음은 데이터를 두어도
+ * 실행되지 않는다. 마지막 리터럴 풀 이후에 PC 상대 주소로 리터럴에 닿지 않는
+ * 명령어가 있으면 그 다음의 J/RSUB 뒤에 LTORG를 넣어, 리터럴이 사용한 명령어에서
+ * 가장 가까운 곳에 놓이도록 한다. 이미 닿는 리터럴은 옮기지 않는다. 추가 전후로
+ * 12비트 PC 상대 주소로 닿지 않는 리터럴 참조 수를 세어 보고한다.
+ */
+int place_literal_pools(token *tokens[], int *tokens_length,
+                        const inst *inst_table[], int inst_table_length,
+                        symbol *symbol_table[], int *symbol_table_length,
+                        literal *literal_table[], int *literal_table_length,
+                        pool_result *result) {
+    int length = *tokens_length;
+    int *addresses = (int *)malloc(MAX_INPUT_LINES * sizeof(int));
+    bool *far = (bool *)calloc(length, sizeof(bool));
+    token **rebuilt = (token **)malloc(MAX_INPUT_LINES * sizeof(token *));
+    int rebuilt_length = 0;
+    bool pending = false; // 마지막 리터럴 풀 이후에 닿지 않는 리터럴을 사용했는지 여부
+    int err = 0;
+
+    memset(result, 0, sizeof(pool_result));
+    if (addresses == NULL || far == NULL || rebuilt == NULL ||
+        assign_addresses(tokens, length, inst_table, inst_table_length,
+                         symbol_table, symbol_table_length,
+                         literal_table, literal_table_length, addresses) < 0) {
+        fprintf(stderr, "리터럴 풀 배치를 준비하지 못했습니다.\n");
+        free(addresses);
+        free(far);
+        free(rebuilt);
+        return -1;
+    }
+    result->far_before = far_literal_references(tokens, length, addresses, inst_table, inst_table_length,
+                                                literal_table, *literal_table_length, far);
+
+    for (int i = 0; i < length; i++) {
+        token *tok = tokens[i];
+        const char *operator = tok->operator;
+        rebuilt[rebuilt_length++] = tok;
+        if (operator == NULL) continue;
+
+        if (strcmp(operator, "LTORG") == 0 || strcmp(operator, "CSECT") == 0) {
+            pending = false;
+            continue;
+        }
+        if (far[i]) {
+            pending = true;
+        }
+
+        const char *mnemonic = operator[0] == '+' ? operator + 1 : operator;
+        if (!pending || (strcmp(mnemonic, "J") != 0 && strcmp(mnemonic, "RSUB") != 0)) continue;
+
+        // 바로 다음이 리터럴 풀이 놓이는 자리라면 추가할 필요가 없다
+        int next = i + 1;
+        while (next < length && tokens[next]->operator == NULL) next++;
+        if (next == length || strcmp(tokens[next]->operator, "LTORG") == 0 ||
+            strcmp(tokens[next]->operator, "END") == 0 || strcmp(tokens[next]->operator, "CSECT") == 0) {
+            continue;
+        }
+
+        if (length + result->pools + 1 > MAX_INPUT_LINES) {
+            fprintf(stderr, "토큰이 너무 많아 LTORG를 추가할 수 없습니다. (최대 %d개)\n", MAX_INPUT_LINES);
+            err = -1;
+            break;
+        }
+        token *ltorg = make_token(NULL, "LTORG", NULL, inst_table, inst_table_length);
+        if (ltorg == NULL) {
+            err = -1;
+            break;
+        }
+        rebuilt[rebuilt_length++] = ltorg;
+        result->pools++;
+        pending = false;
+    }
+
+    if (err == 0) {
+        memcpy(tokens, rebuilt, rebuilt_length * sizeof(token *));
+        *tokens_length = rebuilt_length;
+        err = assign_addresses(tokens, rebuilt_length, inst_table, inst_table_length,
+                               symbol_table, symbol_table_length,
+                               literal_table, literal_table_length, addresses);
+        result->far_after = far_literal_references(tokens, rebuilt_length, addresses, inst_table,
+                                                   inst_table_length, literal_table, *literal_table_length, NULL);
+    }
+
+    free(addresses);
+    free(far);
+    free(rebuilt);
+
+    return err;
+}
+
+/**
+ * @brief 3형식으로 인코딩했을 때 PC 상대 변위가 12비트를 벗어나는 리터럴 참조 수를 센다.
+ * `far`가 NULL이 아니면 토큰별로 닿지 않는지 여부를 기록한다.
+ */
+static int far_literal_references(token *tokens[], int tokens_length, const int addresses[],
+                                  const inst *inst_table[], int inst_table_length,
+                                  literal *literal_table[], int literal_table_length, bool far[]) {
+    char current_csect[20] = "DEFAULT";
+    int count = 0;
+
+    for (int i = 0; i < tokens_length; i++) {
+        const token *tok = tokens[i];
+        if (tok->operator == NULL) continue;
+        if (strcmp(tok->operator, "START") == 0 || strcmp(tok->operator, "CSECT") == 0) {
+            strcpy(current_csect, tok->label);
+            continue;
+        }
+        if (tok->operand[0] == NULL || tok->operand[0][0] != '=') continue;
+
+        int index = search_opcode(tok->operator, inst_table, inst_table_length);
+        literal *lit = search_literal(literal_table, literal_table_length, tok->operand[0], current_csect);
+        if (index == -1 || inst_table[index]->format != 3 || lit == NULL) continue;
+
+        int displacement = lit->addr - (addresses[i] + 3);
+        if (lit->addr == -1 || displacement < -2048 || displacement > 2047) {
+            if (far != NULL) far[i] = true;
+            count++;
+        }
+    }
+
+    return count;
+}
+
+/**
+ * @brief 컨트롤 섹션마다 베이스 레지스터를 적재할 위치를 정하여 LDB/BASE를 추가한다. (--auto-base)
+ *
+ * @param tokens 토큰 테이블의 시작 주소
+ * @param tokens_length 토큰 테이블의 길이를 저장하는 변수 주소
+ * @param inst_table 기계어 목록 테이블의 주소
+ * @param inst_table_length 기계어 목록 테이블의 길이
+ * @param symbol_table 심볼 테이블의 시작 주소
+ * @param symbol_table_length 심볼 테이블의 길이를 저장하는 변수 주소
+ * @param literal_table 리터럴 테이블의 시작 주소
+ * @param literal_table_length 리터럴 테이블의 길이를 저장하는 변수 주소
+ * @param result 수행 결과를 저장할 구조체 주소
+ * @return 오류 코드 (정상 종료 = 0)
+ *
+ * @details
+ * relax_formats 이후에 호출한다. 섹션에서 PC 상대 주소로 닿지 않아 4형식이 된
+ * 명령어의 목표 주소를 모아, 4096바이트 창에 가장 많이 들어가는 심볼을 베이스로
+ * 고른다. 베이스 레지스터는 다른 섹션이 바꿀 수 있으므로 섹션의 첫 명령어,
+ * EXTDEF로 공개한 명령어 라벨, 모든 JSUB의 복귀 위치에 LDB를 넣는다. B 레지스터를
+ * 직접 사용하는 섹션은 건드리지 않으며, 줄어드는 바이트가 LDB의 비용(3바이트)보다
+ * 클 때만 적용한다. 적용 후 relax_formats를 다시 수행하여 형식을 확정한다.
+ */
+int choose_base_registers(token *tokens[], int *tokens_length,
+                          const inst *inst_table[], int inst_table_length,
+                          symbol *symbol_table[], int *symbol_table_length,
+                          literal *literal_table[], int *literal_table_length,
+                          base_result *result) {
+    int length = *tokens_length;
+    int before = instruction_bytes(tokens, length, inst_table, inst_table_length);
+    char (*section_base)[10] = calloc(length, sizeof(*section_base)); // 섹션 시작 토큰별 베이스 심볼
+    token **rebuilt = (token **)malloc(MAX_INPUT_LINES * sizeof(token *));
+    int rebuilt_length = 0;
+    int err = 0;
+
+    memset(result, 0, sizeof(base_result));
+    if (section_base == NULL || rebuilt == NULL) {
+        fprintf(stderr, "메모리 할당 실패\n");
+        free(section_base);
+        free(rebuilt);
+        return -1;
+    }
+
+    // 섹션별 베이스 선택 (심볼 테이블은 relax_formats가 계산한 주소를 담고 있다)
+    for (int first = 0; first < length; first++) {
+        const char *operator = tokens[first]->operator;
+        if (operator == NULL || (strcmp(operator, "START") != 0 && strcmp(operator, "CSECT") != 0)) {
+            continue;
+        }
+
+        int last = first + 1;
+        while (last < length && (tokens[last]->operator == NULL || strcmp(tokens[last]->operator, "CSECT") != 0)) {
+            last++;
+        }
+
+        if (!uses_base_register(tokens, first, last, inst_table, inst_table_length) &&
+            pick_section_base(tokens, first, last, inst_table, inst_table_length,
+                              symbol_table, *symbol_table_length, literal_table, *literal_table_length,
+                              section_base[first])) {
+            result->sections++;
+        }
+        first = last - 1;
+    }
+
+    // LDB/BASE를 끼워 넣은 새 토큰 테이블 구성
+    const char *base_symbol = NULL;
+    int section_first = 0;
+    bool entered = false;
+    for (int i = 0; err == 0 && i < length; i++) {
+        token *tok = tokens[i];
+        const char *operator = tok->operator;
+
+        if (operator != NULL && (strcmp(operator, "START") == 0 || strcmp(operator, "CSECT") == 0)) {
+            base_symbol = section_base[i][0] != '\0' ? section_base[i] : NULL;
+            section_first = i;
+            entered = false;
+        }
+
+        bool load = base_symbol != NULL && operator != NULL &&
+                    search_opcode(operator, inst_table, inst_table_length) != -1 &&
+                    (!entered || is_base_load_point(tokens, section_first, i));
+        if (load && rebuilt_length + 3 < MAX_INPUT_LINES) {
+            char operand[12];
+            sprintf(operand, "#%s", base_symbol);
+
+            // 라벨은 LDB로 옮겨 이 위치로 들어오는 제어도 베이스를 적재하게 한다
+            token *ldb = make_token(tok->label, "LDB", operand, inst_table, inst_table_length);
+            if (ldb == NULL) {
+                err = -1;
+                break;
+            }
+            free(tok->label);
+            tok->label = NULL;
+            rebuilt[rebuilt_length++] = ldb;
+            result->load_points++;
+
+            if (!entered) {
+                token *base = make_token(NULL, "BASE", base_symbol, inst_table, inst_table_length);
+                if (base == NULL) {
+                    err = -1;
+                    break;
+                }
+                rebuilt[rebuilt_length++] = base;
+            }
+        } else if (load) {
+            fprintf(stderr, "토큰이 너무 많아 LDB를 추가할 수 없습니다. (최대 %d개)\n", MAX_INPUT_LINES);
+            err = -1;
+            break;
+        }
+        if (base_symbol != NULL && search_opcode(operator == NULL ? "" : operator, inst_table, inst_table_length) != -1) {
+            entered = true;
+        }
+
+        rebuilt[rebuilt_length++] = tok;
+
+        // JSUB에서 돌아온 뒤에는 호출된 섹션이 B를 바꾸었을 수 있다
+        if (base_symbol != NULL && operator != NULL &&
+            strcmp(operator[0] == '+' ? operator + 1 : operator, "JSUB") == 0) {
+            char operand[12];
+            sprintf(operand, "#%s", base_symbol);
+            token *ldb = make_token(NULL, "LDB", operand, inst_table, inst_table_length);
+            if (ldb == NULL || rebuilt_length + 1 >= MAX_INPUT_LINES) {
+                fprintf(stderr, "LDB를 추가할 수 없습니다.\n");
+                err = -1;
+                break;
+            }
+            rebuilt[rebuilt_length++] = ldb;
+            result->load_points++;
+        }
+    }
+
+    if (err == 0 && result->load_points > 0) {
+        relax_result relax;
+        memcpy(tokens, rebuilt, rebuilt_length * sizeof(token *));
+        *tokens_length = rebuilt_length;
+        err = relax_formats(tokens, rebuilt_length, inst_table, inst_table_length,
+                            symbol_table, symbol_table_length,
+                            literal_table, literal_table_length, &relax);
+        result->shortened = relax.shortened;
+        result->bytes_saved = before - instruction_bytes(tokens, rebuilt_length, inst_table, inst_table_length);
+    }
+
+    free(section_base);
+    free(rebuilt);
+
+    return err;
+}
+
+/**
+ * @brief [first, last) 범위의 섹션이 B 레지스터나 BASE 지시어를 직접 사용하는지 확인한다.
+ */
+static bool uses_base_register(token *tokens[], int first, int last,
+                               const inst *inst_table[], int inst_table_length) {
+    for (int i = first; i < last; i++) {
+        const char *operator = tokens[i]->operator;
+        if (operator == NULL) continue;
+
+        const char *mnemonic = operator[0] == '+' ? operator + 1 : operator;
+        if (strcmp(mnemonic, "LDB") == 0 || strcmp(mnemonic, "STB") == 0 ||
+            strcmp(mnemonic, "BASE") == 0 || strcmp(mnemonic, "NOBASE") == 0) {
+            return true;
+        }
+
+        int index = search_opcode(operator, inst_table, inst_table_length);
+        if (index != -1 && inst_table[index]->format == 2) {
+            for (int j = 0; j < MAX_OPERAND_PER_INST && tokens[i]->operand[j] != NULL; j++) {
+                if (strcmp(tokens[i]->operand[j], "B") == 0) {
+                    return true;
+                }
+            }
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief 섹션의 4형식 명령어 목표 주소를 가장 많이 덮는 베이스 심볼을 고른다.
+ * @return 베이스를 적용할 가치가 있으면 true (`base_symbol`에 심볼 이름 저장)
+ */
+static bool pick_section_base(token *tokens[], int first, int last,
+                              const inst *inst_table[], int inst_table_length,
+                              symbol *symbol_table[], int symbol_table_length,
+                              literal *literal_table[], int literal_table_length,
+                              char *base_symbol) {
+    const char *csect = tokens[first]->label;
+    int targets[MAX_INPUT_LINES];
+    int target_count = 0;
+    int load_points = 0;
+    int entry = -1;
+
+    for (int i = first + 1; i < last; i++) {
+        token *tok = tokens[i];
+        if (tok->operator == NULL) continue;
+
+        int index = search_opcode(tok->operator, inst_table, inst_table_length);
+        if (index == -1) {
+            // 섹션의 첫 명령어보다 앞에 데이터가 있으면 진입 위치를 알 수 없다
+            if (entry == -1 && (strcmp(tok->operator, "WORD") == 0 || strcmp(tok->operator, "BYTE") == 0 ||
+                                strcmp(tok->operator, "RESW") == 0 || strcmp(tok->operator, "RESB") == 0)) {
+                return false;
+            }
+            continue;
+        }
+        if (entry == -1) {
+            entry = i;
+            load_points++;
+        } else if (is_base_load_point(tokens, first, i)) {
+            load_points++;
+        }
+        if (strcmp(tok->operator[0] == '+' ? tok->operator + 1 : tok->operator, "JSUB") == 0) {
+            load_points++;
+        }
+
+        const char *operand = tok->operand[0];
+        if (tok->operator[0] != '+' || inst_table[index]->format != 3 || operand == NULL) continue;
+
+        if (operand[0] == '=') {
+            literal *lit = search_literal(literal_table, literal_table_length, operand, csect);
+            if (lit != NULL && lit->addr != -1) targets[target_count++] = lit->addr;
+        } else {
+            const char *name = (operand[0] == '#' || operand[0] == '@') ? operand + 1 : operand;
+            symbol *sym = search_symbol(symbol_table, symbol_table_length, name, csect);
+            if (sym != NULL) targets[target_count++] = sym->addr;
+        }
+    }
+
+    // 창의 시작이 될 수 있는 것은 심볼뿐이다
+    int best_count = 0;
+    for (int i = 0; i < symbol_table_length; i++) {
+        const symbol *sym = symbol_table[i];
+        if (strcmp(sym->csect, csect) != 0) continue;
+
+        int count = 0;
+        for (int j = 0; j < target_count; j++) {
+            if (targets[j] >= sym->addr && targets[j] - sym->addr <= 0xFFF) count++;
+        }
+        if (count > best_count) {
+            best_count = count;
+            strcpy(base_symbol, sym->name);
+        }
+    }
+
+    // 3형식이 되는 명령어마다 1바이트, LDB마다 3바이트
+    if (best_count <= load_points * 3) {
+        base_symbol[0] = '\0';
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief `index`번째 토큰이 다른 섹션에서 들어올 수 있는 위치(EXTDEF로 공개한 라벨)인지 확인한다.
+ */
+static bool is_base_load_point(token *tokens[], int first, int index) {
+    const char *label = tokens[index]->label;
+    if (label == NULL || label[0] == '\0') {
+        return false;
+    }
+
+    for (int i = first + 1; i < index; i++) {
+        if (tokens[i]->operator == NULL || strcmp(tokens[i]->operator, "EXTDEF") != 0) continue;
+        for (int j = 0; j < MAX_OPERAND_PER_INST && tokens[i]->operand[j] != NULL; j++) {
+            if (strcmp(tokens[i]->operand[j], label) == 0) {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief 어셈블러가 직접 추가하는 토큰 라인을 만든다.
+ */
+static token *make_token(const char *label, const char *operator, const char *operand,
+                         const inst *inst_table[], int inst_table_length) {
+    token *tok = (token *)malloc(sizeof(token));
+    if (tok == NULL) {
+        fprintf(stderr, "메모리 할당 실패\n");
+        return NULL;
+    }
+
+    init_token(tok);
+    tok->label = label != NULL ? strdup(label) : NULL;
+    tok->operator = strdup(operator);
+    tok->operand[0] = operand != NULL ? strdup(operand) : NULL;
+    if (tok->operator == NULL || (label != NULL && tok->label == NULL) ||
+        (operand != NULL && tok->operand[0] == NULL)) {
+        fprintf(stderr, "메모리 할당 실패\n");
+        return NULL;
+    }
+    tok->nixbpe = set_nixbpe(tok, inst_table, inst_table_length);
+
+    return tok;
+}
+
+/**
+ * @brief 패스 1에서 미뤄 둔 EQU 심볼의 값을 의존 관계 순서대로 계산한다.
+ *
+ * @param tokens 토큰 테이블의 시작 주소
+ * @param tokens_length 토큰 테이블의 길이
+ * @param symbol_table 심볼 테이블의 시작 주소
+ * @param symbol_table_length 심볼 테이블의 길이
+ * @return 오류 코드 (정상 종료 = 0)
+ *
+ * @details
+ * 값을 계산하지 않은 EQU 심볼을 노드로, 수식이 참조하는 다른 EQU 심볼을 간선으로
+ * 하는 의존 그래프를 만들고 진입 차수가 0인 노드부터 위상 순서로 평가한다. 각
+ * 심볼은 정확히 한 번 계산되며, 라벨은 패스 1에서 이미 주소가 정해졌으므로 EQU는
+ * 뒤에서 정의되는 심볼도 참조할 수 있다. 끝까지 계산되지 못한 노드가 남으면
+ * 순환 참조로 보고 실패한다.
+ */
+static int resolve_equates(token *tokens[], int tokens_length,
+                           symbol *symbol_table[], int symbol_table_length) {
+    int count = 0;
+    int edge_count = 0;
+    for (int i = 0; i < tokens_length; i++) {
+        if (tokens[i]->operator != NULL && strcmp(tokens[i]->operator, "EQU") == 0 && tokens[i]->expr != NULL) {
+            count++;
+            edge_count += tokens[i]->expr->length;
+        }
+    }
+    if (count == 0) {
+        return 0;
+    }
+
+    symbol **nodes = (symbol **)malloc(count * sizeof(symbol *));
+    const expression **exprs = (const expression **)malloc(count * sizeof(expression *));
+    int *indegree = (int *)calloc(count, sizeof(int));
+    int *edge_start = (int *)calloc(count + 1, sizeof(int));
+    int *edges = (int *)malloc(edge_count * sizeof(int));
+    int *queue = (int *)malloc(count * sizeof(int));
+    int err = 0;
+
+    if (nodes == NULL || exprs == NULL || indegree == NULL || edge_start == NULL ||
+        edges == NULL || queue == NULL) {
+        fprintf(stderr, "메모리 할당 실패\n");
+        err = -1;
+    } else {
+        // 계산할 EQU 심볼 수집 (섹션마다 라벨이 다시 쓰일 수 있으므로 섹션 이름으로 찾는다)
+        char current_csect[20] = "DEFAULT";
+        int node_count = 0;
+        for (int i = 0; i < tokens_length; i++) {
+            const token *tok = tokens[i];
+            if (tok->operator == NULL) continue;
+            if ((strcmp(tok->operator, "START") == 0 || strcmp(tok->operator, "CSECT") == 0) && tok->label != NULL) {
+                strcpy(current_csect, tok->label);
+            } else if (strcmp(tok->operator, "EQU") == 0 && tok->expr != NULL) {
+                symbol *sym = search_symbol(symbol_table, symbol_table_length, tok->label, current_csect);
+                if (sym != NULL && sym->pending) {
+                    nodes[node_count] = sym;
+                    exprs[node_count] = tok->expr;
+                    node_count++;
+                }
+            }
+        }
+
+        err = order_equates(nodes, exprs, node_count, symbol_table, symbol_table_length,
+                            indegree, edge_start, edges, queue);
+    }
+
+    free(nodes);
+    free(exprs);
+    free(indegree);
+    free(edge_start);
+    free(edges);
+    free(queue);
+
+    return err;
+}
+
+/**
+ * @brief resolve_equates의 본체. 간선은 의존 대상 노드별로 모은 배열(`edge_start`,
+ * `edges`)에 저장하고, `queue`에는 계산할 수 있게 된 노드를 넣는다.
+ */
+static int order_equates(symbol *nodes[], const expression *exprs[], int count,
+                         symbol *symbol_table[], int symbol_table_length,
+                         int indegree[], int edge_start[], int edges[], int queue[]) {
+    // 노드 u의 값이 노드 v의 수식에 쓰이면 u -> v 간선. 먼저 노드별 간선 수를 센다
+    for (int pass = 0; pass < 2; pass++) {
+        for (int v = 0; v < count; v++) {
+            for (int k = 0; k < exprs[v]->length; k++) {
+                const expr_item *item = &exprs[v]->items[k];
+                if (item->kind != EXPR_SYMBOL) continue;
+
+                symbol *sym = search_symbol(symbol_table, symbol_table_length, item->name, nodes[v]->csect);
+                int u = (sym != NULL && sym->pending) ? find_equate(nodes, count, sym) : -1;
+                if (u == -1) continue;
+
+                if (pass == 0) {
+                    edge_start[u + 1]++;
+                    indegree[v]++;
+                } else {
+                    edges[queue[u]++] = v;
+                }
+            }
+        }
+
+        if (pass == 0) {
+            for (int u = 0; u < count; u++) {
+                edge_start[u + 1] += edge_start[u];
+                queue[u] = edge_start[u]; // 두 번째 순회에서 간선을 채울 위치
+            }
+        }
+    }
+
+    // 진입 차수가 0인 노드부터 위상 순서로 계산
+    int head = 0;
+    int tail = 0;
+    for (int v = 0; v < count; v++) {
+        if (indegree[v] == 0) queue[tail++] = v;
+    }
+
+    while (head < tail) {
+        int v = queue[head++];
+        symbol *sym = nodes[v];
+        expr_value value;
+
+        // 미뤄 둔 심볼의 addr에는 '*'가 가리킬 EQU 라인의 LOCCTR가 들어 있다
+        if (evaluate_expression(exprs[v], (const symbol **)symbol_table, symbol_table_length,
+                                sym->csect, sym->addr, false, &value) < 0) {
+            fprintf(stderr, "EQU 심볼 %s의 값을 계산할 수 없습니다.\n", sym->name);
+            return -1;
+        }
+        if (value.relative != 0 && value.relative != 1) {
+            fprintf(stderr, "EQU 심볼 %s의 값은 절대값이나 섹션 상대 주소여야 합니다.\n", sym->name);
+            return -1;
+        }
+        sym->addr = value.value;
+        sym->absolute = value.relative == 0;
+        sym->pending = false;
+
+        for (int e = edge_start[v]; e < edge_start[v + 1]; e++) {
+            if (--indegree[edges[e]] == 0) queue[tail++] = edges[e];
+        }
+    }
+
+    if (tail < count) {
+        fprintf(stderr, "EQU 심볼 사이에 순환 참조가 있습니다:");
+        for (int v = 0; v < count; v++) {
+            if (nodes[v]->pending) fprintf(stderr, " %s", nodes[v]->name);
+        }
+        fprintf(stderr, "\n");
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief 계산할 EQU 심볼 목록에서 심볼의 위치를 찾는다.
+ * @return 노드 인덱스 (없으면 -1)
+ */
+static int find_equate(symbol *nodes[], int count, const symbol *sym) {
+    for (int i = 0; i < count; i++) {
+        if (nodes[i] == sym) return i;
+    }
+
+    return -1;
+}
+
+/**
+ * @brief 토큰 라인과 토큰이 가리키는 문자열을 모두 해제한다.
+ */
+static void free_token(token *tok) {
+    free(tok->label);
+    free(tok->operator);
+    for (int i = 0; i < MAX_OPERAND_PER_INST; i++) {
+        free(tok->operand[i]);
+    }
+    free(tok->comment);
+    free(tok->expr);
+    free(tok);
+}
+
+/**
+ * @brief 매크로 정의(MACRO ~ MEND)와 매크로 호출을 처리한다.
+ *
+ * @param table 매크로 처리 상태
+ * @param line 개행 문자를 제거한 원본 라인
+ * @param tok line을 파싱한 토큰. 처리한 경우 이 함수가 소유권을 가져간다.
+ * @param tokens 전개한 라인을 추가할 토큰 테이블
+ * @param tokens_length 토큰 테이블의 길이
+ * @return 처리한 경우 1, 일반 라인이면 0, 오류 시 음수
+ *
+ * @details
+ * 매크로 본문은 정의할 때 이미 토큰으로 나누어 두었으므로 호출할 때는 본문을 다시
+ * 파싱하지 않고 토큰을 복사하면서 매개변수만 바꾼다. 호출 라인의 라벨은 전개한
+ * 첫 라인의 라벨이 된다.
+ */
+static int process_macro_line(macro_table *table, const char *line, token *tok,
+                              token *tokens[], int *tokens_length) {
+    const char *operator = tok->operator;
+
+    if (table->defining != NULL) {
+        if (operator != NULL && strcmp(operator, "MEND") == 0) {
+            table->defining = NULL;
+            free_token(tok);
+            return 1;
+        }
+        if (operator != NULL && strcmp(operator, "MACRO") == 0) {
+            fprintf(stderr, "매크로 %s 안에서 다른 매크로를 정의할 수 없습니다.\n", table->defining->name);
+            free_token(tok);
+            return -1;
+        }
+        return add_macro_line(table->defining, tok, line);
+    }
+
+    if (operator == NULL) {
+        return 0;
+    }
+
+    if (strcmp(operator, "MEND") == 0) {
+        fprintf(stderr, "MACRO 없이 MEND가 나왔습니다.\n");
+        free_token(tok);
+        return -1;
+    }
+
+    char *arguments;
+    int err;
+    if (strcmp(operator, "MACRO") == 0) {
+        if (tok->label == NULL) {
+            fprintf(stderr, "MACRO에 매크로 이름(라벨)이 없습니다.\n");
+            free_token(tok);
+            return -1;
+        }
+        if ((arguments = operand_field(line)) == NULL) {
+            free_token(tok);
+            return -1;
+        }
+        err = define_macro(table, tok->label, arguments);
+        free(arguments);
+        free_token(tok);
+        return err < 0 ? err : 1;
+    }
+
+    const macro *mac = find_macro(table, operator);
+    if (mac == NULL) {
+        return 0;
+    }
+
+    if ((arguments = operand_field(line)) == NULL) {
+        free_token(tok);
+        return -1;
+    }
+    err = expand_macro(table, mac, tok->label, arguments, tokens, tokens_length, 0);
+    free(arguments);
+    free_token(tok);
+    return err < 0 ? err : 1;
+}
+
+/**
+ * @brief 새 매크로를 등록하고 MACRO 라인의 매개변수 목록을 해석한다.
+ *
+ * @details
+ * 매개변수는 "&NAME"(위치 매개변수) 또는 "&NAME=기본값"(키워드 매개변수) 형태이다.
+ * 이후 MEND까지의 라인은 이 매크로의 본문이 된다.
+ */
+static int define_macro(macro_table *table, const char *name, const char *params) {
+    if (strlen(name) >= sizeof(table->macros[0].name)) {
+        fprintf(stderr, "매크로 이름 %s이(가) 너무 깁니다.\n", name);
+        return -1;
+    }
+    if (find_macro(table, name) != NULL) {
+        fprintf(stderr, "매크로 %s이(가) 이미 정의되어 있습니다.\n", name);
+        return -1;
+    }
+
+    if (table->count == table->capacity) {
+        int capacity = table->capacity == 0 ? 16 : table->capacity * 2;
+        macro *macros = (macro *)realloc(table->macros, capacity * sizeof(macro));
+        if (macros == NULL) {
+            fprintf(stderr, "매크로 테이블 메모리 할당 실패\n");
+            return -1;
+        }
+        table->macros = macros;
+        table->capacity = capacity;
+    }
+
+    macro *mac = &table->macros[table->count++];
+    memset(mac, 0, sizeof(macro));
+    strcpy(mac->name, name);
+    table->defining = mac;
+    macro_stats.definitions++;
+
+    char *items[MAX_MACRO_PARAMS];
+    int count = split_arguments(params, items, MAX_MACRO_PARAMS);
+    if (count < 0) {
+        fprintf(stderr, "매크로 %s의 매개변수가 너무 많습니다. (최대 %d개)\n", name, MAX_MACRO_PARAMS);
+        return -1;
+    }
+
+    int err = 0;
+    for (int i = 0; i < count; i++) {
+        char *item = items[i];
+        char *equal = strchr(item, '=');
+        if (equal != NULL) *equal = '\0';
+
+        if (err == 0 && (item[0] != '&' || item[1] == '\0' || strlen(item + 1) >= sizeof(mac->params[0]))) {
+            fprintf(stderr, "매크로 %s의 매개변수 %s이(가) 올바르지 않습니다.\n", name, item);
+            err = -1;
+        }
+        if (err == 0) {
+            strcpy(mac->params[mac->param_count], item + 1);
+            if (equal != NULL && (mac->defaults[mac->param_count] = strdup(equal + 1)) == NULL) {
+                err = -1;
+            }
+            mac->param_count++;
+        }
+        free(item);
+    }
+
+    return err;
+}
+
+/**
+ * @brief 정의 중인 매크로의 본문에 라인을 추가한다.
+ *
+ * @details
+ * 토큰은 그대로 템플릿으로 옮기고, 필드마다 호출할 때 복사만 하면 되는지, 매개변수
+ * 하나로 통째로 바뀌는지, 문자열 치환이 필요한지를 미리 정해 둔다. 주석 라인은
+ * 전개 결과에 필요 없으므로 버린다.
+ */
+static int add_macro_line(macro *mac, token *tok, const char *line) {
+    if (tok->operator == NULL && tok->label == NULL) {
+        free_token(tok);
+        return 1;
+    }
+
+    if (mac->line_count == mac->line_capacity) {
+        int capacity = mac->line_capacity == 0 ? 8 : mac->line_capacity * 2;
+        macro_line *lines = (macro_line *)realloc(mac->lines, capacity * sizeof(macro_line));
+        if (lines == NULL) {
+            fprintf(stderr, "매크로 %s의 본문 메모리 할당 실패\n", mac->name);
+            free_token(tok);
+            return -1;
+        }
+        mac->lines = lines;
+        mac->line_capacity = capacity;
+    }
+
+    macro_line *entry = &mac->lines[mac->line_count];
+    if ((entry->arguments = operand_field(line)) == NULL) {
+        free_token(tok);
+        return -1;
+    }
+    entry->tok = *tok;
+    free(tok); // 문자열은 템플릿이 소유한다
+    mac->line_count++;
+
+    char *fields[2 + MAX_OPERAND_PER_INST] = { entry->tok.label, entry->tok.operator };
+    for (int i = 0; i < MAX_OPERAND_PER_INST; i++) {
+        fields[2 + i] = entry->tok.operand[i];
+    }
+
+    for (int f = 0; f < 2 + MAX_OPERAND_PER_INST; f++) {
+        entry->field[f] = MACRO_FIELD_COPY;
+        if (fields[f] == NULL || (strchr(fields[f], '&') == NULL && strchr(fields[f], '$') == NULL)) {
+            continue;
+        }
+
+        entry->field[f] = MACRO_FIELD_SCAN;
+        if (fields[f][0] != '&') continue;
+        for (int p = 0; p < mac->param_count; p++) {
+            if (strcmp(fields[f] + 1, mac->params[p]) == 0) {
+                entry->field[f] = p;
+                break;
+            }
+        }
+    }
+
+    return 1;
+}
+
+/**
+ * @brief 매크로 호출을 전개하여 토큰 테이블에 추가한다.
+ *
+ * @param table 매크로 처리 상태
+ * @param mac 호출한 매크로
+ * @param label 호출 라인의 라벨 (없으면 NULL)
+ * @param arguments 호출 라인의 피연산자 원문
+ * @param tokens 전개한 라인을 추가할 토큰 테이블
+ * @param tokens_length 토큰 테이블의 길이
+ * @param depth 매크로 안에서의 호출 깊이
+ * @return 성공 시 0, 오류 시 음수
+ */
+static int expand_macro(macro_table *table, const macro *mac, const char *label, const char *arguments,
+                        token *tokens[], int *tokens_length, int depth) {
+    if (depth >= MAX_MACRO_DEPTH) {
+        fprintf(stderr, "매크로 %s의 호출이 너무 깊습니다. (최대 %d단계)\n", mac->name, MAX_MACRO_DEPTH);
+        return -1;
+    }
+
+    char *items[MAX_MACRO_PARAMS];
+    int count = split_arguments(arguments, items, MAX_MACRO_PARAMS);
+    if (count < 0) {
+        fprintf(stderr, "매크로 %s의 인자가 너무 많습니다. (최대 %d개)\n", mac->name, MAX_MACRO_PARAMS);
+        return -1;
+    }
+
+    // 위치 인자를 먼저 채우고 키워드 인자로 덮어쓴다. 남은 매개변수는 기본값을 쓴다.
+    char *values[MAX_MACRO_PARAMS] = { NULL };
+    int position = 0;
+    int err = 0;
+    for (int i = 0; i < count && err == 0; i++) {
+        char *item = items[i];
+        char *equal = item[0] == '=' ? NULL : strchr(item, '=');
+        if (equal == NULL) {
+            while (position < mac->param_count && mac->defaults[position] != NULL) position++;
+            if (position == mac->param_count) {
+                fprintf(stderr, "매크로 %s의 위치 인자가 너무 많습니다.\n", mac->name);
+                err = -1;
+            } else {
+                values[position++] = item;
+            }
+            continue;
+        }
+
+        *equal = '\0';
+        const char *name = item[0] == '&' ? item + 1 : item;
+        int p = 0;
+        while (p < mac->param_count && strcmp(mac->params[p], name) != 0) p++;
+        if (p == mac->param_count) {
+            fprintf(stderr, "매크로 %s에 매개변수 %s이(가) 없습니다.\n", mac->name, name);
+            err = -1;
+        } else {
+            values[p] = equal + 1;
+        }
+    }
+    for (int p = 0; p < mac->param_count; p++) {
+        if (values[p] == NULL) values[p] = mac->defaults[p] != NULL ? mac->defaults[p] : "";
+    }
+
+    int expansion = table->expansions++;
+    int first = *tokens_length;
+    macro_stats.invocations++;
+
+    for (int i = 0; i < mac->line_count && err == 0; i++) {
+        const macro_line *line = &mac->lines[i];
+        const macro *inner = line->tok.operator != NULL ? find_macro(table, line->tok.operator) : NULL;
+
+        if (inner != NULL) {
+            char *inner_label = line->tok.label != NULL
+                ? substitute_macro_text(line->tok.label, mac, values, expansion) : NULL;
+            char *inner_arguments = substitute_macro_text(line->arguments, mac, values, expansion);
+            if (inner_arguments == NULL || (line->tok.label != NULL && inner_label == NULL)) {
+                err = -1;
+            } else {
+                err = expand_macro(table, inner, inner_label, inner_arguments, tokens, tokens_length, depth + 1);
+            }
+            free(inner_label);
+            free(inner_arguments);
+            continue;
+        }
+
+        if (*tokens_length == MAX_INPUT_LINES) {
+            fprintf(stderr, "토큰이 너무 많습니다. (최대 %d개)\n", MAX_INPUT_LINES);
+            err = -1;
+            break;
+        }
+
+        token *tok = instantiate_macro_line(mac, line, values, expansion);
+        if (tok == NULL) {
+            err = -1;
+            break;
+        }
+        tokens[(*tokens_length)++] = tok;
+        macro_stats.generated_lines++;
+    }
+
+    if (err == 0 && label != NULL) {
+        if (first == *tokens_length || tokens[first]->label != NULL) {
+            fprintf(stderr, "매크로 %s 호출의 라벨 %s을(를) 붙일 라인이 없습니다.\n", mac->name, label);
+            err = -1;
+        } else if ((tokens[first]->label = strdup(label)) == NULL) {
+            err = -1;
+        }
+    }
+
+    for (int i = 0; i < count; i++) {
+        free(items[i]);
+    }
+
+    return err;
+}
+
+/**
+ * @brief 매크로 본문 라인 하나로 새 토큰을 만든다.
+ * @return 만든 토큰 (오류 시 NULL)
+ */
+static token *instantiate_macro_line(const macro *mac, const macro_line *line,
+                                     char *values[], int expansion) {
+    token *tok = (token *)malloc(sizeof(token));
+    if (tok == NULL) return NULL;
+    init_token(tok);
+
+    const char *fields[2 + MAX_OPERAND_PER_INST] = { line->tok.label, line->tok.operator };
+    char **targets[2 + MAX_OPERAND_PER_INST] = { &tok->label, &tok->operator };
+    for (int i = 0; i < MAX_OPERAND_PER_INST; i++) {
+        fields[2 + i] = line->tok.operand[i];
+        targets[2 + i] = &tok->operand[i];
+    }
+
+    for (int f = 0; f < 2 + MAX_OPERAND_PER_INST; f++) {
+        const char *text = fields[f];
+        if (text == NULL) continue;
+
+        if (line->field[f] >= 0) {
+            text = values[(int)line->field[f]];
+            if (text[0] == '\0') continue; // 생략한 인자는 필드를 비운다
+            *targets[f] = strdup(text);
+        } else if (line->field[f] == MACRO_FIELD_COPY) {
+            *targets[f] = strdup(text);
+        } else {
+            *targets[f] = substitute_macro_text(text, mac, values, expansion);
+        }
+
+        if (*targets[f] == NULL) {
+            free_token(tok);
+            return NULL;
+        }
+    }
+
+    if (tok->label != NULL && strlen(tok->label) >= sizeof(((symbol *)0)->name)) {
+        fprintf(stderr, "매크로 %s을(를) 전개한 라벨 %s이(가) 너무 깁니다.\n", mac->name, tok->label);
+        free_token(tok);
+        return NULL;
+    }
+
+    return tok;
+}
+
+/**
+ * @brief 문자열 안의 &매개변수를 인자 값으로, $라벨을 전개마다 다른 라벨로 바꾼다.
+ *
+ * @details
+ * "$LOOP"는 "$AALOOP", "$ABLOOP"처럼 '$' 뒤에 전개 번호를 나타내는 두 글자를 붙여
+ * 같은 매크로를 여러 번 호출해도 라벨이 겹치지 않게 한다. 매개변수 이름은 가장 긴
+ * 것부터 일치하는지 확인한다.
+ *
+ * @return 새로 할당한 문자열 (오류 시 NULL)
+ */
+static char *substitute_macro_text(const char *text, const macro *mac, char *values[], int expansion) {
+    size_t longest = 8;
+    for (int p = 0; p < mac->param_count; p++) {
+        if (strlen(values[p]) > longest) longest = strlen(values[p]);
+    }
+
+    size_t capacity = strlen(text) * (longest + 1) + 1;
+    char *result = (char *)malloc(capacity);
+    if (result == NULL) return NULL;
+
+    size_t length = 0;
+    for (const char *c = text; *c != '\0';) {
+        if (*c == '&') {
+            int match = -1;
+            size_t match_length = 0;
+            for (int p = 0; p < mac->param_count; p++) {
+                size_t name_length = strlen(mac->params[p]);
+                if (name_length > match_length && strncmp(c + 1, mac->params[p], name_length) == 0) {
+                    match = p;
+                    match_length = name_length;
+                }
+            }
+            if (match >= 0) {
+                strcpy(result + length, values[match]);
+                length += strlen(values[match]);
+                c += 1 + match_length;
+                continue;
+            }
+        } else if (*c == '$' && isalpha((unsigned char)c[1])) {
+            // 전개 번호를 두 글자 이상의 26진수로 쓴다 (AA, AB, ..., ZZ, BAA, ...)
+            char digits[8];
+            int digit_count = 0;
+            for (int n = expansion; n > 0 || digit_count < 2; n /= 26) {
+                digits[digit_count++] = 'A' + n % 26;
+            }
+            result[length++] = '$';
+            while (digit_count > 0) result[length++] = digits[--digit_count];
+            c++;
+            continue;
+        }
+
+        result[length++] = *c++;
+    }
+    result[length] = '\0';
+
+    return result;
+}
+
+/**
+ * @brief 이름으로 매크로를 찾는다.
+ * @return 매크로 (없으면 NULL)
+ */
+static macro *find_macro(const macro_table *table, const char *name) {
+    for (int i = 0; i < table->count; i++) {
+        if (strcmp(table->macros[i].name, name) == 0) {
+            return &table->macros[i];
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief 쉼표로 구분한 인자 목록을 나눈다. 따옴표 안의 쉼표는 구분자로 보지 않는다.
+ *
+ * @param text 인자 목록 원문
+ * @param items 나눈 인자 (각각 새로 할당한 문자열)
+ * @param max_items items의 크기
+ * @return 인자 수 (max_items보다 많거나 메모리가 부족하면 -1)
+ */
+static int split_arguments(const char *text, char *items[], int max_items) {
+    int count = 0;
+    const char *st = text;
+
+    while (*st != '\0') {
+        while (*st == ' ') st++;
+
+        const char *end = st;
+        bool quoted = false;
+        for (; *end != '\0' && (quoted || *end != ','); end++) {
+            if (*end == '\'') quoted = !quoted;
+        }
+
+        const char *last = end;
+        while (last > st && last[-1] == ' ') last--;
+
+        if (count == max_items || (items[count] = (char *)malloc(last - st + 1)) == NULL) {
+            for (int i = 0; i < count; i++) free(items[i]);
+            return -1;
+        }
+        memcpy(items[count], st, last - st);
+        items[count][last - st] = '\0';
+        count++;
+
+        if (*end == '\0') break;
+        st = end + 1;
+    }
+
+    return count;
+}
+
+/**
+ * @brief 라인의 세 번째 필드(피연산자 원문)를 복사한다.
+ * @return 새로 할당한 문자열 (필드가 없으면 빈 문자열, 메모리 부족 시 NULL)
+ */
+static char *operand_field(const char *line) {
+    const char *st = line;
+    for (int field = 0; field < 2 && *st != '\0'; field++) {
+        st = strchr(st, '\t');
+        if (st == NULL) return strdup("");
+        st++;
+    }
+
+    size_t length = strcspn(st, "\t");
+    char *field = (char *)malloc(length + 1);
+    if (field == NULL) return NULL;
+    memcpy(field, st, length);
+    field[length] = '\0';
+
+    return field;
+}
+
+/**
+ * @brief 매크로 테이블과 본문 템플릿을 모두 해제한다.
+ */
+static void free_macros(macro_table *table) {
+    for (int i = 0; i < table->count; i++) {
+        macro *mac = &table->macros[i];
+        for (int p = 0; p < mac->param_count; p++) {
+            free(mac->defaults[p]);
+        }
+        for (int l = 0; l < mac->line_count; l++) {
+            macro_line *line = &mac->lines[l];
+            free(line->tok.label);
+            free(line->tok.operator);
+            for (int o = 0; o < MAX_OPERAND_PER_INST; o++) {
+                free(line->tok.operand[o]);
+            }
+            free(line->tok.comment);
+            free(line->tok.expr);
+            free(line->arguments);
+        }
+        free(mac->lines);
+    }
+    free(table->macros);
+    table->macros = NULL;
+    table->count = table->capacity = 0;
+}
+
+/**
+ * @brief 심볼 테이블과 리터럴 테이블을 비우고 토큰의 LOCCTR를 처음부터 다시 계산한다.
+ * `addresses`에는 각 토큰 라인의 시작 주소를 저장한다.
+ */
+static int assign_addresses(token *tokens[], int tokens_length,
+                            const inst *inst_table[], int inst_table_length,
+                            symbol *symbol_table[], int *symbol_table_length,
+                            literal *literal_table[], int *literal_table_length, int addresses[]) {
+    int locctr = 0;
+    char current_csect[20] = "DEFAULT";
+
+    for (int i = 0; i < *symbol_table_length; i++) {
+        free(symbol_table[i]);
+    }
+    for (int i = 0; i < *literal_table_length; i++) {
+        free(literal_table[i]);
+    }
+    *symbol_table_length = 0;
+    *literal_table_length = 0;
+
+    for (int i = 0; i < tokens_length; i++) {
+        addresses[i] = locctr;
+        locctr = process_token(tokens[i], inst_table, inst_table_length,
+                               symbol_table, symbol_table_length,
+                               literal_table, literal_table_length, locctr, current_csect);
+        if (locctr < 0) {
+            return -1;
+        }
+    }
+
+    return resolve_equates(tokens, tokens_length, symbol_table, *symbol_table_length);
+}
+
+/**
+ * @brief BASE 지시어의 피연산자(심볼 또는 '*')가 가리키는 주소를 구한다.
+ * @return 베이스 주소 (심볼을 찾지 못하면 -1)
+ */
+static int base_address(const token *tok, const symbol *symbol_table[], int symbol_table_length,
+                        const char *current_csect, int locctr) {
+    const char *operand = tok->operand[0];
+    if (operand != NULL && strcmp(operand, "*") == 0) {
+        return locctr;
+    }
+
+    symbol *sym = operand == NULL ? NULL :
+        search_symbol((symbol **)symbol_table, symbol_table_length, operand, current_csect);
+    if (sym == NULL) {
+        fprintf(stderr, "BASE 지시어의 심볼 %s을(를) 찾을 수 없습니다.\n",
+                operand == NULL ? "(없음)" : operand);
+        return -1;
+    }
+
+    return sym->addr;
+}
+
+/**
+ * @brief 명령어를 4형식(extended = true) 또는 3형식으로 바꾸고 nixbpe를 다시 설정한다.
+ */
+static int set_instruction_format(token *tok, bool extended,
+                                  const inst *inst_table[], int inst_table_length) {
+    const char *mnemonic = tok->operator[0] == '+' ? tok->operator + 1 : tok->operator;
+    if ((tok->operator[0] == '+') == extended) {
+        return 0;
+    }
+
+    char *operator = (char *)malloc(strlen(mnemonic) + 2);
+    if (operator == NULL) {
+        fprintf(stderr, "메모리 할당 실패\n");
+        return -1;
+    }
+    sprintf(operator, "%s%s", extended ? "+" : "", mnemonic);
+
+    free(tok->operator);
+    tok->operator = operator;
+    tok->nixbpe = set_nixbpe(tok, inst_table, inst_table_length);
+
+    return 0;
+}
+
+/**
+ * @brief 3/4형식 명령어가 차지하는 바이트 수의 합을 구한다.
+ */
+static int instruction_bytes(token *tokens[], int tokens_length,
+                             const inst *inst_table[], int inst_table_length) {
+    int bytes = 0;
+    for (int i = 0; i < tokens_length; i++) {
+        const char *operator = tokens[i]->operator;
+        if (operator == NULL) continue;
+
+        int index = search_opcode(operator, inst_table, inst_table_length);
+        if (index != -1 && inst_table[index]->format == 3) {
+            bytes += operator[0] == '+' ? 4 : 3;
+        }
+    }
+
+    return bytes;
+}
+
+
+/**
+ * @brief 한 줄의 소스코드를 파싱하여 토큰에 저장한다.
+ *
+ * @param input 파싱할 소스코드 문자열
+ * @param tok 결과를 저장할 토큰 구조체 주소
+ * @param inst_table 기계어 목록 테이블의 주소
+ * @param inst_table_length 기계어 목록 테이블의 길이
+ * @return 오류 코드 (정상 종료 = 0)
+ */
+int token_parsing(const char *input, token *tok, const inst *inst_table[], int inst_table_length) 
+{
+    /* add your code */
+    int input_length = strlen(input);
+
+    tok->label = NULL;
+    tok->operator= NULL;
+    tok->operand[0] = NULL;
+    tok->operand[1] = NULL;
+    tok->operand[2] = NULL;
+    tok->comment = NULL;
+
+    if (input[0] == '.') {
+        if ((tok->comment = (char *)malloc(input_length + 1)) == NULL)
+            return -1;
+        sscanf(input + 1, " %[^\0]", tok->comment);
+        tok->comment[input_length] = '\0';
+    } else {
+        int token_cnt = 0;
+        for (int st = 0; st < input_length && token_cnt < 3; ++st) {
+            int end = st;
+            for (; input[end] != '\t' && input[end] != '\0'; ++end)
+                ;
+
+            switch (token_cnt) {
+                case 0:
+                    if (st < end) {
+                        if ((tok->label = (char *)malloc(end - st + 1)) == NULL)
+                            return -1;
+                        memcpy(tok->label, input + st, end - st);
+                        tok->label[end - st] = '\0';
+                    }
+                    break;
+
+                case 1:
+                    if (st < end) {
+                        if ((tok->operator=(char *) malloc(end - st + 1)) ==
+                            NULL)
+                            return -1;
+                        memcpy(tok->operator, input + st, end - st);
+                        tok->operator[end - st] = '\0';
+                    }
+                    break;
+
+                case 2:
+                    if (st < end) {
+                        int err;
+                        if ((err = token_operand_parsing(input + st, end - st,
+                                                         tok->operand)) != 0)
+                            return err;
+                    }
+
+                    st = end + 1;
+                    end = input_length;
+                    if (st < end) {
+                        if ((tok->comment = (char *)malloc(end - st + 1)) ==
+                            NULL)
+                            return -1;
+                        memcpy(tok->comment, input + st, end - st);
+                        tok->comment[end - st] = '\0';
+                    }
+            }
+
+            ++token_cnt;
+            st = end;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief 피연산자 문자열을 파싱하여 operand에 저장함. 문자열은 \0으로 끝나지
+ * 않을 수 있기에, operand_input_length로 문자열의 길이를 전달해야 함.
+ */
+static int token_operand_parsing(const char *operand_input,
+                                 int operand_input_length, char *operand[]) {
+    int operand_cnt = 0;
+    int st = 0;
+    while (st < operand_input_length && operand_cnt < 3) {
+        while (st < operand_input_length && (operand_input[st] == ' ' || operand_input[st] == '\t' || operand_input[st] == '\n')) {
+            st++;  // 시작 지점에서 화이트스페이스 및 개행문자 건너뛰기
+        }
+
+        int end = st;
+        for (; end < operand_input_length && operand_input[end] != ',' && operand_input[end] != '\t' && 
+               operand_input[end] != '\0' && operand_input[end] != '\n'; ++end)
+            ;
+
+        if (end > st) {  // 유효한 피연산자가 있는 경우에만 메모리 할당
+            operand[operand_cnt] = (char *)malloc(end - st + 1);
+            if (operand[operand_cnt] == NULL) {
+                return -1;  // 메모리 할당 실패
+            }
+            memcpy(operand[operand_cnt], operand_input + st, end - st);
+            operand[operand_cnt][end - st] = '\0';  // 피연산자 끝에 널 문자 추가
+            ++operand_cnt;
+        }
+
+        st = end + 1;  // 쉼표 다음 위치로 시작 지점 업데이트
+    }
+
+    return 0;
+}
+
+/**
+ * @brief 토큰 라인 별로 nixbpe 비트를 설정한다. 
+*/
+static int set_nixbpe(token *tok, const inst *inst_table[], int inst_table_length) {
+    const char *operand = tok->operand[0];
+    const char *operator = tok->operator;
+    if (operator == NULL) {
+        return 0;
+    }
+    int format = 0;
+    int index = search_opcode(operator, inst_table, inst_table_length);
+    if (index != -1) {
+        if (operator[0] == '+') {
+            format = 4;
+        } else {
+            format = inst_table[index]->format;
+        }
+    }
+
+    int nixbpe = 0;
+
+    if (strcmp(operator, "RSUB") == 0) {
+        nixbpe = 0x30; // n=1, i=1
+    } else if (operand == NULL) {
+        ;
+    } else {
+        // Immediate addressing 
+        if (operand[0] == '#') {
+            nixbpe = 0x10; // n=0, i=1
+            if (format == 4) {
+                nixbpe |= 0x01; // e=1
+            } else if (isalpha(operand[1])) {
+                // 문자일 경우 PC-relative 
+                nixbpe |= 0x02;
+            }
+        }   
+        // Indirect addressing
+        else if (operand[0] == '@') {
+            nixbpe = 0x20; // n=1, i=0
+            if (format == 4) {
+                nixbpe |= 0x01; // e=1
+            } else if (isalpha(operand[1])) {
+                // 문자일 경우 PC-relative 
+                nixbpe |= 0x02;
+            }
+        }
+        // Simple or Direct addrssing
+        else {
+            if (format == 4) {
+                nixbpe = 0x31; // n=1, i=1, e=1
+            } else {
+                nixbpe = 0x32; // n=1, i=1, p=1
+            }
+        }
+
+        // Indexed addressing
+        const char* operand_2 = tok->operand[1];
+        if (operand_2 != NULL && strcmp(operand_2, "X") == 0) {
+            nixbpe |= 0x08; // x=1
+        }
+    }
+
+    return nixbpe;
+}
+
+/**
+ * @brief 토큰 라인을 읽어 심볼 테이블 및 리터럴 테이블을 생성한다. 
+ * @return 다음 토큰 라인의 LOCCTR 
+*/
+static int process_token(const token *tok, const inst *inst_table[], int inst_table_length,
+                        symbol **symbol_table, int *num_symbols, 
+                        literal **literal_table, int *num_literals, int locctr, char *current_csect) {
+    const char *label = tok->label;
+    const char *operator = tok->operator;
+    const char *operand = tok->operand[0];
+    if (operator == NULL) { return locctr;}
+    int next_locctr = locctr;
+    bool pending = false; // EQU로 정의하여 값을 나중에 계산할 심볼인지 여부
+
+    // LOCCTR 계산
+    if (operator != NULL) {
+        if (tok->nixbpe & 0x01) {
+            // 4형식 명령어인 경우
+            locctr += 4;
+        } else {
+            // 2, 3형식 명령어인 경우
+            int index = search_opcode(operator, inst_table, inst_table_length);
+            if (index != -1) {
+                locctr += inst_table[index]->format;
+            } else {
+                // 지시어 처리 
+                if (strcmp(operator, "START") == 0) {
+                    locctr = atoi(operand);
+                    strcpy(current_csect, label); // 새로운 컨트롤 섹션 이름 설정
+                } else if (strcmp(operator, "CSECT") == 0) {
+                    locctr = 0;
+                    next_locctr = 0;
+                    strcpy(current_csect, label); // 새로운 컨트롤 섹션 이름 설정
+                } else if (strcmp(operator, "EXTDEF") == 0 || strcmp(operator, "EXTREF") == 0) {
+                    ;
+                } else if (strcmp(operator, "RESB") == 0) {
+                    locctr += atoi(operand);
+                } else if (strcmp(operator, "RESW") == 0) {
+                    locctr += 3 * atoi(operand);
+                } else if (strcmp(operator, "BYTE") == 0) {
+                    int operand_length = strlen(operand);
+                    if (operand[0] == 'X') { 
+                        // 두 글자당 한 바이트를 할당
+                        locctr += (operand_length - 3) / 2;
+                    } else if (operand[0] == 'C') {
+                        // 한 글자당 한 바이트를 할당
+                        locctr += operand_length - 3;
+                    }
+                } else if (strcmp(operator, "WORD") == 0) {
+                    locctr += 3;
+                } else if (strcmp(operator, "LTORG") == 0 || strcmp(operator, "END") == 0) {
+                    // 패스 2에서 다시 계산하는 경우: 이미 이 위치에 배치된 리터럴 풀을 건너뛴다
+                    bool advanced = true;
+                    while (advanced) {
+                        advanced = false;
+                        for (int k = 0; k < *num_literals; k++) {
+                            if (literal_table[k]->addr == locctr &&
+                                strcmp(literal_table[k]->csect, current_csect) == 0) {
+                                locctr += literal_length(literal_table[k]->literal);
+                                advanced = true;
+                            }
+                        }
+                    }
+
+                    // 주소가 할당되지 않은 이 섹션의 리터럴을 모두 리터럴 풀에 배치
+                    for (int k = 0; k < *num_literals; k++) {
+                        if (literal_table[k]->addr == -1 &&
+                            strcmp(literal_table[k]->csect, current_csect) == 0) {
+                            literal_table[k]->addr = locctr;
+                            locctr += literal_length(literal_table[k]->literal);
+                        }
+                    }
+                } else if (strcmp(operator, "EQU") == 0) {
+                    // 값은 패스 1이 끝난 뒤 resolve_equates가 의존 순서대로 계산한다
+                    if (tok->expr == NULL || label == NULL) {
+                        fprintf(stderr, "EQU에는 라벨과 피연산자가 필요합니다.\n");
+                        return -1;
+                    }
+                    pending = true;
+                }
+            }
+        }
+    }
+
+    // 라벨이 있는 경우 -> 심볼 테이블에 추가
+    if (label != NULL && label[0] != '\0') { 
+        add_symbol(symbol_table, num_symbols, label, next_locctr, current_csect);
+        symbol_table[*num_symbols - 1]->pending = pending;
+    }
+
+    // 피연산자가 리터럴인 경우 -> 리터럴 테이블에 추가
+    if (operand != NULL && operand[0] == '=') {
+        add_literal(literal_table, num_literals, operand, -1, current_csect); // 리터럴의 주소 초기값: -1
+    }
+
+    return locctr;
+}
+
+/**
+ * @brief 심볼 테이블을 생성한다.
+*/
+void add_symbol(symbol **symbol_table, int *num_symbols, const char *label, int locctr, const char *csect) {
+    // 심볼 객체에 메모리 할당
+    symbol_table[*num_symbols] = (symbol*)malloc(sizeof(symbol));
+    if (symbol_table[*num_symbols] == NULL) {
+        fprintf(stderr, "메모리 할당 실패.\n");
+        return;
+    }
+
+    // 심볼 이름, 주소, 컨트롤 섹션 이름 할당
+    strcpy(symbol_table[*num_symbols]->name, label);
+    symbol_table[*num_symbols]->addr = locctr;
+    strcpy(symbol_table[*num_symbols]->csect, csect);
+    symbol_table[*num_symbols]->absolute = false;
+    symbol_table[*num_symbols]->pending = false;
+    (*num_symbols)++;
+}
+
+/**
+ * @brief 리터럴 테이블을 생성한다.
+*/
+void add_literal(literal **literal_table, int *num_literals, const char *operand, int locctr,
+                 const char *csect) {
+    // 같은 섹션에 중복된 리터럴인지 확인 
+    if (*num_literals) {
+        for (int i = 0; i < *num_literals; i++) {
+            const char *literal = literal_table[i]->literal;
+            if (strcmp(literal, operand) == 0 && strcmp(literal_table[i]->csect, csect) == 0) {
+                return;
+            }
+        }
+    }
+    
+    // 리터럴 객체에 메모리 할당
+    literal_table[*num_literals] = (literal*)malloc(sizeof(literal));
+    if (literal_table[*num_literals] == NULL) {
+        fprintf(stderr, "메모리 할당 실패.\n");
+        return;
+    }
+
+    // 리터럴 이름과 주소 할당
+    strcpy(literal_table[*num_literals]->literal, operand);
+    literal_table[*num_literals]->addr = locctr;
+    literal_table[*num_literals]->isProcessed = false;
+    strcpy(literal_table[*num_literals]->csect, csect);
+    (*num_literals)++;
+}
+
+/**
+ * @brief 기계어 목록 테이블에서 특정 기계어를 검색하여, 해당 기계어가 위치한
+ * 인덱스를 반환한다.
+ *
+ * @param str 검색할 기계어 문자열
+ * @param inst_table 기계어 목록 테이블 주소
+ * @param inst_table_length 기계어 목록 테이블의 길이
+ * @return 기계어의 인덱스 (해당 기계어가 없는 경우 -1)
+ *
+ * @details
+ * 기계어 목록 테이블에서 특정 기계어를 검색하여, 해당 기계어가 위치한 인덱스를
+ * 반환한다. '+JSUB'와 같은 문자열에 대한 처리는 자유롭게 처리한다.
+ */
+int search_opcode(const char *str, const inst *inst_table[],
+                  int inst_table_length) {
+    /* add your code */
+    if (str == NULL) {
+        fprintf(stderr, "입력된 문자열이 NULL을 가리킵니다.\n");
+        return -1;
+    }
+     
+    // 입력된 기계어 코드와 기계어 테이블을 비교하여 인덱스를 찾는다.
+    if (str[0] == '+') 
+        return search_opcode(str + 1, inst_table, inst_table_length);
+    COUNT_LOOKUP(opcode_lookups);
+    
+    for (int i=0; i < inst_table_length; ++i) {
+        if (strcmp(str, inst_table[i]->str) == 0) 
+            return i;
+    }
+
+    // 기계어 코드를 찾지 못한 경우
+    return -1;
+}
+
+/**
+ * @brief 심볼 테이블에서 주어진 이름과 컨트롤 섹션의 심볼을 검색한다.
+ * @return 찾은 심볼의 포인터, 찾지 못하면 NULL 반환
+ */
+symbol* search_symbol(symbol** symbol_table, int num_symbols, const char* name, const char* csect) {
+    COUNT_LOOKUP(symbol_lookups);
+    for (int i = 0; i < num_symbols; i++) {
+        if (symbol_table[i] == NULL) continue;
+        if (symbol_table[i]->name[0] == '\0' || symbol_table[i]->csect[0] == '\0') continue;
+        if (strcmp(symbol_table[i]->name, name) == 0 && strcmp(symbol_table[i]->csect, csect) == 0) {
+            return symbol_table[i];  // 찾은 심볼의 포인터 반환
+        }
+    }
+    return NULL;  // 찾지 못하면 NULL 반환
+}
+
+/**
+ * @brief 리터럴 테이블에서 주어진 이름의 리터럴을 검색한다.
+ * @return 찾은 리터럴의 포인터, 찾지 못하면 NULL 반환
+ */
+literal* search_literal(literal** literal_table, int num_literals, const char* name, const char* csect) {
+    COUNT_LOOKUP(literal_lookups);
+    for (int i = 0; i < num_literals; i++) {
+        if (strcmp(literal_table[i]->literal, name) == 0 && strcmp(literal_table[i]->csect, csect) == 0) {
+            return literal_table[i]; // 찾은 리터럴의 포인터 반환
+        }
+    }
+
+    return NULL; // 찾지 못하면 NULL 반환 
+}
+
+/**
+ * @brief EQU/WORD 피연산자를 후위 표기식으로 컴파일한다.
+ *
+ * @param operand 컴파일할 피연산자 문자열
+ * @return 컴파일한 수식 (해석할 수 없으면 NULL)
+ *
+ * @details
+ * 10진 상수, 심볼, '*'(현재 LOCCTR)와 이항 연산자 `+ - * /`, 단항 `-`, 괄호를
+ * 지원한다. '*'는 항이 올 자리에서는 LOCCTR, 연산자가 올 자리에서는 곱셈이다.
+ * 연산자 스택으로 우선순위를 처리하여(shunting-yard) 항목 배열에 후위 표기식으로
+ * 저장한다.
+ */
+expression *compile_expression(const char *operand) {
+    expression *expr = (expression *)calloc(1, sizeof(expression));
+    char stack[MAX_EXPRESSION_ITEMS]; // 연산자 스택 ('(' 포함)
+    int top = 0;
+    bool expect_term = true; // 다음에 항, 단항 연산자 또는 '('가 와야 하는지 여부
+    bool ok = true;
+
+    if (expr == NULL) {
+        fprintf(stderr, "메모리 할당 실패\n");
+        return NULL;
+    }
+
+    for (const char *p = operand; ok && *p != '\0';) {
+        char c = *p;
+        if (c == ' ') {
+            p++;
+        } else if (expect_term && isdigit((unsigned char)c)) {
+            char *end;
+            int value = (int)strtol(p, &end, 10);
+            ok = push_expr_item(expr, EXPR_NUMBER, value, NULL, 0);
+            p = end;
+            expect_term = false;
+        } else if (expect_term && (isalpha((unsigned char)c) || c == '_')) {
+            int length = 0;
+            while (isalnum((unsigned char)p[length]) || p[length] == '_') length++;
+            ok = length < (int)sizeof(expr->items[0].name) &&
+                 push_expr_item(expr, EXPR_SYMBOL, 0, p, length);
+            p += length;
+            expect_term = false;
+        } else if (expect_term && c == '*') {
+            ok = push_expr_item(expr, EXPR_LOCCTR, 0, NULL, 0);
+            p++;
+            expect_term = false;
+        } else if (expect_term && (c == '(' || c == '-')) {
+            ok = top < MAX_EXPRESSION_ITEMS;
+            if (ok) stack[top++] = (c == '-') ? EXPR_NEGATE : '(';
+            p++;
+        } else if (expect_term && c == '+') {
+            p++; // 단항 '+'는 무시한다
+        } else if (!expect_term && c == ')') {
+            while (top > 0 && stack[top - 1] != '(' && ok) {
+                ok = push_expr_item(expr, stack[--top], 0, NULL, 0);
+            }
+            ok = ok && top > 0;
+            top--;
+            p++;
+        } else if (!expect_term && strchr("+-*/", c) != NULL) {
+            while (ok && top > 0 && stack[top - 1] != '(' &&
+                   operator_precedence(stack[top - 1]) >= operator_precedence(c)) {
+                ok = push_expr_item(expr, stack[--top], 0, NULL, 0);
+            }
+            ok = ok && top < MAX_EXPRESSION_ITEMS;
+            if (ok) stack[top++] = c;
+            p++;
+            expect_term = true;
+        } else {
+            ok = false;
+        }
+    }
+
+    // 연산자로 끝나거나 닫히지 않은 괄호가 남으면 잘못된 수식이다
+    ok = ok && !expect_term;
+    while (ok && top > 0) {
+        ok = stack[top - 1] != '(' && push_expr_item(expr, stack[top - 1], 0, NULL, 0);
+        top--;
+    }
+
+    if (!ok) {
+        fprintf(stderr, "수식 %s을(를) 해석할 수 없습니다.\n", operand);
+        free(expr);
+        return NULL;
+    }
+
+    return expr;
+}
+
+/**
+ * @brief 후위 표기식의 끝에 항목 하나를 추가한다.
+ * @return 추가했으면 true, 수식이 너무 길면 false
+ */
+static bool push_expr_item(expression *expr, char kind, int value, const char *name, int name_length) {
+    if (expr->length == MAX_EXPRESSION_ITEMS) {
+        return false;
+    }
+
+    expr_item *item = &expr->items[expr->length++];
+    item->kind = kind;
+    item->value = value;
+    if (name != NULL) {
+        memcpy(item->name, name, name_length);
+        item->name[name_length] = '\0';
+    }
+
+    return true;
+}
+
+/**
+ * @brief 연산자 스택에서 사용하는 연산자의 우선순위를 구한다.
+ */
+static int operator_precedence(char op) {
+    if (op == EXPR_NEGATE) return 3;
+    if (op == '*' || op == '/') return 2;
+    return 1;
+}
+
+/**
+ * @brief 컴파일한 수식을 평가하고 각 항을 절대/상대/외부 참조로 분류한다.
+ *
+ * @param expr 평가할 수식
+ * @param symbol_table 심볼 테이블의 시작 주소
+ * @param symbol_table_length 심볼 테이블의 길이
+ * @param current_csect 현재 컨트롤 섹션 이름
+ * @param locctr '*'가 가리키는 현재 LOCCTR
+ * @param allow_external 섹션에 없는 심볼을 외부 참조로 볼지 여부 (false면 오류)
+ * @param result 평가 결과를 저장할 구조체 주소
+ * @return 오류 코드 (정상 종료 = 0)
+ *
+ * @details
+ * 같은 섹션의 심볼은 EQU로 정의한 절대값이 아니면 섹션 상대 항이다. 상대 항은
+ * 부호 합으로 세고, 외부 참조 항은 값을 0으로 두고 부호를 기록한다. 뺄셈과
+ * 단항 '-'는 오른쪽 부분식에 속한 외부 참조 항의 부호를 뒤집는다. 부분식은
+ * 후위 표기식에서 연속된 구간이므로 스택마다 시작 위치만 기억하면 된다. 곱셈과
+ * 나눗셈에는 절대값 항만 사용할 수 있다.
+ */
+int evaluate_expression(const expression *expr, const symbol *symbol_table[],
+                        int symbol_table_length, const char *current_csect,
+                        int locctr, bool allow_external, expr_value *result) {
+    int value[MAX_EXPRESSION_ITEMS];
+    int relative[MAX_EXPRESSION_ITEMS];
+    int external[MAX_EXPRESSION_ITEMS];
+    int first[MAX_EXPRESSION_ITEMS]; // 부분식이 시작하는 항목의 위치
+    int top = 0;
+
+    memset(result, 0, sizeof(expr_value));
+    for (int i = 0; i < expr->length; i++) {
+        const expr_item *item = &expr->items[i];
+
+        if (item->kind == EXPR_NUMBER || item->kind == EXPR_SYMBOL || item->kind == EXPR_LOCCTR) {
+            value[top] = item->kind == EXPR_NUMBER ? item->value : locctr;
+            relative[top] = item->kind == EXPR_LOCCTR ? 1 : 0;
+            external[top] = 0;
+            first[top] = i;
+
+            if (item->kind == EXPR_SYMBOL) {
+                symbol *sym = search_symbol((symbol **)symbol_table, symbol_table_length,
+                                            item->name, current_csect);
+                if (sym != NULL) {
+                    value[top] = sym->addr;
+                    relative[top] = sym->absolute ? 0 : 1;
+                } else if (allow_external) {
+                    value[top] = 0;
+                    external[top] = 1;
+                    result->external_sign[i] = 1;
+                } else {
+                    fprintf(stderr, "심볼 %s을(를) 찾을 수 없습니다.\n", item->name);
+                    return -1;
+                }
+            }
+            top++;
+            continue;
+        }
+
+        // 단항 '-'와 뺄셈의 오른쪽 부분식은 부호가 바뀐다
+        int right = top - 1;
+        if (item->kind == EXPR_NEGATE || item->kind == '-') {
+            for (int j = first[right]; j < i; j++) {
+                result->external_sign[j] = -result->external_sign[j];
+            }
+        }
+        if (item->kind == EXPR_NEGATE) {
+            value[right] = -value[right];
+            relative[right] = -relative[right];
+            continue;
+        }
+
+        int left = --top - 1;
+        if ((item->kind == '*' || item->kind == '/') &&
+            (relative[left] != 0 || relative[right] != 0 || external[left] != 0 || external[right] != 0)) {
+            fprintf(stderr, "곱셈과 나눗셈에는 절대값 항만 사용할 수 있습니다.\n");
+            return -1;
+        }
+        if (item->kind == '/' && value[right] == 0) {
+            fprintf(stderr, "0으로 나눌 수 없습니다.\n");
+            return -1;
+        }
+
+        switch (item->kind) {
+            case '+':
+                value[left] += value[right];
+                relative[left] += relative[right];
+                break;
+            case '-':
+                value[left] -= value[right];
+                relative[left] -= relative[right];
+                break;
+            case '*':
+                value[left] *= value[right];
+                break;
+            case '/':
+                value[left] /= value[right];
+                break;
+        }
+        external[left] += external[right];
+    }
+
+    result->value = value[0];
+    result->relative = relative[0];
+    result->externals = external[0];
+
+    return 0;
+}
+
+
+/**
+ * @brief 소스코드 명령어 앞에 OPCODE가 기록된 코드를 파일에 출력한다.
+ * `output_dir`이 NULL인 경우 결과를 stdout으로 출력한다. 프로젝트 1에서는
+ * 불필요하다.
+ *
+ * @param output_dir 코드를 저장할 파일 경로, 혹은 NULL
+ * @param tokens 토큰 테이블 주소
+ * @param tokens_length 토큰 테이블의 길이
+ * @param inst_table 기계어 목록 테이블 주소
+ * @param inst_table_length 기계어 목록 테이블의 길이
+ * @return 오류 코드 (정상 종료 = 0)
+ *
+ * @details
+ * 소스코드 명령어 앞에 OPCODE가 기록된 코드를 파일에 출력한다. `output_dir`이
+ * NULL인 경우 결과를 stdout으로 출력한다. 명세서에 주어진 출력 예시와 완전히
+ * 동일할 필요는 없다. 프로젝트 1에서는 불필요하다.
+ */
+int make_opcode_output(const char *output_dir, const token *tokens[],
+                       int tokens_length, const inst *inst_table[],
+                       int inst_table_length) {
+    /* add your code */
+}
+
+
+/**
+ * @brief 어셈블리 코드을 위한 패스 2 과정을 수행한다.
+ *
+ * @param tokens 토큰 테이블 주소
+ * @param tokens_length 토큰 테이블 길이
+ * @param inst_table 기계어 목록 테이블 주소
+ * @param inst_table_length 기계어 목록 테이블 길이
+ * @param symbol_table 심볼 테이블 주소
+ * @param symbol_table_length 심볼 테이블 길이
+ * @param literal_table 리터럴 테이블 주소
+ * @param literal_table_length 리터럴 테이블 길이
+ * @param obj_code 오브젝트 코드에 대한 정보를 저장하는 구조체 주소
+ * @return 오류 코드 (정상 종료 = 0)
+ *
+ * @details
+ * 어셈블리 코드를 기계어 코드로 바꾸기 위한 패스2 과정을 수행한다. 패스 2의
+ * 프로그램을 기계어로 바꾸는 작업은 라인 단위로 수행된다.
+ */
+int assem_pass2(const token *tokens[], int tokens_length,
+                const inst *inst_table[], int inst_table_length,
+                const symbol *symbol_table[], int symbol_table_length,
+                const literal *literal_table[], int literal_table_length,
+                object_code *obj_code) {
+    /* add your code */
+    char buffer[100]; // 오브젝트 코드를 임시로 저장할 버퍼
+    int start_address = 0; // 각 컨트롤 섹션의 시작 주소 
+    int csect_length = 0; // 각 컨트롤 섹션의 총 길이 
+    char current_csect[20] = "DEFAULT"; // 현재 컨트롤 섹션 이름, 초기값은 "DEFAULT"
+
+    // 임시 수정 가능한 symbol_table과 literal_table 생성
+    // process_token이 라벨을 다시 추가하므로 토큰 수만큼 여유 공간을 둔다
+    int temp_symbol_table_length = symbol_table_length;
+    int temp_literal_table_length = literal_table_length;
+    symbol **temp_symbol_table = malloc((symbol_table_length + tokens_length) * sizeof(symbol*));
+    literal **temp_literal_table = malloc((literal_table_length + tokens_length) * sizeof(literal*));
+    if (temp_symbol_table == NULL || temp_literal_table == NULL) {
+        fprintf(stderr, "메모리 할당 실패\n");
+        return -1;
+    }
+    
+    // 원본 데이터를 임시 테이블에 복사
+    for (int i = 0; i < symbol_table_length; i++) {
+        temp_symbol_table[i] = (symbol*) symbol_table[i];
+    }
+    for (int j = 0; j < literal_table_length; j++) {
+        temp_literal_table[j] = (literal*) literal_table[j];
+    }
+
+    // 오브젝트 코드 구조체 초기화
+    memset(obj_code, 0, sizeof(object_code));
+    obj_code->num_sections = 1;
+
+    text_builder text_record = {0};
+    int current_locctr = 0;
+    int locctr = 0;
+    int current_section = 0;
+    int base = -1; // BASE 지시어로 지정된 베이스 레지스터 값 (-1 = NOBASE)
+    long long section_started = monotonic_ns(); // --trace: 현재 컨트롤 섹션의 시작 시각
+
+    for (int i = 0; i < tokens_length; i++) {
+        const token *tok = tokens[i];
+        const char *operator = tok->operator;
+        if (operator == NULL) { continue; }
+        const char *operand = tok->operand[0];
+        int opcode;
+        int format;
+        buffer[0] = '\0'; // 임시 버퍼 초기화 
+        
+        current_locctr = locctr;
+        char prev_csect[20];
+        strcpy(prev_csect, current_csect);
+        locctr = process_token(tok, inst_table, inst_table_length, 
+                                temp_symbol_table, &temp_symbol_table_length, 
+                                temp_literal_table, &temp_literal_table_length, locctr, current_csect);
+        trace_csect(prev_csect, current_csect, &section_started);
+        int nixbpe;
+
+        // Header 레코드 작성
+        if (strcmp(operator,"CSECT") == 0 || strcmp(operator, "END") == 0) {
+            if (flush_text_record(obj_code, current_section, &text_record) < 0) {
+                return -1;
+            }
+
+            csect_length = (strcmp(operator, "CSECT") == 0) ? current_locctr : locctr;
+            sprintf(obj_code->header[current_section][obj_code->header_count[current_section]], "H%-6s%06X%06X", prev_csect, start_address, csect_length);
+            obj_code->header_count[current_section]++;
+
+            if (strcmp(operator, "CSECT") == 0) {
+                current_section++;
+                obj_code->num_sections++;
+                start_address = locctr;
+            }
+        }
+
+        // End 레코드 작성
+        if (strcmp(operator, "START") == 0 || strcmp(operator, "CSECT") == 0) {
+            if (strcmp(operator, "START") == 0) {
+                sprintf(obj_code->end[current_section][obj_code->end_count[current_section]], "E%06X", start_address);
+                obj_code->end_count[current_section]++;
+            } else {
+                sprintf(obj_code->end[current_section][obj_code->end_count[current_section]], "E");
+                obj_code->end_count[current_section]++;
+            }
+        }
+
+        // BASE/NOBASE 지시어: 이후 명령어가 사용할 베이스 레지스터 값 지정
+        if (strcmp(operator, "CSECT") == 0 || strcmp(operator, "NOBASE") == 0) {
+            base = -1;
+        } else if (strcmp(operator, "BASE") == 0) {
+            if ((base = base_address(tok, symbol_table, symbol_table_length,
+                                     current_csect, current_locctr)) < 0) {
+                return -1;
+            }
+            continue;
+        }
+
+        // Define 레코드 작성 
+        if (strcmp(operator, "EXTDEF") == 0) {
+            sprintf(obj_code->define[current_section][obj_code->define_count[current_section]], "D");
+            for (int i = 0; i < MAX_OPERAND_PER_INST && tok->operand[i] != NULL; i++) {
+                for (int j = 0; j < symbol_table_length; j++) {
+                    if (strcmp(symbol_table[j]->name, tok->operand[i]) == 0) {
+                        sprintf(obj_code->define[current_section][obj_code->define_count[current_section]] + strlen(obj_code->define[current_section][obj_code->define_count[current_section]]),
+                             "%-6s%06X", tok->operand[i], symbol_table[j]->addr);
+                        break;
+                    }
+                }
+            }
+            obj_code->define_count[current_section]++;
+            continue;
+        }
+
+        // Reference 레코드 작성
+        if (strcmp(operator, "EXTREF") == 0) {
+            sprintf(obj_code->reference[current_section][obj_code->reference_count[current_section]], "R");
+            for (int j = 0; j < MAX_OPERAND_PER_INST && tok->operand[j]; j++) {
+                sprintf(obj_code->reference[current_section][obj_code->reference_count[current_section]] + strlen(obj_code->reference[current_section][obj_code->reference_count[current_section]]),
+                        "%-6s", tok->operand[j]);
+            }
+            obj_code->reference_count[current_section]++;
+            continue;
+        }
+
+        // Modification 레코드 생성
+        int reloc_offset = -1; // 섹션 내 재배치가 필요한 3바이트 필드의 위치 (--reloc-bitmask)
+        int word_value = 0;
+        if (operand != NULL && (operand[0] == '#' || operand[0] == '@')) {
+            // 4형식의 수정 대상은 주소 지정 방식 기호를 뗀 심볼 이름
+            operand++;
+        }
+        // 같은 섹션의 심볼이나 리터럴을 가리키는 4형식 명령어는 주소 필드에 섹션 상대 주소가 들어 있다
+        const symbol *target_symbol = operand == NULL ? NULL :
+            search_symbol((symbol **)symbol_table, symbol_table_length, operand, current_csect);
+        bool local_target = operator[0] == '+' && operand != NULL &&
+            (operand[0] == '=' || (target_symbol != NULL && !target_symbol->absolute));
+        int constant;
+        if (operator[0] == '+' && (operand == NULL || isdigit(operand[0]) ||
+                                   immediate_constant(tok->operand[0], &constant) ||
+                                   (target_symbol != NULL && target_symbol->absolute))) {
+            // 상수 피연산자와 절대값 심볼은 재배치하지 않는다
+        } else if (local_target && option.relocation_bitmask) {
+            // 주소 필드(2~4번째 바이트)를 비트마스크로 재배치
+            reloc_offset = 1;
+        } else if (strcmp(operator, "WORD") == 0) {
+            // 상수 항은 재배치하지 않고, 외부 참조와 상쇄되지 않은 섹션 상대 항만 재배치한다
+            expr_value value;
+            if (tok->expr == NULL ||
+                evaluate_expression(tok->expr, symbol_table, symbol_table_length, current_csect,
+                                    current_locctr, true, &value) < 0) {
+                fprintf(stderr, "WORD 피연산자 %s을(를) 계산할 수 없습니다.\n", operand == NULL ? "(없음)" : operand);
+                return -1;
+            }
+            word_value = value.value;
+            reloc_offset = word_relocation(obj_code->modification[current_section],
+                                           &obj_code->modify_count[current_section], tok->expr,
+                                           &value, current_locctr, current_csect);
+            if (reloc_offset == -2) {
+                return -1;
+            }
+        } else if (operator[0] == '+') {
+            // 섹션 상대 주소는 섹션 이름으로 재배치
+            const char *target = local_target ? current_csect : operand;
+            if (add_modification(obj_code->modification[current_section], &obj_code->modify_count[current_section],
+                                 current_locctr + 1, 5, '+', target) < 0) {
+                return -1;
+            }
+        }
+        if (reloc_offset >= 0) {
+            obj_code->modules[current_section].bitmask_relocations++;
+        }
+
+        // 리터럴 풀: 이 위치에 배치된 이 섹션의 리터럴을 주소 순서대로 출력
+        if (strcmp(operator, "LTORG") == 0 || strcmp(operator, "END") == 0) {
+            for (int k = 0; k < literal_table_length; k++) {
+                const literal *lit = literal_table[k];
+                if (lit->addr < current_locctr || lit->addr >= locctr ||
+                    strcmp(lit->csect, current_csect) != 0) {
+                    continue;
+                }
+
+                literal_object_code(buffer, lit->literal);
+                if (append_text_record(obj_code, current_section, &text_record, lit->addr, buffer, -1) < 0) {
+                    return -1;
+                }
+                obj_code->modules[current_section].literals++;
+            }
+            continue;
+        }
+
+        // 지시어인 경우
+        if (strcmp(operator, "BYTE") == 0 || strcmp(operator, "WORD") == 0) {
+            // 긴 BYTE 상수는 고정 크기 버퍼를 넘으므로 피연산자 길이에 맞게 할당한다
+            char *code = buffer;
+            if (strcmp(operator, "BYTE") == 0 &&
+                (code = (char *)calloc(2 * strlen(operand) + 1, 1)) == NULL) {
+                fprintf(stderr, "메모리 할당 실패\n");
+                return -1;
+            }
+
+            // 지시어의 오브젝트 코드를 생성 
+            generate_directive_object_code(code, tok);
+            if (strcmp(operator, "WORD") == 0) {
+                sprintf(code, "%06X", word_value & 0xFFFFFF);
+            }
+
+            // Text 레코드 추가
+            int appended = append_text_record(obj_code, current_section, &text_record, current_locctr,
+                                              code, reloc_offset);
+            if (code != buffer) {
+                free(code);
+            }
+            if (appended < 0) {
+                return -1;
+            }
+            continue;
+        }
+
+        // 명령어인 경우: 정보 검색 
+        int index = search_opcode(operator, inst_table, inst_table_length);
+        if (index != -1) {
+            format = operator[0] == '+' ? 4 : inst_table[index]->format;
+            opcode = inst_table[index]->op;
+        } else {
+            continue;
+        }
+        
+        // 명령어 형식에 따라 오브젝트 코드 생성
+        switch (format) {
+            case 1:
+                sprintf(buffer, "%02X", opcode);
+                break;
+            case 2: 
+                // 레지스터 코드 처리 필요 
+                sprintf(buffer, "%02X%1X%1X", opcode, reg_code(tok->operand[0]), reg_code(tok->operand[1]));
+                break;
+            case 3: 
+            case 4: 
+                // TO-DO: 3, 4형식 명령어의 오브젝트 코드를 생성하는 함수 구현하기 
+                nixbpe = tok->nixbpe;
+                
+                format3or4(buffer, tok, opcode, format, locctr, base,
+                         symbol_table, symbol_table_length, literal_table, literal_table_length, current_csect);
+
+                break;
+            default: 
+                fprintf(stderr, "지원하지 않는 명령어 형식입니다. %d\n", format);
+                return -1;
+        }
+
+        // 섹션별 명령어 통계: 3/4형식은 만든 오브젝트 코드의 ni, xbpe 비트로 주소 지정 방식을 센다
+        module_stats *module = &obj_code->modules[current_section];
+        module->mnemonics[index]++;
+        module->formats[format]++;
+        if (format >= 3) {
+            int bits = hex_field(buffer, 3); // opcode 상위 6비트 + nixbpe
+            module->immediate += (bits & 0x30) == 0x10;
+            module->indirect += (bits & 0x30) == 0x20;
+            module->simple += (bits & 0x30) == 0x30;
+            module->indexed += (bits & 0x08) != 0;
+            module->base_relative += (bits & 0x04) != 0;
+            module->pc_relative += (bits & 0x02) != 0;
+            module->extended += (bits & 0x01) != 0;
+            module->direct += (bits & 0x37) == 0x30;
+        }
+        if (operand != NULL && operand[0] == '=') {
+            module->literal_refs++;
+        }
+
+        // Text 레코드 추가
+        if (append_text_record(obj_code, current_section, &text_record, current_locctr, buffer,
+                               reloc_offset) < 0) {
+            return -1;
+        }
+    }
+
+    // 마지막 텍스트 레코드 추가 (있는 경우)
+    if (flush_text_record(obj_code, current_section, &text_record) < 0) {
+        return -1;
+    }
+    trace_csect(current_csect, "", &section_started); // 마지막 컨트롤 섹션의 구간을 닫는다
+
+    return 0;
+    
+}
+
+/**
+ * @brief 소스를 한 번만 읽으며 오브젝트 코드를 만든다. (--one-pass)
+ *
+ * @param inst_table 기계어 목록 테이블의 주소
+ * @param inst_table_length 기계어 목록 테이블의 길이
+ * @param input_dir 소스코드 파일 경로
+ * @param symbol_table 심볼 테이블의 시작 주소
+ * @param symbol_table_length 심볼 테이블의 길이를 저장하는 변수 주소
+ * @param literal_table 리터럴 테이블의 시작 주소
+ * @param literal_table_length 리터럴 테이블의 길이를 저장하는 변수 주소
+ * @param objectcode_dir 오브젝트 코드를 저장할 파일 경로
+ * @param result 수행 결과를 저장할 구조체 주소
+ * @return 오류 코드 (정상 종료 = 0)
+ *
+ * @details
+ * 소스 파일을 한 라인씩 읽어 토큰으로 나누고 곧바로 LOCCTR를 계산하여 오브젝트
+ * 코드를 만든다. 소스 전체나 토큰 테이블은 보관하지 않는다. 아직 정의되지 않은
+ * 심볼이나 주소가 정해지지 않은 리터럴을 참조하는 명령어와 WORD는 자리만
+ * 0으로 채워 두고, 기다리는 심볼별 fixup 체인에 토큰을 넣는다. 라벨이 정의되거나
+ * 리터럴 풀이 배치되면 체인의 토큰을 다시 인코딩한다. 아직 채우는 중인 T
+ * 레코드 안에 있으면 그 자리를 직접 고치고, 이미 출력한 레코드에 있으면 같은
+ * 주소를 덮어쓰는 T 레코드를 추가한다.
+ *
+ * 레코드는 만드는 즉시 `objectcode_dir`에 쓴다. H 레코드는 길이를, D 레코드는
+ * 주소를 0으로 채워 먼저 쓰고 END 또는 다음 CSECT에서 fseek로 고친다. 닫은 T
+ * 레코드는 바로 쓰고, M 레코드는 섹션이 끝날 때 E 레코드와 함께 쓴다. 따라서
+ * 메모리에는 채우는 중인 T 레코드, 현재 섹션의 M 레코드, 심볼/리터럴 테이블과
+ * 해결을 기다리는 체인만 남는다.
+ *
+ * 한 번에 읽어야 하므로 EQU와 BASE는 앞에서 정의된 심볼만 참조할 수 있고, 외부
+ * 참조 심볼은 사용하기 전에 EXTREF로 선언해야 한다. 소스는 START로 시작해야
+ * 하고, EXTDEF는 섹션의 EXTREF와 명령어보다 앞에 와야 한다. 섹션이 끝날 때까지
+ * 정의되지 않은 심볼이 남으면 실패한다.
+ */
+int assem_one_pass(const inst *inst_table[], int inst_table_length,
+                   const char *input_dir, symbol *symbol_table[],
+                   int *symbol_table_length, literal *literal_table[],
+                   int *literal_table_length, const char *objectcode_dir,
+                   one_pass_result *result) {
+    one_pass_state *state = (one_pass_state *)calloc(1, sizeof(one_pass_state));
+    char line[MAX_INPUT_LINES];
+    int err = 0;
+
+    FILE *fp = fopen(input_dir, "r");
+    if (fp == NULL) {
+        perror("소스파일 열기 실패");
+        free(state);
+        return -1;
+    }
+    if (state == NULL) {
+        fprintf(stderr, "메모리 할당 실패\n");
+        fclose(fp);
+        return -1;
+    }
+    FILE *out = fopen(objectcode_dir, "w");
+    if (out == NULL) {
+        perror("오브젝트 코드 파일 열기 실패");
+        fclose(fp);
+        free(state);
+        return -1;
+    }
+
+    memset(result, 0, sizeof(one_pass_result));
+    *symbol_table_length = 0;
+    *literal_table_length = 0;
+
+    state->inst_table = inst_table;
+    state->inst_table_length = inst_table_length;
+    state->symbol_table = symbol_table;
+    state->symbol_table_length = symbol_table_length;
+    state->literal_table = literal_table;
+    state->literal_table_length = literal_table_length;
+    state->result = result;
+    state->out = out;
+    state->text.out = out;
+    state->header_pos = -1;
+    state->section = -1;
+    state->base = -1;
+    strcpy(state->csect, "DEFAULT");
+
+    while (err == 0 && fgets(line, MAX_INPUT_LINES, fp) != NULL) {
+        size_t line_length = strlen(line);
+        while (line_length > 0 && (line[line_length - 1] == '\n' || line[line_length - 1] == '\r')) {
+            line[--line_length] = '\0';
+        }
+        result->lines++;
+
+        token *tok = (token *)malloc(sizeof(token));
+        if (tok == NULL) {
+            fprintf(stderr, "라인 %d에서 메모리 할당 실패. \n", result->lines);
+            err = -1;
+            break;
+        }
+        init_token(tok);
+        if ((err = token_parsing(line, tok, inst_table, inst_table_length)) != 0) {
+            fprintf(stderr, "라인 %d에서 오류 %d로 파싱 실패. \n", result->lines, err);
+            free_token(tok);
+            break;
+        }
+        tok->nixbpe = set_nixbpe(tok, inst_table, inst_table_length);
+
+        const char *operator = tok->operator;
+        if (operator != NULL && tok->operand[0] != NULL &&
+            (strcmp(operator, "EQU") == 0 || strcmp(operator, "WORD") == 0) &&
+            (tok->expr = compile_expression(tok->operand[0])) == NULL) {
+            free_token(tok);
+            err = -1;
+            break;
+        }
+
+        // 체인에 들어간 토큰은 심볼이 정의될 때까지 남겨 둔다
+        int kept = one_pass_line(state, tok);
+        if (kept < 0) {
+            fprintf(stderr, "라인 %d를 처리하지 못했습니다.\n", result->lines);
+            err = -1;
+        }
+        if (kept <= 0) {
+            free_token(tok);
+        }
+    }
+
+    // END 없이 끝난 소스도 마지막 섹션을 닫는다
+    if (err == 0 && state->header_pos >= 0) {
+        err = one_pass_close_section(state);
+    }
+
+    // 실패한 경우 남은 체인을 정리한다
+    while (state->chains != NULL) {
+        fixup_chain *chain = state->chains;
+        while (chain->head != NULL) {
+            fixup *entry = chain->head;
+            chain->head = entry->next;
+            free_token(entry->tok);
+            free(entry);
+        }
+        state->chains = chain->next;
+        free(chain);
+    }
+
+    if (ferror(out)) {
+        fprintf(stderr, "오브젝트 코드 파일 쓰기 실패\n");
+        err = -1;
+    }
+    run_stats.bytes_written += ftell(out);
+    fclose(out);
+    fclose(fp);
+    free(state);
+
+    return err;
+}
+
+/**
+ * @brief --one-pass 모드에서 토큰 라인 하나를 처리한다.
+ * @return 토큰을 fixup 체인에 넣었으면 1, 처리를 마쳤으면 0, 오류이면 -1
+ */
+static int one_pass_line(one_pass_state *state, token *tok) {
+    const char *label = tok->label;
+    const char *operator = tok->operator;
+    const char *operand = tok->operand[0];
+    if (operator == NULL) {
+        return 0;
+    }
+
+    if (strcmp(operator, "MACRO") == 0) {
+        fprintf(stderr, "--one-pass 모드에서는 매크로를 사용할 수 없습니다.\n");
+        return -1;
+    }
+    if (strcmp(operator, "USE") == 0) {
+        fprintf(stderr, "--one-pass 모드에서는 프로그램 블록(USE)을 사용할 수 없습니다.\n");
+        return -1;
+    }
+
+    if (strcmp(operator, "START") == 0 || strcmp(operator, "CSECT") == 0) {
+        if (label == NULL) {
+            fprintf(stderr, "%s에 컨트롤 섹션 이름이 없습니다.\n", operator);
+            return -1;
+        }
+        if (strcmp(operator, "CSECT") == 0) {
+            if (state->header_pos < 0) {
+                fprintf(stderr, "--one-pass 모드에서 CSECT 앞에 START가 없습니다.\n");
+                return -1;
+            }
+            if (one_pass_close_section(state) < 0) return -1;
+            state->locctr = 0;
+        } else {
+            if (state->section >= 0) {
+                fprintf(stderr, "START는 소스의 처음에 한 번만 올 수 있습니다.\n");
+                return -1;
+            }
+            state->locctr = operand != NULL ? atoi(operand) : 0;
+        }
+
+        state->section++;
+        strcpy(state->csect, label);
+        state->start_address = state->locctr;
+        state->base = -1;
+        state->extref_count = 0;
+        state->extdef_count = 0;
+        state->modify_count = 0;
+        add_symbol(state->symbol_table, state->symbol_table_length, label, state->locctr, state->csect);
+
+        // 섹션 길이는 아직 모르므로 0으로 채워 두고 섹션을 닫을 때 고친다
+        fprintf(state->out, "H%-6s%06X", state->csect, state->start_address);
+        state->header_pos = ftell(state->out);
+        fprintf(state->out, "%06X\n", 0);
+        state->body_pos = ftell(state->out);
+        return 0;
+    }
+
+    // 레코드는 바로 출력하므로 H 레코드보다 앞에 올 수 없다
+    if (state->header_pos < 0) {
+        fprintf(stderr, "--one-pass 모드에서는 START 앞이나 END 뒤에 %s을(를) 둘 수 없습니다.\n", operator);
+        return -1;
+    }
+
+    // 라벨 정의: 이 심볼을 기다리던 명령어를 해결한다 (EQU는 값을 계산한 뒤)
+    if (label != NULL && strcmp(operator, "EQU") != 0) {
+        add_symbol(state->symbol_table, state->symbol_table_length, label, state->locctr, state->csect);
+        if (one_pass_define(state, label) < 0) return -1;
+    }
+
+    if (strcmp(operator, "EXTDEF") == 0) {
+        if (state->extdef_count == MAX_RECORDS) {
+            fprintf(stderr, "EXTDEF가 너무 많습니다. (최대 %d개)\n", MAX_RECORDS);
+            return -1;
+        }
+        // D 레코드는 H 레코드 바로 뒤에 와야 하므로 다른 레코드를 쓰기 전이어야 한다
+        if (state->text.length > 0 || ftell(state->out) != state->body_pos) {
+            fprintf(stderr, "--one-pass 모드에서 EXTDEF는 섹션의 EXTREF와 명령어보다 앞에 와야 합니다.\n");
+            return -1;
+        }
+
+        // 주소는 섹션을 닫을 때 채운다
+        state->extdef_pos[state->extdef_count] = ftell(state->out);
+        fprintf(state->out, "D");
+        for (int i = 0; i < MAX_OPERAND_PER_INST; i++) {
+            snprintf(state->extdef[state->extdef_count][i], sizeof(state->extdef[0][0]), "%s",
+                     tok->operand[i] != NULL ? tok->operand[i] : "");
+            if (tok->operand[i] != NULL) {
+                fprintf(state->out, "%-6s%06X", tok->operand[i], 0);
+            }
+        }
+        fprintf(state->out, "\n");
+        state->body_pos = ftell(state->out);
+        state->extdef_count++;
+        return 0;
+    }
+
+    if (strcmp(operator, "EXTREF") == 0) {
+        fprintf(state->out, "R");
+        for (int i = 0; i < MAX_OPERAND_PER_INST && tok->operand[i] != NULL; i++) {
+            if (state->extref_count == MAX_RECORDS) {
+                fprintf(stderr, "EXTREF가 너무 많습니다. (최대 %d개)\n", MAX_RECORDS);
+                return -1;
+            }
+            fprintf(state->out, "%-6s", tok->operand[i]);
+            snprintf(state->extref[state->extref_count++], sizeof(state->extref[0]), "%s", tok->operand[i]);
+        }
+        fprintf(state->out, "\n");
+        return 0;
+    }
+
+    if (strcmp(operator, "BASE") == 0) {
+        // 한 번에 읽으므로 베이스 심볼은 앞에서 정의되어 있어야 한다
+        state->base = base_address(tok, (const symbol **)state->symbol_table, *state->symbol_table_length,
+                                   state->csect, state->locctr);
+        return state->base < 0 ? -1 : 0;
+    }
+    if (strcmp(operator, "NOBASE") == 0) {
+        state->base = -1;
+        return 0;
+    }
+    if (strcmp(operator, "RESB") == 0) {
+        state->locctr += atoi(operand);
+        return 0;
+    }
+    if (strcmp(operator, "RESW") == 0) {
+        state->locctr += 3 * atoi(operand);
+        return 0;
+    }
+
+    if (strcmp(operator, "BYTE") == 0) {
+        char *buffer = (char *)calloc(2 * strlen(operand) + 1, 1);
+        if (buffer == NULL) {
+            fprintf(stderr, "메모리 할당 실패\n");
+            return -1;
+        }
+        generate_directive_object_code(buffer, tok);
+        int err = append_text_record(NULL, state->section, &state->text, state->locctr, buffer, -1);
+        state->locctr += strlen(buffer) / 2;
+        free(buffer);
+        return err;
+    }
+
+    if (strcmp(operator, "EQU") == 0) {
+        expr_value value;
+        if (label == NULL || tok->expr == NULL ||
+            evaluate_expression(tok->expr, (const symbol **)state->symbol_table, *state->symbol_table_length,
+                                state->csect, state->locctr, false, &value) < 0) {
+            fprintf(stderr, "--one-pass 모드의 EQU는 앞에서 정의된 심볼만 참조할 수 있습니다.\n");
+            return -1;
+        }
+        if (value.relative != 0 && value.relative != 1) {
+            fprintf(stderr, "EQU 심볼 %s의 값은 절대값이나 섹션 상대 주소여야 합니다.\n", label);
+            return -1;
+        }
+        add_symbol(state->symbol_table, state->symbol_table_length, label, value.value, state->csect);
+        state->symbol_table[*state->symbol_table_length - 1]->absolute = value.relative == 0;
+        return one_pass_define(state, label);
+    }
+
+    if (strcmp(operator, "LTORG") == 0) {
+        return one_pass_place_literals(state);
+    }
+    if (strcmp(operator, "END") == 0) {
+        return one_pass_close_section(state);
+    }
 
-        if (end > st) {  // 유효한 피연산자가 있는 경우에만 메모리 할당
-            operand[operand_cnt] = (char *)malloc(end - st + 1);
-            if (operand[operand_cnt] == NULL) {
-                return -1;  // 메모리 할당 실패
-            }
-            memcpy(operand[operand_cnt], operand_input + st, end - st);
-            operand[operand_cnt][end - st] = '\0';  // 피연산자 끝에 널 문자 추가
-            ++operand_cnt;
+    // 명령어와 WORD: 크기는 바로 알 수 있으므로 LOCCTR는 참조 해결과 무관하게 진행한다
+    int size = 3;
+    if (strcmp(operator, "WORD") != 0) {
+        int index = search_opcode(operator, state->inst_table, state->inst_table_length);
+        if (index == -1) {
+            return 0;
         }
+        size = operator[0] == '+' ? 4 : state->inst_table[index]->format;
+    }
+    if (operand != NULL && operand[0] == '=') {
+        add_literal(state->literal_table, state->literal_table_length, operand, -1, state->csect);
+    }
 
-        st = end + 1;  // 쉼표 다음 위치로 시작 지점 업데이트
+    char buffer[MAX_OBJECT_CODE_STRING + 1];
+    char missing[20];
+    int addr = state->locctr;
+    int status = one_pass_encode(state, tok, addr, state->base, buffer, missing);
+    state->locctr += size;
+    if (status < 0) {
+        return -1;
+    }
+    if (status == 0) {
+        return append_text_record(NULL, state->section, &state->text, addr, buffer, -1);
     }
 
-    return 0;
+    // 전방 참조: 자리만 채워 두고 심볼이 정의되면 고친다
+    fixup *entry = (fixup *)malloc(sizeof(fixup));
+    if (entry == NULL) {
+        fprintf(stderr, "메모리 할당 실패\n");
+        return -1;
+    }
+    entry->tok = tok;
+    entry->addr = addr;
+    entry->base = state->base;
+    memset(buffer, '0', size * 2);
+    buffer[size * 2] = '\0';
+    if (append_text_record(NULL, state->section, &state->text, addr, buffer, -1) < 0 ||
+        one_pass_defer(state, entry, missing) < 0) {
+        free(entry);
+        return -1;
+    }
+    state->result->forward_refs++;
+
+    return 1;
 }
 
 /**
- * @brief 토큰 라인 별로 nixbpe 비트를 설정한다. 
-*/
-static int set_nixbpe(token *tok, const inst *inst_table[], int inst_table_length) {
-    const char *operand = tok->operand[0];
+ * @brief 토큰 하나(명령어 또는 WORD)의 오브젝트 코드와 M 레코드를 만든다.
+ * @return 0 = 완료, 1 = `missing`에 적은 심볼이 아직 정의되지 않음, -1 = 오류
+ */
+static int one_pass_encode(one_pass_state *state, const token *tok, int addr, int base,
+                           char *buffer, char *missing) {
     const char *operator = tok->operator;
-    if (operator == NULL) {
-        return 0;
-    }
-    int format;
-    int index = search_opcode(operator, inst_table, inst_table_length);
-    if (index != -1) {
-        if (operator[0] == '+') {
-            format = 4;
-        } else {
-            format = inst_table[index]->format;
+    const char *operand = tok->operand[0];
+    const symbol **symbol_table = (const symbol **)state->symbol_table;
+    int symbol_table_length = *state->symbol_table_length;
+
+    if (strcmp(operator, "WORD") == 0) {
+        expr_value value;
+        for (int i = 0; tok->expr != NULL && i < tok->expr->length; i++) {
+            const char *name = tok->expr->items[i].name;
+            if (tok->expr->items[i].kind == EXPR_SYMBOL && !one_pass_is_extref(state, name) &&
+                search_symbol((symbol **)symbol_table, symbol_table_length, name, state->csect) == NULL) {
+                strcpy(missing, name);
+                return 1;
+            }
+        }
+        if (tok->expr == NULL ||
+            evaluate_expression(tok->expr, symbol_table, symbol_table_length, state->csect,
+                                addr, true, &value) < 0) {
+            fprintf(stderr, "WORD 피연산자 %s을(를) 계산할 수 없습니다.\n", operand == NULL ? "(없음)" : operand);
+            return -1;
         }
+        sprintf(buffer, "%06X", value.value & 0xFFFFFF);
+        return word_relocation(state->modification, &state->modify_count, tok->expr, &value, addr,
+                               state->csect) == -2 ? -1 : 0;
     }
 
-    int nixbpe = 0;
+    int index = search_opcode(operator, state->inst_table, state->inst_table_length);
+    int format = operator[0] == '+' ? 4 : state->inst_table[index]->format;
+    int opcode = state->inst_table[index]->op;
+    if (format == 1) {
+        sprintf(buffer, "%02X", opcode);
+        return 0;
+    }
+    if (format == 2) {
+        sprintf(buffer, "%02X%1X%1X", opcode, reg_code(tok->operand[0]), reg_code(tok->operand[1]));
+        return 0;
+    }
 
-    if (strcmp(operator, "RSUB") == 0) {
-        nixbpe = 0x30; // n=1, i=1
-    } else if (operand == NULL) {
-        ;
-    } else {
-        // Immediate addressing 
-        if (operand[0] == '#') {
-            nixbpe = 0x10; // n=0, i=1
-            if (isalpha(operand[1])) {
-                // 문자일 경우 PC-relative 
-                nixbpe |= 0x02;
-            }
-        }   
-        // Indirect addressing
-        else if (operand[0] == '@') {
-            nixbpe = 0x20; // n=1, i=0
-            if (isalpha(operand[1])) {
-                // 문자일 경우 PC-relative 
-                nixbpe |= 0x02;
-            }
+    // 참조하는 심볼 또는 리터럴이 아직 정해지지 않았으면 기다린다
+    const char *name = (operand != NULL && (operand[0] == '#' || operand[0] == '@')) ? operand + 1 : operand;
+    const symbol *sym = NULL;
+    if (name != NULL && name[0] == '=') {
+        literal *lit = search_literal(state->literal_table, *state->literal_table_length, (char *)name, state->csect);
+        if (lit == NULL || lit->addr == -1) {
+            snprintf(missing, 20, "%s", name);
+            return 1;
         }
-        // Simple or Direct addrssing
-        else {
-            if (format == 4) {
-                nixbpe = 0x31; // n=1, i=1, e=1
-            } else {
-                nixbpe = 0x32; // n=1, i=1, p=1
-            }
+    } else if (name != NULL && isalpha(name[0])) {
+        sym = search_symbol((symbol **)symbol_table, symbol_table_length, name, state->csect);
+        if (sym == NULL && !one_pass_is_extref(state, name)) {
+            snprintf(missing, 20, "%s", name);
+            return 1;
         }
+    }
 
-        // Indexed addressing
-        const char* operand_2 = tok->operand[1];
-        if (operand_2 != NULL && strcmp(operand_2, "X") == 0) {
-            nixbpe |= 0x08; // x=1
+    format3or4(buffer, tok, opcode, format, addr + format, base, symbol_table, symbol_table_length,
+               (const literal **)state->literal_table, *state->literal_table_length, state->csect);
+
+    // 4형식의 재배치: 같은 섹션의 주소는 섹션 이름으로, 외부 참조는 심볼 이름으로
+    int constant;
+    if (format == 4 && name != NULL && !isdigit(name[0]) && !immediate_constant(operand, &constant) &&
+        !(sym != NULL && sym->absolute)) {
+        const char *target = (name[0] == '=' || sym != NULL) ? state->csect : name;
+        if (add_modification(state->modification, &state->modify_count, addr + 1, 5, '+', target) < 0) {
+            return -1;
         }
     }
 
-    return nixbpe;
+    return 0;
 }
 
 /**
- * @brief 토큰 라인을 읽어 심볼 테이블 및 리터럴 테이블을 생성한다. 
- * @return 다음 토큰 라인의 LOCCTR 
-*/
-static int process_token(const token *tok, const inst *inst_table[], int inst_table_length,
-                        symbol **symbol_table, int *num_symbols, 
-                        literal **literal_table, int *num_literals, int locctr, char *current_csect) {
-    const char *label = tok->label;
-    const char *operator = tok->operator;
-    const char *operand = tok->operand[0];
-    if (operator == NULL) { return locctr;}
-    int next_locctr = locctr;
+ * @brief fixup 항목을 `name`을 기다리는 체인에 넣는다. 체인이 없으면 만든다.
+ */
+static int one_pass_defer(one_pass_state *state, fixup *entry, const char *name) {
+    fixup_chain *chain = state->chains;
+    while (chain != NULL && strcmp(chain->name, name) != 0) {
+        chain = chain->next;
+    }
 
-    // LOCCTR 계산
-    if (operator != NULL) {
-        if (tok->nixbpe & 0x01) {
-            // 4형식 명령어인 경우
-            locctr += 4;
-        } else {
-            // 2, 3형식 명령어인 경우
-            int index = search_opcode(operator, inst_table, inst_table_length);
-            if (index != -1) {
-                locctr += inst_table[index]->format;
-            } else {
-                // 지시어 처리 
-                if (strcmp(operator, "START") == 0) {
-                    locctr = atoi(operand);
-                    strcpy(current_csect, label); // 새로운 컨트롤 섹션 이름 설정
-                } else if (strcmp(operator, "CSECT") == 0) {
-                    locctr = 0;
-                    next_locctr = 0;
-                    strcpy(current_csect, label); // 새로운 컨트롤 섹션 이름 설정
-                } else if (strcmp(operator, "EXTDEF") == 0 || strcmp(operator, "EXTREF") == 0) {
-                    ;
-                } else if (strcmp(operator, "RESB") == 0) {
-                    locctr += atoi(operand);
-                } else if (strcmp(operator, "RESW") == 0) {
-                    locctr += 3 * atoi(operand);
-                } else if (strcmp(operator, "BYTE") == 0) {
-                    int operand_length = strlen(operand);
-                    if (operand[0] == 'X') { 
-                        // 두 글자당 한 바이트를 할당
-                        locctr += (operand_length - 3) / 2;
-                    } else if (operand[0] == 'C') {
-                        // 한 글자당 한 바이트를 할당
-                        locctr += operand_length - 3;
-                    }
-                } else if (strcmp(operator, "WORD") == 0) {
-                    locctr += 3;
-                } else if (strcmp(operator, "LTORG") == 0 || strcmp(operator, "END") == 0) {
-                    // 리터럴 풀의 주소값을 계산하고 리터럴 테이블에 주소값을 할당
-                    for (int k = 0; k < *num_literals; k++) {
-                        // 주소가 할당되지 않은 리터럴이 있는 경우 
-                        if (literal_table[k]->addr == -1) {
-                            literal_table[k]->addr = locctr;
-                        }
-                            
-                        // 리터럴 값에서 실제 데이터 부분 추출
-                        const char *lit_value = literal_table[k]->literal;
-                        char type = lit_value[1];  // 리터럴 타입: 'C' 또는 'X'
-                        const char* content = lit_value + 3;  // 실제 데이터 시작 위치
-                        int content_length = strlen(content) - 1;  // 마지막 따옴표 제거
-
-                        if (type == 'X') {
-                            // 16진수 리터럴, 두 글자당 1바이트
-                            locctr += (content_length + 1) / 2;  // 홀수 길이 처리를 위해 반올림
-                            break;
-                        } else if (type == 'C') {
-                            // 문자 리터럴, 각 글자당 1바이트
-                            locctr += content_length;
-                            break;
-                        }
-                    }
-                } else if (strcmp(operator, "EQU") == 0) {
-                    if (operand[0] == '*') {
-                        // 피연산자가 '*'인 경우
-                        ;
-                    } else {
-                        char *operand_copy = strdup(operand);
-                        if (operand_copy == NULL) {
-                            fprintf(stderr, "메모리 할당 실패\n");
-                            return -1;
-                        } 
-                        
-                        char *token = strtok(operand_copy, "+-");
-                        int result = 0;
-                        bool first = true;
-                        char* next_ptr;
-
-                        while (token) {
-                            symbol* sym = search_symbol(symbol_table, *num_symbols, token, current_csect);
-                            if (sym == NULL) {
-                                fprintf(stderr, "심볼 %s을(를) 찾을 수 없습니다.\n", token);
-                                free(operand_copy);
-                                return -1;
-                            }
+    if (chain == NULL) {
+        chain = (fixup_chain *)malloc(sizeof(fixup_chain));
+        if (chain == NULL) {
+            fprintf(stderr, "메모리 할당 실패\n");
+            return -1;
+        }
+        snprintf(chain->name, sizeof(chain->name), "%s", name);
+        chain->head = NULL;
+        chain->next = state->chains;
+        state->chains = chain;
+    }
 
-                            // 연산 처리
-                            int sym_value = sym->addr;
-                            if (first) {
-                                result = sym_value;
-                                first = false;
-                            } else {
-                                char operation = operand[strlen(token)];  // strtok 이전에 토큰의 바로 앞 문자(연산자) 접근
-                                if (operation == '-') {
-                                    result -= sym_value;
-                                } else if (operation == '+') {
-                                    result += sym_value;
-                                }
-                            }
+    entry->next = chain->head;
+    chain->head = entry;
+    state->pending++;
+    if (state->pending > state->result->max_pending) {
+        state->result->max_pending = state->pending;
+    }
 
-                            token = strtok(NULL, "+-");
-                        }
+    return 0;
+}
 
-                        free(operand_copy);
-                        next_locctr = result;
-                    }
-                } 
-            }
-        }
+/**
+ * @brief `name`이 정의되었으므로 이를 기다리던 fixup 체인을 해결한다. 다른 심볼을
+ * 더 기다려야 하는 항목(여러 심볼을 참조하는 WORD)은 그 심볼의 체인으로 옮긴다.
+ */
+static int one_pass_define(one_pass_state *state, const char *name) {
+    fixup_chain **link = &state->chains;
+    while (*link != NULL && strcmp((*link)->name, name) != 0) {
+        link = &(*link)->next;
     }
-
-    // 라벨이 있는 경우 -> 심볼 테이블에 추가
-    if (label != NULL && label[0] != '\0') { 
-        add_symbol(symbol_table, num_symbols, label, next_locctr, current_csect);
+    if (*link == NULL) {
+        return 0;
     }
 
-    // 피연산자가 리터럴인 경우 -> 리터럴 테이블에 추가
-    if (operand != NULL && operand[0] == '=') {
-        add_literal(literal_table, num_literals, operand, -1); // 리터럴의 주소 초기값: -1
+    fixup_chain *chain = *link;
+    fixup *entry = chain->head;
+    *link = chain->next;
+    free(chain);
+
+    while (entry != NULL) {
+        fixup *next = entry->next;
+        char buffer[MAX_OBJECT_CODE_STRING + 1];
+        char missing[20];
+        state->pending--;
+
+        int status = one_pass_encode(state, entry->tok, entry->addr, entry->base, buffer, missing);
+        if (status < 0) {
+            return -1;
+        }
+        if (status == 1) {
+            if (one_pass_defer(state, entry, missing) < 0) return -1;
+        } else {
+            if (one_pass_patch(state, entry->addr, buffer) < 0) return -1;
+            free_token(entry->tok);
+            free(entry);
+        }
+        entry = next;
     }
 
-    return locctr;
+    return 0;
 }
 
 /**
- * @brief 심볼 테이블을 생성한다.
-*/
-void add_symbol(symbol **symbol_table, int *num_symbols, const char *label, int locctr, const char *csect) {
-    // 심볼 객체에 메모리 할당
-    symbol_table[*num_symbols] = (symbol*)malloc(sizeof(symbol));
-    if (symbol_table[*num_symbols] == NULL) {
-        fprintf(stderr, "메모리 할당 실패.\n");
-        return;
+ * @brief 이미 자리를 잡아 둔 주소의 오브젝트 코드를 고친다.
+ */
+static int one_pass_patch(one_pass_state *state, int addr, const char *hex) {
+    text_builder *text = &state->text;
+    int length = strlen(hex);
+
+    // 아직 출력하지 않은 T 레코드 안이면 그 자리를 직접 고친다
+    if (text->length > 0 && addr >= text->start_address &&
+        (addr - text->start_address) * 2 + length <= text->length) {
+        memcpy(text->data + (addr - text->start_address) * 2, hex, length);
+        state->result->patched_in_place++;
+        return 0;
     }
 
-    // 심볼 이름, 주소, 컨트롤 섹션 이름 할당
-    strcpy(symbol_table[*num_symbols]->name, label);
-    symbol_table[*num_symbols]->addr = locctr;
-    strcpy(symbol_table[*num_symbols]->csect, csect);
-    (*num_symbols)++;
+    // 이미 출력한 레코드는 같은 주소를 덮어쓰는 T 레코드로 고친다
+    text_builder patch;
+    memset(&patch, 0, sizeof(patch));
+    memcpy(patch.data, hex, length + 1);
+    patch.length = length;
+    patch.start_address = addr;
+    patch.out = state->out;
+    state->result->patch_records++;
+
+    return flush_text_record(NULL, state->section, &patch);
 }
 
 /**
- * @brief 리터럴 테이블을 생성한다.
-*/
-void add_literal(literal **literal_table, int *num_literals, const char *operand, int locctr) {
-    // 중복된 리터럴인지 확인 
-    if (*num_literals) {
-        for (int i = 0; i < *num_literals; i++) {
-            const char *literal = literal_table[i]->literal;
-            if (strcmp(literal, operand) == 0) {
-                return;
-            }
+ * @brief 주소가 정해지지 않은 현재 섹션의 리터럴을 LOCCTR 위치에 배치하고 출력한다.
+ */
+static int one_pass_place_literals(one_pass_state *state) {
+    for (int k = 0; k < *state->literal_table_length; k++) {
+        literal *lit = state->literal_table[k];
+        if (lit->addr != -1 || strcmp(lit->csect, state->csect) != 0) continue;
+
+        char buffer[sizeof(lit->literal) * 2 + 1];
+        lit->addr = state->locctr;
+        literal_object_code(buffer, lit->literal);
+        if (append_text_record(NULL, state->section, &state->text, lit->addr, buffer, -1) < 0) {
+            return -1;
+        }
+        state->locctr += literal_length(lit->literal);
+
+        if (one_pass_define(state, lit->literal) < 0) {
+            return -1;
         }
-    }
-    
-    // 리터럴 객체에 메모리 할당
-    literal_table[*num_literals] = (literal*)malloc(sizeof(literal));
-    if (literal_table[*num_literals] == NULL) {
-        fprintf(stderr, "메모리 할당 실패.\n");
-        return;
     }
 
-    // 리터럴 이름과 주소 할당
-    strcpy(literal_table[*num_literals]->literal, operand);
-    literal_table[*num_literals]->addr = locctr;
-    literal_table[*num_literals]->isProcessed = false;
-    (*num_literals)++;
+    return 0;
 }
 
 /**
- * @brief 기계어 목록 테이블에서 특정 기계어를 검색하여, 해당 기계어가 위치한
- * 인덱스를 반환한다.
- *
- * @param str 검색할 기계어 문자열
- * @param inst_table 기계어 목록 테이블 주소
- * @param inst_table_length 기계어 목록 테이블의 길이
- * @return 기계어의 인덱스 (해당 기계어가 없는 경우 -1)
+ * @brief 현재 컨트롤 섹션을 마친다. 남은 리터럴을 배치하고 M/E 레코드를 출력한
+ * 뒤, 먼저 써 둔 H 레코드의 길이와 D 레코드의 주소를 채운다.
  *
  * @details
- * 기계어 목록 테이블에서 특정 기계어를 검색하여, 해당 기계어가 위치한 인덱스를
- * 반환한다. '+JSUB'와 같은 문자열에 대한 처리는 자유롭게 처리한다.
+ * 섹션 안에서 정의되지 않은 심볼을 기다리는 체인이 남아 있거나 EXTDEF 심볼이
+ * 정의되지 않았으면 실패한다.
  */
-int search_opcode(const char *str, const inst *inst_table[],
-                  int inst_table_length) {
-    /* add your code */
-    if (str == NULL) {
-        fprintf(stderr, "입력된 문자열이 NULL을 가리킵니다.\n");
+static int one_pass_close_section(one_pass_state *state) {
+    FILE *out = state->out;
+
+    if (one_pass_place_literals(state) < 0) {
         return -1;
     }
-     
-    // 입력된 기계어 코드와 기계어 테이블을 비교하여 인덱스를 찾는다.
-    if (str[0] == '+') 
-        return search_opcode(str + 1, inst_table, inst_table_length);
-    
-    for (int i=0; i < inst_table_length; ++i) {
-        if (strcmp(str, inst_table[i]->str) == 0) 
-            return i;
+    if (state->chains != NULL) {
+        for (fixup_chain *chain = state->chains; chain != NULL; chain = chain->next) {
+            fprintf(stderr, "%s 섹션에서 정의되지 않은 심볼 %s을(를) 참조합니다.\n", state->csect, chain->name);
+        }
+        return -1;
+    }
+    if (flush_text_record(NULL, state->section, &state->text) < 0) {
+        return -1;
     }
 
-    // 기계어 코드를 찾지 못한 경우
-    return -1;
+    for (int i = 0; i < state->modify_count; i++) {
+        fprintf(out, "%s\n", state->modification[i]);
+    }
+    if (state->section == 0) {
+        fprintf(out, "E%06X\n", state->start_address);
+    } else {
+        fprintf(out, "E\n");
+    }
+
+    fseek(out, state->header_pos, SEEK_SET);
+    fprintf(out, "%06X", state->locctr);
+
+    for (int i = 0; i < state->extdef_count; i++) {
+        fseek(out, state->extdef_pos[i] + 1, SEEK_SET);
+        for (int j = 0; j < MAX_OPERAND_PER_INST && state->extdef[i][j][0] != '\0'; j++) {
+            symbol *sym = search_symbol(state->symbol_table, *state->symbol_table_length,
+                                        state->extdef[i][j], state->csect);
+            if (sym == NULL) {
+                fprintf(stderr, "%s 섹션에서 EXTDEF 심볼 %s이(가) 정의되지 않았습니다.\n",
+                        state->csect, state->extdef[i][j]);
+                return -1;
+            }
+            fprintf(out, "%-6s%06X", sym->name, sym->addr);
+        }
+    }
+
+    fseek(out, 0, SEEK_END);
+    state->header_pos = -1;
+
+    return 0;
 }
 
 /**
- * @brief 심볼 테이블에서 주어진 이름과 컨트롤 섹션의 심볼을 검색한다.
- * @return 찾은 심볼의 포인터, 찾지 못하면 NULL 반환
+ * @brief 현재 섹션에서 EXTREF로 선언한 심볼인지 확인한다.
  */
-symbol* search_symbol(symbol** symbol_table, int num_symbols, const char* name, const char* csect) {
-    for (int i = 0; i < num_symbols; i++) {
-        if (symbol_table[i] == NULL) continue;
-        if (symbol_table[i]->name[0] == '\0' || symbol_table[i]->csect[0] == '\0') continue;
-        if (strcmp(symbol_table[i]->name, name) == 0 && strcmp(symbol_table[i]->csect, csect) == 0) {
-            return symbol_table[i];  // 찾은 심볼의 포인터 반환
-        }
+static bool one_pass_is_extref(const one_pass_state *state, const char *name) {
+    for (int i = 0; i < state->extref_count; i++) {
+        if (strcmp(state->extref[i], name) == 0) return true;
     }
-    return NULL;  // 찾지 못하면 NULL 반환
+
+    return false;
 }
 
 /**
- * @brief 리터럴 테이블에서 주어진 이름의 리터럴을 검색한다.
- * @return 찾은 리터럴의 포인터, 찾지 못하면 NULL 반환
+ * @brief M 레코드 하나를 추가한다.
  */
-literal* search_literal(literal** literal_table, int num_literals, const char* name) {
-    for (int i = 0; i < num_literals; i++) {
-        if (strcmp(literal_table[i]->literal, name) == 0) {
-            return literal_table[i]; // 찾은 리터럴의 포인터 반환
-        }
+static int add_modification(char records[][MAX_OBJECT_CODE_STRING + 1], int *count, int addr,
+                            int half_bytes, char sign, const char *name) {
+    if (*count == MAX_RECORDS) {
+        fprintf(stderr, "M 레코드가 너무 많습니다. (최대 %d개)\n", MAX_RECORDS);
+        return -1;
     }
+    sprintf(records[(*count)++], "M%06X%02X%c%s", addr, half_bytes, sign, name);
 
-    return NULL; // 찾지 못하면 NULL 반환 
+    return 0;
 }
 
-
 /**
- * @brief 소스코드 명령어 앞에 OPCODE가 기록된 코드를 파일에 출력한다.
- * `output_dir`이 NULL인 경우 결과를 stdout으로 출력한다. 프로젝트 1에서는
- * 불필요하다.
- *
- * @param output_dir 코드를 저장할 파일 경로, 혹은 NULL
- * @param tokens 토큰 테이블 주소
- * @param tokens_length 토큰 테이블의 길이
- * @param inst_table 기계어 목록 테이블 주소
- * @param inst_table_length 기계어 목록 테이블의 길이
+ * @brief 모아 둔 T 레코드 데이터를 오브젝트 코드 구조체에 추가하고 비운다.
+ * `text->out`이 지정되어 있으면 구조체 대신 그 파일에 바로 쓴다.
  * @return 오류 코드 (정상 종료 = 0)
- *
- * @details
- * 소스코드 명령어 앞에 OPCODE가 기록된 코드를 파일에 출력한다. `output_dir`이
- * NULL인 경우 결과를 stdout으로 출력한다. 명세서에 주어진 출력 예시와 완전히
- * 동일할 필요는 없다. 프로젝트 1에서는 불필요하다.
  */
-int make_opcode_output(const char *output_dir, const token *tokens[],
-                       int tokens_length, const inst *inst_table[],
-                       int inst_table_length) {
-    /* add your code */
-}
+static int flush_text_record(object_code *obj_code, int section, text_builder *text) {
+    if (text->length == 0) {
+        return 0;
+    }
 
+    // --one-pass: 닫은 레코드는 보관하지 않고 바로 파일에 쓴다
+    if (text->out != NULL) {
+        fprintf(text->out, "T%06X%02X%s\n", text->start_address, text->length / 2, text->data);
+        text->data[0] = '\0';
+        text->length = 0;
+        return 0;
+    }
+
+    if (obj_code->text_count[section] == MAX_RECORDS) {
+        fprintf(stderr, "T 레코드가 너무 많습니다. (최대 %d개)\n", MAX_RECORDS);
+        return -1;
+    }
+
+    char *record = (char *)malloc(9 + text->length + 1);
+    if (record == NULL) {
+        fprintf(stderr, "메모리 할당 실패\n");
+        return -1;
+    }
+    sprintf(record, "T%06X%02X%s", text->start_address, text->length / 2, text->data);
+
+    // 재배치 비트마스크는 레코드와 함께 보관했다가 출력할 때 기록한다
+    if (option.relocation_bitmask) {
+        int mask_size = (text->length / 2 + 7) / 8;
+        unsigned char *mask = (unsigned char *)malloc(mask_size);
+        if (mask == NULL) {
+            fprintf(stderr, "메모리 할당 실패\n");
+            return -1;
+        }
+        memcpy(mask, text->mask, mask_size);
+        obj_code->text_mask[section][obj_code->text_count[section]] = mask;
+    }
+
+    obj_code->text[section][obj_code->text_count[section]++] = record;
+    text->data[0] = '\0';
+    text->length = 0;
+    memset(text->mask, 0, sizeof(text->mask));
+
+    return 0;
+}
 
 /**
- * @brief 어셈블리 코드을 위한 패스 2 과정을 수행한다.
- *
- * @param tokens 토큰 테이블 주소
- * @param tokens_length 토큰 테이블 길이
- * @param inst_table 기계어 목록 테이블 주소
- * @param inst_table_length 기계어 목록 테이블 길이
- * @param symbol_table 심볼 테이블 주소
- * @param symbol_table_length 심볼 테이블 길이
- * @param literal_table 리터럴 테이블 주소
- * @param literal_table_length 리터럴 테이블 길이
- * @param obj_code 오브젝트 코드에 대한 정보를 저장하는 구조체 주소
+ * @brief `addr`에 위치하는 오브젝트 코드(hex 문자열)를 T 레코드에 덧붙인다.
  * @return 오류 코드 (정상 종료 = 0)
  *
  * @details
- * 어셈블리 코드를 기계어 코드로 바꾸기 위한 패스2 과정을 수행한다. 패스 2의
- * 프로그램을 기계어로 바꾸는 작업은 라인 단위로 수행된다.
+ * 현재 레코드와 주소가 이어지지 않거나(RESB/RESW 등으로 비는 구간) 레코드
+ * 길이 제한(option.text_record_length)을 넘게 되면 현재 레코드를 먼저
+ * 내보낸다. 한 레코드보다 긴 데이터(긴 BYTE 상수 등)는 여러 레코드로 나눈다.
+ * `reloc_offset`이 0 이상이면 데이터의 해당 바이트에서 시작하는 3바이트 필드를
+ * 재배치 비트마스크에 표시한다.
  */
-int assem_pass2(const token *tokens[], int tokens_length,
-                const inst *inst_table[], int inst_table_length,
-                const symbol *symbol_table[], int symbol_table_length,
-                const literal *literal_table[], int literal_table_length,
-                object_code *obj_code) {
-    /* add your code */
-    char buffer[100]; // 오브젝트 코드를 임시로 저장할 버퍼
-    int start_address = 0; // 각 컨트롤 섹션의 시작 주소 
-    int csect_length = 0; // 각 컨트롤 섹션의 총 길이 
-    char current_csect[20] = "DEFAULT"; // 현재 컨트롤 섹션 이름, 초기값은 "DEFAULT"
-
-    // 임시 수정 가능한 symbol_table과 literal_table 생성
-    symbol **temp_symbol_table = malloc(symbol_table_length * sizeof(symbol*));
-    literal **temp_literal_table = malloc(literal_table_length * sizeof(literal*));
-    
-    // 원본 데이터를 임시 테이블에 복사
-    for (int i = 0; i < symbol_table_length; i++) {
-        temp_symbol_table[i] = (symbol*) symbol_table[i];
-    }
-    for (int j = 0; j < literal_table_length; j++) {
-        temp_literal_table[j] = (literal*) literal_table[j];
+static int append_text_record(object_code *obj_code, int section, text_builder *text,
+                              int addr, const char *hex, int reloc_offset) {
+    int hex_length = strlen(hex);
+    int limit = option.text_record_length * 2;
+
+    if (text->length > 0 &&
+        (addr != text->start_address + text->length / 2 || text->length + hex_length > limit)) {
+        if (flush_text_record(obj_code, section, text) < 0) return -1;
     }
 
-    // 오브젝트 코드 구조체 초기화
-    memset(obj_code, 0, sizeof(object_code));
-    obj_code->num_sections = 1;
+    while (hex_length > 0) {
+        if (text->length == limit) {
+            if (flush_text_record(obj_code, section, text) < 0) return -1;
+        }
+        if (text->length == 0) {
+            text->start_address = addr;
+        }
 
-    char text_record[MAX_OBJECT_CODE_LENGTH * 10] = "";
-    int text_record_length = 0;
-    int text_record_start_address = 0;
-    int current_locctr = 0;
-    int current_section = 0;
+        if (reloc_offset >= 0) {
+            int bit = text->length / 2 + reloc_offset;
+            text->mask[bit / 8] |= 0x80 >> (bit % 8);
+            reloc_offset = -1;
+        }
 
-    for (int i = 0; i < tokens_length; i++) {
-        const token *tok = tokens[i];
-        const char *operator = tok->operator;
-        if (operator == NULL) { continue; }
-        const char *operand = tok->operand[0];
-        int opcode;
-        int format;
-        int locctr;
-        buffer[0] = '\0'; // 임시 버퍼 초기화 
-        
-        current_locctr = locctr;
-        char prev_csect[20];
-        strcpy(prev_csect, current_csect);
-        locctr = process_token(tok, inst_table, inst_table_length, 
-                                temp_symbol_table, &symbol_table_length, 
-                                temp_literal_table, &literal_table_length, locctr, current_csect);
-        int nixbpe;
+        int chunk = hex_length < limit - text->length ? hex_length : limit - text->length;
+        memcpy(text->data + text->length, hex, chunk);
+        text->length += chunk;
+        text->data[text->length] = '\0';
 
-        // Header 레코드 작성
-        if (strcmp(operator,"CSECT") == 0 || strcmp(operator, "END") == 0) {
-            if (text_record_length > 0) {
-                sprintf(obj_code->text[current_section][obj_code->text_count[current_section]], "T%06X%02X%s", text_record_start_address, text_record_length / 2, text_record);
-                obj_code->text_count[current_section]++;
-                text_record[0] = '\0';
-                text_record_length = 0;
-            }
+        hex += chunk;
+        hex_length -= chunk;
+        addr += chunk / 2;
+    }
 
-            csect_length = (strcmp(operator, "CSECT") == 0) ? current_locctr : locctr;
-            sprintf(obj_code->header[current_section][obj_code->header_count[current_section]], "H%-6s%06X%06X", prev_csect, start_address, csect_length);
-            obj_code->header_count[current_section]++;
+    return 0;
+}
 
-            if (strcmp(operator, "CSECT") == 0) {
-                current_section++;
-                obj_code->num_sections++;
-                start_address = locctr;
-                text_record_start_address = locctr;
-            }
-        }
+/**
+ * @brief 섹션별로 인접한 T 레코드를 길이 제한 안에서 하나로 합친다.
+ * @return 오류 코드 (정상 종료 = 0)
+ *
+ * @details
+ * 주소가 바로 이어지는 레코드는 그대로 합친다. 두 레코드 사이가
+ * TEXT_GAP_FILL_LIMIT 바이트 이하로 비어 있으면(RESB/RESW) 빈 구간을 00으로
+ * 채워 합치는데, 그 구간에 다른 T 레코드가 걸쳐 있지 않은 경우에만 합친다.
+ * 예약 영역의 초기값은 정의되어 있지 않으므로 0으로 채워도 의미가 바뀌지
+ * 않는다.
+ */
+int pack_text_records(object_code *obj_code) {
+    int limit = option.text_record_length;
+    int starts[MAX_RECORDS];
+    int lengths[MAX_RECORDS];
 
-        // End 레코드 작성
-        if (strcmp(operator, "START") == 0 || strcmp(operator, "CSECT") == 0) {
-            if (strcmp(operator, "START") == 0) {
-                sprintf(obj_code->end[current_section][obj_code->end_count[current_section]], "E%06X", start_address);
-                obj_code->end_count[current_section]++;
-            } else {
-                sprintf(obj_code->end[current_section][obj_code->end_count[current_section]], "E");
-                obj_code->end_count[current_section]++;
-            }
+    for (int section = 0; section < obj_code->num_sections; section++) {
+        char **records = obj_code->text[section];
+        int count = obj_code->text_count[section];
+        int packed = 0;
+
+        // 병합 전 레코드들의 주소 범위 (빈 구간이 비어 있는지 확인할 때 사용)
+        for (int i = 0; i < count; i++) {
+            starts[i] = hex_field(records[i] + 1, 6);
+            lengths[i] = hex_field(records[i] + 7, 2);
         }
 
-        // Define 레코드 작성 
-        if (strcmp(operator, "EXTDEF") == 0) {
-            sprintf(obj_code->define[current_section][obj_code->define_count[current_section]], "D");
-            for (int i = 0; i < MAX_OPERAND_PER_INST && tok->operand[i] != NULL; i++) {
-                for (int j = 0; j < symbol_table_length; j++) {
-                    if (strcmp(symbol_table[j]->name, tok->operand[i]) == 0) {
-                        sprintf(obj_code->define[current_section][obj_code->define_count[current_section]] + strlen(obj_code->define[current_section][obj_code->define_count[current_section]]),
-                             "%s%06X", tok->operand[i], symbol_table[j]->addr);
-                        break;
+        for (int i = 0; i < count; i++) {
+            if (packed > 0) {
+                char *prev = records[packed - 1];
+                int prev_start = hex_field(prev + 1, 6);
+                int prev_length = hex_field(prev + 7, 2);
+                int prev_end = prev_start + prev_length;
+                int gap = starts[i] - prev_end;
+                bool legal = gap >= 0 && gap <= TEXT_GAP_FILL_LIMIT &&
+                             prev_length + gap + lengths[i] <= limit;
+
+                // 빈 구간을 채우는 경우 다른 레코드가 그 구간을 쓰지 않아야 한다
+                for (int j = 0; legal && gap > 0 && j < count; j++) {
+                    if (starts[j] < starts[i] && starts[j] + lengths[j] > prev_end) {
+                        legal = false;
                     }
                 }
-            }
-            obj_code->define_count[current_section]++;
-            continue;
-        }
-
-        // Reference 레코드 작성
-        if (strcmp(operator, "EXTREF") == 0) {
-            sprintf(obj_code->reference[current_section][obj_code->reference_count[current_section]], "R");
-            for (int j = 0; j < MAX_OPERAND_PER_INST && tok->operand[j]; j++) {
-                sprintf(obj_code->reference[current_section][obj_code->reference_count[current_section]] + strlen(obj_code->reference[current_section][obj_code->reference_count[current_section]]),
-                        "%-6s", tok->operand[j]);
-            }
-            obj_code->reference_count[current_section]++;
-            continue;
-        }
 
-        // Modification 레코드 생성
-        if (operator[0] == '+') {
-            sprintf(obj_code->modification[current_section][obj_code->modify_count[current_section]], "M%06X05+%s", current_locctr + 1, operand);
-            obj_code->modify_count[current_section]++;
-        } else if (strcmp(operator, "WORD") == 0) {
-            char *operand_copy = strdup(operand);
-            char *token = strtok(operand_copy, "+-");
-            bool first = true;
-            char* next_ptr;
-
-            while (token) {
-                if (first) {
-                    first = false;
-                    sprintf(obj_code->modification[current_section][obj_code->modify_count[current_section]], "M%06X06+%s", current_locctr, token);
-                    obj_code->modify_count[current_section]++;
-                } else {
-                    char op = operand[strlen(token)];
-                    if (op == '-') {
-                        sprintf(obj_code->modification[current_section][obj_code->modify_count[current_section]], "M%06X06-%s", current_locctr, token);
-                        obj_code->modify_count[current_section]++;
-                    } else {
-                        sprintf(obj_code->modification[current_section][obj_code->modify_count[current_section]], "M%06X06+%s", current_locctr, token);
-                        obj_code->modify_count[current_section]++;
+                if (legal) {
+                    char *merged = (char *)malloc(9 + (prev_length + gap + lengths[i]) * 2 + 1);
+                    if (merged == NULL) {
+                        fprintf(stderr, "메모리 할당 실패\n");
+                        return -1;
+                    }
+                    sprintf(merged, "T%06X%02X%s", prev_start, prev_length + gap + lengths[i], prev + 9);
+                    for (int k = 0; k < gap; k++) {
+                        strcat(merged, "00");
+                    }
+                    strcat(merged, records[i] + 9);
+
+                    // 재배치 비트마스크도 같은 위치에 맞추어 합친다
+                    unsigned char **masks = obj_code->text_mask[section];
+                    if (masks[packed - 1] != NULL) {
+                        int total = prev_length + gap + lengths[i];
+                        unsigned char *mask = (unsigned char *)calloc((total + 7) / 8, 1);
+                        if (mask == NULL) {
+                            fprintf(stderr, "메모리 할당 실패\n");
+                            return -1;
+                        }
+                        memcpy(mask, masks[packed - 1], (prev_length + 7) / 8);
+                        for (int k = 0; k < lengths[i]; k++) {
+                            if (masks[i][k / 8] & (0x80 >> (k % 8))) {
+                                int bit = prev_length + gap + k;
+                                mask[bit / 8] |= 0x80 >> (bit % 8);
+                            }
+                        }
+                        free(masks[packed - 1]);
+                        free(masks[i]);
+                        masks[packed - 1] = mask;
                     }
-                }
 
-                token = strtok(NULL, "+-");
+                    free(prev);
+                    free(records[i]);
+                    records[packed - 1] = merged;
+                    continue;
+                }
             }
-            
-            free(operand_copy);
-        }
 
-        // 지시어인 경우
-        if (strcmp(operator, "LTORG") == 0 || strcmp(operator, "END") ==0 ||
-            strcmp(operator, "BYTE") == 0 || strcmp(operator, "WORD") == 0) {
-            // 지시어의 오브젝트 코드를 생성 
-            generate_directive_object_code(buffer, tok, literal_table, literal_table_length);
-
-            // Text 레코드 추가
-            if (text_record_length + strlen(buffer) > 0x1E * 2) {
-                sprintf(obj_code->text[current_section][obj_code->text_count[current_section]], "T%06X%02X%s", text_record_start_address, text_record_length / 2, text_record);
-                obj_code->text_count[current_section]++;
-                text_record[0] = '\0';
-                text_record_length = 0;
-                text_record_start_address = current_locctr;
-            } else {
-                strcat(text_record, buffer);
-                text_record_length += strlen(buffer);
-            }
-            continue;
+            obj_code->text_mask[section][packed] = obj_code->text_mask[section][i];
+            records[packed++] = records[i];
         }
 
-        // 명령어인 경우: 정보 검색 
-        int index = search_opcode(operator, inst_table, inst_table_length);
-        if (index != -1) {
-            format = operator[0] == '+' ? 4 : inst_table[index]->format;
-            opcode = inst_table[index]->op;
-        } else {
-            continue;
+        for (int i = packed; i < count; i++) {
+            records[i] = NULL;
+            obj_code->text_mask[section][i] = NULL;
         }
-        
-        // 명령어 형식에 따라 오브젝트 코드 생성
-        switch (format) {
-            case 1:
-                sprintf(buffer, "%02X", opcode);
-                break;
-            case 2: 
-                // 레지스터 코드 처리 필요 
-                sprintf(buffer, "%02X%1X%1X", opcode, reg_code(tok->operand[0]), reg_code(tok->operand[1]));
-                break;
-            case 3: 
-            case 4: 
-                // TO-DO: 3, 4형식 명령어의 오브젝트 코드를 생성하는 함수 구현하기 
-                nixbpe = tok->nixbpe;
-                
-                format3or4(buffer, tok, opcode, format, locctr,
-                         symbol_table, symbol_table_length, literal_table, literal_table_length, current_csect);
+        obj_code->text_count[section] = packed;
+    }
 
-                break;
-            default: 
-                fprintf(stderr, "지원하지 않는 명령어 형식입니다. %d\n", format);
-                return -1;
-        }
+    return 0;
+}
 
-        // Text 레코드 추가
-        if (text_record_length + strlen(buffer) > 0x1E * 2 || buffer[0] == '\0') {
-            sprintf(obj_code->text[current_section][obj_code->text_count[current_section]], "T%06X%02X%s", text_record_start_address, text_record_length / 2, text_record);
-            obj_code->text_count[current_section]++;
-            text_record[0] = '\0';
-            text_record_length = 0;
-            text_record_start_address = current_locctr;
+/**
+ * @brief WORD 피연산자를 평가한 결과로 재배치 방법을 정한다.
+ * @return 재배치 비트를 표시할 위치 (0 = 재배치 필요, -1 = 불필요, -2 = 오류)
+ *
+ * @details
+ * 외부 참조 항은 부호와 함께 자신의 이름으로 M 레코드를 만든다. 섹션 상대
+ * 항의 부호 합이 +1이면 --reloc-bitmask 모드에서는 비트마스크로 재배치하고,
+ * 그 외에는 부호 합만큼 섹션 이름으로 M 레코드를 만든다. 상수 항과 절대값 심볼은
+ * 재배치하지 않는다.
+ */
+static int word_relocation(char records[][MAX_OBJECT_CODE_STRING + 1], int *count,
+                           const expression *expr, const expr_value *value, int addr,
+                           const char *current_csect) {
+    int relative_terms = value->relative;
+
+    for (int i = 0; i < expr->length; i++) {
+        if (value->external_sign[i] == 0) continue;
+        if (add_modification(records, count, addr, 6, value->external_sign[i] > 0 ? '+' : '-',
+                             expr->items[i].name) < 0) {
+            return -2;
         }
+    }
 
-        if (buffer[0] != '\0') {
-            strcat(text_record, buffer);
-            text_record_length += strlen(buffer);
+    if (relative_terms == 1 && option.relocation_bitmask) {
+        return 0;
+    }
+
+    // 섹션 상대 항이 상쇄되지 않은 경우 섹션 이름으로 재배치한다
+    for (; relative_terms != 0; relative_terms += (relative_terms > 0) ? -1 : 1) {
+        if (add_modification(records, count, addr, 6, relative_terms > 0 ? '+' : '-', current_csect) < 0) {
+            return -2;
         }
     }
 
-    // 마지막 텍스트 레코드 추가 (있는 경우)
-    if (text_record_length > 0) {
-        sprintf(obj_code->text[current_section][obj_code->text_count[current_section]], "T%06X%02X%s", text_record_start_address, text_record_length / 2, text_record);
-        obj_code->text_count[current_section]++;
+    return -1;
+}
+
+/**
+ * @brief 리터럴("=C'EOF'", "=X'05'")이 차지하는 바이트 수를 구한다.
+ */
+static int literal_length(const char *lit) {
+    char type = lit[1];                  // 리터럴 타입: 'C' 또는 'X'
+    int content_length = strlen(lit) - 4; // "=C'"와 마지막 따옴표 제외
+
+    if (type == 'X') {
+        // 16진수 리터럴, 두 글자당 1바이트 (홀수 길이는 반올림)
+        return (content_length + 1) / 2;
+    } else if (type == 'C') {
+        // 문자 리터럴, 각 글자당 1바이트
+        return content_length;
     }
 
     return 0;
-    
+}
+
+/**
+ * @brief 리터럴 하나의 오브젝트 코드(hex)를 `buffer`에 기록한다.
+ */
+static void literal_object_code(char *buffer, const char *lit) {
+    char type = lit[1];
+    const char *content = lit + 3;
+    size_t len = strlen(content) - 1;
+
+    buffer[0] = '\0';
+    if (type == 'C') {
+        // 문자 리터럴 처리 
+        for (size_t j = 0; j < len; j++) {
+            sprintf(buffer + j * 2, "%02X", (unsigned char)content[j]);
+        }
+    } else if (type == 'X') {
+        // 16진수 리터럴 처리
+        strncat(buffer, content, len);
+    }
 }
 
 // 특정 지시어의 오브젝트 코드를 생성하는 함수
-void generate_directive_object_code(char *buffer, const token *tok,
-                                    literal *literal_table[], int literal_table_length) {
+void generate_directive_object_code(char *buffer, const token *tok) {
     const char* operator = tok->operator;
     const char* operand = tok->operand[0];
 
-    // 리터럴 관련 처리
-    if (strcmp(operator, "LTORG") == 0 || strcmp(operator, "END") == 0) {
-        // 리터럴 테이블에 있는 모든 리터럴 처리
-        for (int i = 0; i < literal_table_length; i++) {
-            if (literal_table[i]->isProcessed) {
-                continue;
-            }
-
-            // 리터럴 타입 확인
-            const char* lit_value = literal_table[i]->literal;
-            char type = lit_value[1];
-
-            // 리터럴 값에서 실제 데이터 부분 추출
-            const char* content = lit_value + 3; 
-            size_t len = strlen(content) - 1;
-            if (type == 'C') {
-                // 문자 리터럴 처리 
-                for (size_t j = 0; j < len; j++) {
-                    char ch = content[j];
-                    char hex[3];
-                    snprintf(hex, sizeof(hex), "%02X", (unsigned char)ch);
-                    strncat(buffer, hex, sizeof(hex));
-                }
-            } else if (type == 'X') {
-                // 16진수 리터럴 처리
-                strncat(buffer, content, len);
-            }   
-            
-            literal_table[i]->isProcessed = true;
-            break;     
-        }
-    }
-
-    // BYTE, WORD 처리
-    else if (strcmp(operator, "BYTE") == 0) {
+    // BYTE, WORD 처리 (리터럴 풀은 assem_pass2에서 리터럴마다 literal_object_code로 만든다)
+    if (strcmp(operator, "BYTE") == 0) {
         // BYTE 처리
         char type = operand[0];
         if (type == 'C') {
-            // 문자 상수: ASCII 값으로 변환
+            // 문자 상수: ASCII 값으로 변환 (긴 상수에서도 선형 시간이 되도록 끝 위치에 바로 쓴다)
             const char* characters = operand + 2;
             size_t len = strlen(characters) - 1;
+            char *end = buffer + strlen(buffer);
             for (size_t j = 0; j < len; j++) {
-                char ch = characters[j];
-                char hex[3];
-                snprintf(hex, sizeof(hex), "%02X", (unsigned char)ch);
-                strcat(buffer, hex);
+                sprintf(end, "%02X", (unsigned char)characters[j]);
+                end += 2;
             }
         } else if (type == 'X') {
             // 16진수 상수: 직접 사용
@@ -1135,7 +5224,7 @@ void generate_directive_object_code(char *buffer, const token *tok,
     } else if (strcmp(operator, "WORD") == 0) {
         // WORD 처리
         if (!isdigit(operand[0])) {
-            operand = 0; // 기본값 = 0
+            operand = "0"; // 기본값 = 0
         }
         sprintf(buffer, "%06X", atoi(operand));
     }
@@ -1160,8 +5249,28 @@ int reg_code(const char *reg) {
     }
 }
 
+/**
+ * @brief 즉시값 피연산자가 심볼이 아닌 10진 상수("#5", "#-5", "#+7")이면 값을 구한다.
+ * @return 상수이면 true (값은 value에 저장)
+ */
+static bool immediate_constant(const char *operand, int *value) {
+    const char *digits;
+    char *end;
+
+    if (operand == NULL || operand[0] != '#') {
+        return false;
+    }
+    digits = (operand[1] == '-' || operand[1] == '+') ? operand + 2 : operand + 1;
+    if (!isdigit(digits[0])) {
+        return false;
+    }
+    *value = (int)strtol(operand + 1, &end, 10);
+    return *end == '\0';
+}
+
 // 3, 4형식 명령어의 오브젝트 코드를 생성하는 함수 
-void format3or4 (char *buffer, const token *tok, int opcode, int format, int locctr,
+// base는 BASE 지시어로 지정된 베이스 레지스터 값 (-1 = NOBASE)
+void format3or4 (char *buffer, const token *tok, int opcode, int format, int locctr, int base,
                 const symbol *symbol_table[], int symbol_table_length, 
                 const literal *literal_table[], int literal_table_length, const char *current_csect) {
     int nixbpe = tok->nixbpe;
@@ -1170,50 +5279,88 @@ void format3or4 (char *buffer, const token *tok, int opcode, int format, int loc
     bool isFormat4 = false;
     if (format == 4) 
         isFormat4 = true; 
-    
-    // 상위 3자리 코드 문자열 생성
-    int opcode_high = opcode >> 4;
-    int combine_bits = (opcode & 0x0F) | ((nixbpe >> 4) & 0x0F);
-    int nixbpe_low = nixbpe & 0x0F;
-
-    sprintf(buffer, "%1X%1X%1X", opcode_high, combine_bits, nixbpe_low);
 
     int address = 0;
+    int constant = 0;
+    bool local_symbol = false;
+    bool absolute_symbol = false; // EQU로 정의한 절대값 심볼은 재배치하지 않고 값을 그대로 쓴다
 
     // 피연산자 유형 확인 및 주소 가져오기
     if (strcmp(operator, "RSUB") == 0) {
         address = 0;
-        sprintf(buffer + 3, "%03X", address);
-        return;
-    } else if (isalpha(operand[0]) || operand[0] == '@') {
-        if (operand[0] == '@') {
+    } else if (isalpha(operand[0]) || ((operand[0] == '@' || operand[0] == '#') && isalpha(operand[1]))) {
+        if (operand[0] == '@' || operand[0] == '#') {
             operand = operand + 1;
         }
         // 심볼의 주소 찾기
         symbol* sym = search_symbol(symbol_table, symbol_table_length, operand, current_csect);
         if (sym != NULL) {
             address = sym->addr;
+            local_symbol = !sym->absolute;
+            absolute_symbol = sym->absolute;
         } 
     } else if (operand[0] == '=') {
         // 리터럴의 주소 찾기 
-        literal* lit = search_literal(literal_table, literal_table_length, operand);
+        literal* lit = search_literal(literal_table, literal_table_length, operand, current_csect);
         if (lit->addr != -1) {
             address = lit->addr;
+            local_symbol = true;
         }
     } 
 
     // 주소 계산 로직 
-    if (nixbpe & 0x01) {
-        // 4형식 명령어
-        address = 0;
-    } else if (!(nixbpe & 0x20) && (nixbpe & 0x10)) {
+    if (strcmp(operator, "RSUB") == 0) {
+        ;
+    } else if (nixbpe & 0x01) {
+        // 4형식 명령어: 외부 참조는 M 레코드로 채우므로 0, 같은 섹션의 심볼은
+        // 섹션 상대 주소를 기록하고 로더가 섹션의 로드 주소를 더한다
+        if (immediate_constant(operand, &constant)) {
+            // 음수는 20비트 2의 보수로 기록한다 (넘치면 opcode 비트를 덮어쓴다)
+            if (constant < -0x80000 || constant > 0xFFFFF) {
+                fprintf(stderr, "경고: %s %s의 값(%d)이 20비트 범위를 벗어납니다.\n",
+                        operator, operand, constant);
+            }
+            address = constant & 0xFFFFF;
+        } else if (!local_symbol && !absolute_symbol) {
+            address = 0;
+        }
+    } else if (absolute_symbol) {
+        // 절대값 심볼: PC 상대가 아닌 직접 주소(또는 즉시값)로 기록
+        nixbpe &= ~0x06;
+        if (address < 0 || address > 0xFFF) {
+            fprintf(stderr, "경고: %s %s의 값(%d)이 12비트 범위를 벗어납니다. (+ 사용)\n",
+                    operator, operand, address);
+        }
+        address &= 0xFFF;
+    } else if (!(nixbpe & 0x20) && (nixbpe & 0x10) && !(nixbpe & 0x02)) {
         // 직접 주소 방식: n=0, i=1인 경우 
         address = atoi(operand + 1);
+        if (address < 0 || address > 0xFFF) {
+            fprintf(stderr, "경고: %s %s의 값(%d)이 12비트 범위를 벗어납니다. (+ 또는 --relax 사용)\n",
+                    operator, operand, address);
+        }
+        address &= 0xFFF;
     } else if (nixbpe & 0x02 || nixbpe & 0x20) {
-        // PC 상대 주소 계산
-        address = (address - locctr) & 0xFFF;
+        // PC 상대 주소 계산, 범위를 벗어나면 BASE 상대 주소 사용
+        int displacement = address - locctr;
+        if (local_symbol && (displacement < -2048 || displacement > 2047)) {
+            if (base >= 0 && address - base >= 0 && address - base <= 0xFFF) {
+                nixbpe = (nixbpe & ~0x02) | 0x04; // b=1, p=0
+                displacement = address - base;
+            } else {
+                fprintf(stderr, "경고: %s %s의 PC 상대 변위(%d)가 12비트 범위를 벗어납니다. "
+                                "(+, BASE 또는 --relax 사용)\n", operator, operand, displacement);
+            }
+        }
+        address = displacement & 0xFFF;
     }  
 
+    // 상위 3자리 코드 문자열 생성
+    int opcode_high = opcode >> 4;
+    int combine_bits = (opcode & 0x0F) | ((nixbpe >> 4) & 0x0F);
+    int nixbpe_low = nixbpe & 0x0F;
+
+    sprintf(buffer, "%1X%1X%1X", opcode_high, combine_bits, nixbpe_low);
     sprintf(buffer + 3, isFormat4 ? "%05X" : "%03X", address);
 }
 
@@ -1262,11 +5409,431 @@ int make_symbol_table_output(const char *symbol_table_dir,
         fprintf(fp, "%s\t%X\t%s\n", symbol_table[i]->name, symbol_table[i]->addr, symbol_table[i]->csect);
     }
 
+    if (fp != stdout) {
+        run_stats.bytes_written += ftell(fp);
+    }
     fclose(fp);
 
     return 0;
 }
 
+/**
+ * @brief 컨트롤 섹션별 크기 요약을 출력한다. (--size-only)
+ *
+ * @param summary_dir 출력 파일 경로 (NULL이면 표준 출력)
+ * @param source 요약의 각 줄 앞에 붙일 소스 파일 이름
+ * @return 오류 코드 (정상 종료 = 0)
+ *
+ * @details
+ * 컨트롤 섹션마다 한 줄을 탭으로 구분하여 출력한다. 목록은 쉼표로 구분하고 비어
+ * 있으면 '-'를 쓴다.
+ *    ==================================================================
+ *     | 소스 | 섹션 이름 | 시작 주소 | 길이 | EXTDEF 이름=주소 | EXTREF 이름 |
+ *    ==================================================================
+ * 섹션 길이는 패스 2와 같이 임시 테이블로 LOCCTR를 한 번 더 계산하여 구하지만
+ * 명령어를 인코딩하거나 레코드를 만들지는 않는다.
+ */
+int make_size_summary_output(const char *summary_dir, const char *source,
+                             const token *tokens[], int tokens_length,
+                             const inst *inst_table[], int inst_table_length,
+                             const symbol *symbol_table[], int symbol_table_length,
+                             const literal *literal_table[], int literal_table_length) {
+    FILE *fp;
+
+    if (summary_dir == NULL) {
+        fp = stdout;
+    } else {
+        fp = fopen(summary_dir, "w");
+        if (fp == NULL) {
+            perror("크기 요약 파일 열기 실패\n");
+            return -1;
+        }
+    }
+
+    // process_token이 라벨을 다시 추가하므로 토큰 수만큼 여유 공간을 둔다
+    int temp_symbol_table_length = symbol_table_length;
+    int temp_literal_table_length = literal_table_length;
+    symbol **temp_symbol_table = malloc((symbol_table_length + tokens_length) * sizeof(symbol *));
+    literal **temp_literal_table = malloc((literal_table_length + tokens_length) * sizeof(literal *));
+    int err = 0;
+    if (temp_symbol_table == NULL || temp_literal_table == NULL) {
+        fprintf(stderr, "메모리 할당 실패\n");
+        err = -1;
+    } else {
+        memcpy(temp_symbol_table, symbol_table, symbol_table_length * sizeof(symbol *));
+        memcpy(temp_literal_table, literal_table, literal_table_length * sizeof(literal *));
+    }
+
+    char current_csect[20] = "DEFAULT";
+    int locctr = 0;
+    int start_address = 0;
+    int first = 0;
+    for (int i = 0; i <= tokens_length && err == 0; i++) {
+        const char *operator = i < tokens_length ? tokens[i]->operator : NULL;
+
+        // 다음 CSECT를 처리하기 직전의 LOCCTR가 이전 섹션의 끝 주소이다
+        if (i == tokens_length || (operator != NULL && strcmp(operator, "CSECT") == 0 && i > first)) {
+            err = print_section_summary(fp, source, tokens, first, i, current_csect, start_address,
+                                        locctr - start_address, symbol_table, symbol_table_length);
+            first = i;
+        }
+        if (i == tokens_length || err < 0) break;
+
+        locctr = process_token(tokens[i], inst_table, inst_table_length,
+                               temp_symbol_table, &temp_symbol_table_length,
+                               temp_literal_table, &temp_literal_table_length, locctr, current_csect);
+        if (locctr < 0) {
+            err = -1;
+        } else if (operator != NULL && (strcmp(operator, "START") == 0 || strcmp(operator, "CSECT") == 0)) {
+            start_address = locctr;
+        }
+    }
+
+    // process_token이 임시 테이블에 새로 추가한 항목만 해제한다
+    for (int i = symbol_table_length; i < temp_symbol_table_length; i++) {
+        free(temp_symbol_table[i]);
+    }
+    for (int i = literal_table_length; i < temp_literal_table_length; i++) {
+        free(temp_literal_table[i]);
+    }
+    free(temp_symbol_table);
+    free(temp_literal_table);
+
+    if (fp != stdout) {
+        run_stats.bytes_written += ftell(fp);
+        fclose(fp);
+    }
+
+    return err;
+}
+
+/**
+ * @brief 컨트롤 섹션 하나(tokens[first] ~ tokens[last - 1])의 크기 요약 한 줄을 출력한다.
+ */
+static int print_section_summary(FILE *fp, const char *source, const token *tokens[], int first, int last,
+                                 const char *csect, int start_address, int length,
+                                 const symbol *symbol_table[], int symbol_table_length) {
+    int exports = 0;
+    int imports = 0;
+
+    fprintf(fp, "%s\t%s\t%06X\t%06X\t", source, csect, start_address, length);
+
+    for (int i = first; i < last; i++) {
+        if (tokens[i]->operator == NULL || strcmp(tokens[i]->operator, "EXTDEF") != 0) continue;
+        for (int j = 0; j < MAX_OPERAND_PER_INST && tokens[i]->operand[j] != NULL; j++) {
+            const char *name = tokens[i]->operand[j];
+            const symbol *sym = search_symbol((symbol **)symbol_table, symbol_table_length, name, csect);
+            if (sym == NULL) {
+                fprintf(stderr, "\nEXTDEF 심볼 %s을(를) 섹션 %s에서 찾을 수 없습니다.\n", name, csect);
+                return -1;
+            }
+            fprintf(fp, "%s%s=%06X", exports++ > 0 ? "," : "", name, sym->addr);
+        }
+    }
+    fprintf(fp, "%s\t", exports == 0 ? "-" : "");
+
+    for (int i = first; i < last; i++) {
+        if (tokens[i]->operator == NULL || strcmp(tokens[i]->operator, "EXTREF") != 0) continue;
+        for (int j = 0; j < MAX_OPERAND_PER_INST && tokens[i]->operand[j] != NULL; j++) {
+            fprintf(fp, "%s%s", imports++ > 0 ? "," : "", tokens[i]->operand[j]);
+        }
+    }
+    fprintf(fp, "%s\n", imports == 0 ? "-" : "");
+
+    return 0;
+}
+
+/**
+ * @brief 해제되지 않은 바이트가 많은 할당 위치가 앞에 오도록 비교한다 (qsort용).
+ */
+static int compare_alloc_sites(const void *a, const void *b) {
+    const alloc_site *x = *(const alloc_site *const *)a;
+    const alloc_site *y = *(const alloc_site *const *)b;
+
+    if (x->live_bytes != y->live_bytes) {
+        return x->live_bytes < y->live_bytes ? 1 : -1;
+    }
+    return x->bytes < y->bytes ? 1 : x->bytes > y->bytes ? -1 : 0;
+}
+
+/**
+ * @brief 단계별 시간과 카운터를 JSON 파일로 출력한다. (--stats)
+ *
+ * @param stats_dir 통계를 저장할 파일 경로, 혹은 NULL (stdout)
+ * @param stats 출력할 통계
+ * @return 오류 코드 (정상 종료 = 0)
+ *
+ * @details
+ * CI가 단계별로 회귀를 추적할 수 있도록 단계 이름을 키로 하는 객체에 수행 순서대로
+ * 나노초 단위 시간을 기록한다. 예시는 다음과 같다.
+ *    {"phases_ns": {"init_inst_table": 41000, "init_input": 12000, ...},
+ *     "total_ns": 912000,
+ *     "counters": {"lines": 58, "tokens": 58, ...}}
+ */
+int make_stats_output(const char *stats_dir, const assem_stats *stats) {
+    FILE *fp;
+
+    if (stats_dir == NULL) {
+        fp = stdout;
+    } else {
+        fp = fopen(stats_dir, "w");
+        if (fp == NULL) {
+            perror("통계 파일 열기 실패\n");
+            return -1;
+        }
+    }
+
+    fprintf(fp, "{\n  \"phases_ns\": {");
+    for (int i = 0; i < stats->phase_count; i++) {
+        fprintf(fp, "%s\n    \"%s\": %lld", i > 0 ? "," : "",
+                stats->phases[i].name, stats->phases[i].nanoseconds);
+    }
+    fprintf(fp, "%s},\n", stats->phase_count > 0 ? "\n  " : "");
+    fprintf(fp, "  \"total_ns\": %lld,\n", stats->total_nanoseconds);
+    fprintf(fp, "  \"counters\": {\n");
+    fprintf(fp, "    \"lines\": %ld,\n", stats->lines);
+    fprintf(fp, "    \"tokens\": %ld,\n", stats->tokens);
+    fprintf(fp, "    \"symbols\": %ld,\n", stats->symbols);
+    fprintf(fp, "    \"literals\": %ld,\n", stats->literals);
+    fprintf(fp, "    \"opcode_lookups\": %ld,\n", stats->opcode_lookups);
+    fprintf(fp, "    \"symbol_lookups\": %ld,\n", stats->symbol_lookups);
+    fprintf(fp, "    \"literal_lookups\": %ld,\n", stats->literal_lookups);
+    fprintf(fp, "    \"allocations\": %ld,\n", stats->allocations);
+    fprintf(fp, "    \"allocated_bytes\": %lld,\n", stats->allocated_bytes);
+    fprintf(fp, "    \"bytes_written\": %lld\n", stats->bytes_written);
+    fprintf(fp, "  }");
+
+    // --perf-counters: 단계별 하드웨어 카운터와 소스 라인당 값 (열지 못한 카운터는 null)
+    if (option.perf_counters) {
+        fprintf(fp, ",\n  \"hardware_counters\": {");
+        for (int i = 0; i < stats->phase_count; i++) {
+            fprintf(fp, "%s\n    \"%s\": {", i > 0 ? "," : "", stats->phases[i].name);
+            for (int j = 0; j < PERF_COUNTER_COUNT; j++) {
+                if (stats->counter_available[j]) {
+                    fprintf(fp, "%s\"%s\": %lld", j > 0 ? ", " : "", perf_counter_names[j],
+                            stats->phases[i].counters[j]);
+                } else {
+                    fprintf(fp, "%s\"%s\": null", j > 0 ? ", " : "", perf_counter_names[j]);
+                }
+            }
+            fprintf(fp, ",\n      \"per_line\": {");
+            for (int j = 0; j < PERF_COUNTER_COUNT; j++) {
+                if (stats->counter_available[j] && stats->lines > 0) {
+                    fprintf(fp, "%s\"%s\": %.2f", j > 0 ? ", " : "", perf_counter_names[j],
+                            (double)stats->phases[i].counters[j] / stats->lines);
+                } else {
+                    fprintf(fp, "%s\"%s\": null", j > 0 ? ", " : "", perf_counter_names[j]);
+                }
+            }
+            fprintf(fp, "}}");
+        }
+        fprintf(fp, "%s}", stats->phase_count > 0 ? "\n  " : "");
+    }
+
+    // --memory: 단계가 끝난 시점의 RSS와 테이블별 논리 바이트 수 (소스 라인당 값은 전체 라인 수 기준)
+    if (option.memory) {
+        fprintf(fp, ",\n  \"memory\": {\n");
+        fprintf(fp, "    \"sizes\": {\"token\": %zu, \"symbol\": %zu, \"literal\": %zu, "
+                    "\"object_code\": %zu},\n",
+                sizeof(token), sizeof(symbol), sizeof(literal), sizeof(object_code));
+        fprintf(fp, "    \"phases\": {");
+        for (int i = 0; i < stats->phase_count; i++) {
+            const memory_snapshot *m = &stats->phases[i].memory;
+            long long total = m->tokens + m->strings + m->symbols + m->literals + m->records;
+
+            fprintf(fp, "%s\n      \"%s\": {", i > 0 ? "," : "", stats->phases[i].name);
+            if (m->rss_kb >= 0) {
+                fprintf(fp, "\"rss_kb\": %ld, ", m->rss_kb);
+            } else {
+                fprintf(fp, "\"rss_kb\": null, ");
+            }
+            if (m->peak_rss_kb >= 0) {
+                fprintf(fp, "\"peak_rss_kb\": %ld,", m->peak_rss_kb);
+            } else {
+                fprintf(fp, "\"peak_rss_kb\": null,");
+            }
+            fprintf(fp, "\n        \"tokens\": %lld, \"strings\": %lld, \"symbols\": %lld, "
+                        "\"literals\": %lld, \"records\": %lld, \"records_used\": %lld,",
+                    m->tokens, m->strings, m->symbols, m->literals, m->records, m->records_used);
+            fprintf(fp, "\n        \"total\": %lld, \"bytes_per_line\": %.2f}",
+                    total, stats->lines > 0 ? (double)total / stats->lines : 0.0);
+        }
+        fprintf(fp, "%s}\n  }", stats->phase_count > 0 ? "\n    " : "");
+    }
+
+    // --alloc-sites: 할당 위치별 기록을 해제되지 않은 바이트가 많은 순서로 출력한다
+    if (option.alloc_sites) {
+        const alloc_site *sites[MAX_ALLOC_SITES];
+        long long live_bytes = 0;
+        long live = 0;
+
+        for (int i = 0; i < stats->alloc_site_count; i++) {
+            sites[i] = &stats->alloc_sites[i];
+            live += sites[i]->live;
+            live_bytes += sites[i]->live_bytes;
+        }
+        qsort(sites, stats->alloc_site_count, sizeof(sites[0]), compare_alloc_sites);
+
+        fprintf(fp, ",\n  \"allocation_sites\": {\n");
+        fprintf(fp, "    \"leaked\": %ld,\n", live);
+        fprintf(fp, "    \"leaked_bytes\": %lld,\n", live_bytes);
+        fprintf(fp, "    \"leaked_bytes_per_line\": %.2f,\n",
+                stats->lines > 0 ? (double)live_bytes / stats->lines : 0.0);
+        fprintf(fp, "    \"sites\": [");
+        for (int i = 0; i < stats->alloc_site_count; i++) {
+            fprintf(fp, "%s\n      {\"site\": \"%s:%d\", \"function\": \"%s\", "
+                        "\"allocations\": %ld, \"bytes\": %lld, \"frees\": %ld, "
+                        "\"leaked\": %ld, \"leaked_bytes\": %lld, \"leaked_bytes_per_line\": %.2f}",
+                    i > 0 ? "," : "", sites[i]->file, sites[i]->line, sites[i]->function,
+                    sites[i]->allocations, sites[i]->bytes, sites[i]->frees, sites[i]->live,
+                    sites[i]->live_bytes,
+                    stats->lines > 0 ? (double)sites[i]->live_bytes / stats->lines : 0.0);
+        }
+        fprintf(fp, "%s]\n  }", stats->alloc_site_count > 0 ? "\n    " : "");
+    }
+    fprintf(fp, "\n}\n");
+
+    if (fp != stdout) {
+        fclose(fp);
+    }
+
+    return 0;
+}
+
+/**
+ * @brief 컨트롤 섹션별 명령어 통계를 JSON 파일로 출력한다. `module_stats_dir`이
+ * NULL인 경우 결과를 stdout으로 출력한다.
+ *
+ * @param module_stats_dir 통계를 저장할 파일 경로, 혹은 NULL
+ * @param obj_code assem_pass2가 만든 오브젝트 코드 (섹션별 통계 포함)
+ * @param inst_table 기계어 목록 테이블 (명령어 이름)
+ * @param inst_table_length 기계어 목록 테이블 길이
+ * @return 오류 코드 (정상 종료 = 0)
+ *
+ * @details
+ * 섹션 이름은 H 레코드에서 읽고, 수정 레코드 수는 M 레코드 수를 그대로 쓴다.
+ * 명령어별 수는 한 번 이상 쓰인 명령어만 기계어 목록 순서대로 출력한다.
+ */
+int make_module_stats_output(const char *module_stats_dir, const object_code *obj_code,
+                             const inst *inst_table[], int inst_table_length) {
+    FILE *fp;
+
+    if (module_stats_dir == NULL) {
+        fp = stdout;
+    } else {
+        fp = fopen(module_stats_dir, "w");
+        if (fp == NULL) {
+            perror("명령어 통계 파일 열기 실패\n");
+            return -1;
+        }
+    }
+
+    fprintf(fp, "{\n  \"modules\": [");
+    for (int s = 0; s < obj_code->num_sections; s++) {
+        const module_stats *module = &obj_code->modules[s];
+        char name[7] = "";
+        int instructions = 0;
+        bool first = true;
+
+        if (obj_code->header_count[s] > 0) {
+            sscanf(obj_code->header[s][0] + 1, "%6s", name);
+        }
+        for (int f = 1; f <= 4; f++) {
+            instructions += module->formats[f];
+        }
+
+        fprintf(fp, "%s\n    {\n      \"name\": \"%s\",\n", s > 0 ? "," : "", name);
+        fprintf(fp, "      \"instructions\": %d,\n", instructions);
+        fprintf(fp, "      \"mnemonics\": {");
+        for (int i = 0; i < inst_table_length; i++) {
+            if (module->mnemonics[i] > 0) {
+                fprintf(fp, "%s\"%s\": %d", first ? "" : ", ", inst_table[i]->str, module->mnemonics[i]);
+                first = false;
+            }
+        }
+        fprintf(fp, "},\n");
+        fprintf(fp, "      \"formats\": {\"1\": %d, \"2\": %d, \"3\": %d, \"4\": %d},\n",
+                module->formats[1], module->formats[2], module->formats[3], module->formats[4]);
+        fprintf(fp, "      \"addressing_modes\": {\"immediate\": %d, \"indirect\": %d, \"simple\": %d, "
+                    "\"indexed\": %d, \"pc_relative\": %d, \"base_relative\": %d, \"extended\": %d, "
+                    "\"direct\": %d},\n",
+                module->immediate, module->indirect, module->simple, module->indexed,
+                module->pc_relative, module->base_relative, module->extended, module->direct);
+        fprintf(fp, "      \"literal_refs\": %d,\n", module->literal_refs);
+        fprintf(fp, "      \"literals\": %d,\n", module->literals);
+        fprintf(fp, "      \"modification_records\": %d,\n", obj_code->modify_count[s]);
+        fprintf(fp, "      \"bitmask_relocations\": %d\n    }", module->bitmask_relocations);
+    }
+    fprintf(fp, "%s]\n}\n", obj_code->num_sections > 0 ? "\n  " : "");
+
+    if (fp != stdout) {
+        run_stats.bytes_written += ftell(fp);
+        fclose(fp);
+    }
+
+    return 0;
+}
+
+/**
+ * @brief 트레이스 버퍼의 구간을 Chrome 트레이스 JSON 파일로 출력한다. `trace_dir`이
+ * NULL인 경우 결과를 stdout으로 출력한다.
+ *
+ * @param trace_dir 트레이스를 저장할 파일 경로, 혹은 NULL
+ * @param buffers 스레드별 트레이스 버퍼 목록
+ * @param buffer_count 버퍼 수
+ * @param origin_ns 트레이스의 기준 시각 (이 시각을 0 µs로 출력한다)
+ * @return 오류 코드 (정상 종료 = 0)
+ *
+ * @details
+ * 각 구간은 "ph": "X" 이벤트로 출력하므로 chrome://tracing이나 Perfetto에서 단계 안에
+ * 컨트롤 섹션 구간이 겹쳐 보인다. 이름의 따옴표와 역슬래시, 제어 문자는 이스케이프한다.
+ */
+int make_trace_output(const char *trace_dir, const trace_buffer *buffers[], int buffer_count,
+                      long long origin_ns) {
+    FILE *fp;
+
+    if (trace_dir == NULL) {
+        fp = stdout;
+    } else {
+        fp = fopen(trace_dir, "w");
+        if (fp == NULL) {
+            perror("트레이스 파일 열기 실패\n");
+            return -1;
+        }
+    }
+
+    fprintf(fp, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+    fprintf(fp, "  {\"name\": \"process_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": 0, "
+                "\"args\": {\"name\": \"my_assembler\"}}");
+    for (int b = 0; b < buffer_count; b++) {
+        for (int i = 0; i < buffers[b]->count; i++) {
+            const trace_event *event = &buffers[b]->events[i];
+
+            fprintf(fp, ",\n  {\"name\": \"");
+            for (const char *c = event->name; *c != '\0'; c++) {
+                if (*c == '"' || *c == '\\') {
+                    fprintf(fp, "\\%c", *c);
+                } else if ((unsigned char)*c < 0x20) {
+                    fprintf(fp, "\\u%04x", *c);
+                } else {
+                    fputc(*c, fp);
+                }
+            }
+            fprintf(fp, "\", \"cat\": \"%s\", \"ph\": \"X\", \"ts\": %.3f, \"dur\": %.3f, "
+                        "\"pid\": 1, \"tid\": %d}",
+                    event->category, (event->start_ns - origin_ns) / 1000.0,
+                    event->duration_ns / 1000.0, buffers[b]->tid);
+        }
+    }
+    fprintf(fp, "\n]}\n");
+
+    if (fp != stdout) {
+        fclose(fp);
+    }
+
+    return 0;
+}
+
 /**
  * @brief 리터럴 테이블을 파일로 출력한다. `literal_table_dir`이 NULL인 경우
  * 결과를 stdout으로 출력한다.
@@ -1299,6 +5866,9 @@ int make_literal_table_output(const char *literal_table_dir,
         fprintf(fp, "%s\t%X\n", literal_table[i]->literal, literal_table[i]->addr);
     }
 
+    if (fp != stdout) {
+        run_stats.bytes_written += ftell(fp);
+    }
     fclose(fp);
 
     return 0;
@@ -1347,9 +5917,21 @@ int make_objectcode_output(const char *objectcode_dir,
             fprintf(fp, "%s\n", obj_code->reference[section][i]);
         }
 
-        // Text 레코드 출력
+        // Text 레코드 출력 (재배치 비트마스크가 있으면 B 레코드로 출력)
         for (int i = 0; i < obj_code->text_count[section]; i++) {
-            fprintf(fp, "%s\n", obj_code->text[section][i]);
+            const char *record = obj_code->text[section][i];
+            const unsigned char *mask = obj_code->text_mask[section][i];
+            if (mask == NULL) {
+                fprintf(fp, "%s\n", record);
+                continue;
+            }
+
+            int length = hex_field(record + 7, 2);
+            fprintf(fp, "%c%.8s", BITMASK_TEXT_RECORD, record + 1);
+            for (int digit = 0; digit < (length + 3) / 4; digit++) {
+                fprintf(fp, "%1X", (mask[digit / 2] >> ((digit % 2) ? 0 : 4)) & 0x0F);
+            }
+            fprintf(fp, "%s\n", record + 9);
         }
 
         // Modification 레코드 출력
@@ -1364,8 +5946,256 @@ int make_objectcode_output(const char *objectcode_dir,
     }
 
     if (objectcode_dir != NULL) {
+        run_stats.bytes_written += ftell(fp);
+        fclose(fp);
+    }
+
+    return 0;
+}
+/**
+ * @brief 오브젝트 코드를 바이너리 형식의 파일로 출력한다.
+ *
+ * @param objectcode_dir 오브젝트 코드를 저장할 파일 경로
+ * @param obj_code 오브젝트 코드에 대한 정보를 담고 있는 구조체 주소
+ * @return 오류 코드 (정상 종료 = 0)
+ *
+ * @details
+ * make_objectcode_output과 같은 순서로 레코드를 출력하되, 주소와 길이는
+ * varint로, T 레코드의 데이터는 hex 문자열 대신 원본 바이트로 기록한다.
+ * 외부 심볼 이름은 N 레코드에 모아 한 번씩만 기록한다. 형식은
+ * my_assembler_20221846.h에 정리되어 있다.
+ */
+int make_objectcode_binary_output(const char *objectcode_dir,
+                                  const object_code *obj_code) {
+    FILE *fp;
+    byte_buffer body = {NULL, 0, 0};
+    byte_buffer payload = {NULL, 0, 0};
+    byte_buffer names_record = {NULL, 0, 0};
+    byte_buffer file_header = {NULL, 0, 0};
+    char (*names)[MAX_OBJECT_CODE_STRING + 1] = malloc(MAX_TABLE_LENGTH * sizeof(*names));
+    int name_count = 0;
+    int err = 0;
+
+    if (names == NULL) {
+        fprintf(stderr, "메모리 할당 실패\n");
+        return -1;
+    }
+
+    for (int section = 0; section < obj_code->num_sections && err == 0; section++) {
+        // Header 레코드: H이름(6)시작(6)길이(6)
+        for (int i = 0; i < obj_code->header_count[section]; i++) {
+            const char *record = obj_code->header[section][i];
+            char name[7];
+            sscanf(record + 1, "%6[^ ]", name);
+
+            payload.length = 0;
+            err |= buffer_put_varint(&payload, intern_name(names, &name_count, name));
+            err |= buffer_put_varint(&payload, hex_field(record + 7, 6));
+            err |= buffer_put_varint(&payload, hex_field(record + 13, 6));
+            err |= buffer_put_record(&body, HEADER_RECORD, &payload);
+        }
+
+        // Define 레코드: D{이름(6)주소(6)}
+        for (int i = 0; i < obj_code->define_count[section]; i++) {
+            const char *record = obj_code->define[section][i];
+            int count = (strlen(record) - 1) / 12;
+
+            payload.length = 0;
+            err |= buffer_put_varint(&payload, count);
+            for (int j = 0; j < count; j++) {
+                char name[7];
+                sscanf(record + 1 + j * 12, "%6[^ ]", name);
+                err |= buffer_put_varint(&payload, intern_name(names, &name_count, name));
+                err |= buffer_put_varint(&payload, hex_field(record + 7 + j * 12, 6));
+            }
+            err |= buffer_put_record(&body, DEFINE_RECORD, &payload);
+        }
+
+        // Reference 레코드: R{이름(6)}
+        for (int i = 0; i < obj_code->reference_count[section]; i++) {
+            const char *record = obj_code->reference[section][i];
+            int count = (strlen(record) - 1 + 5) / 6;
+
+            payload.length = 0;
+            err |= buffer_put_varint(&payload, count);
+            for (int j = 0; j < count; j++) {
+                char name[7];
+                sscanf(record + 1 + j * 6, "%6[^ ]", name);
+                err |= buffer_put_varint(&payload, intern_name(names, &name_count, name));
+            }
+            err |= buffer_put_record(&body, REFERENCE_RECORD, &payload);
+        }
+
+        // Text 레코드: T시작(6)길이(2)데이터
+        for (int i = 0; i < obj_code->text_count[section]; i++) {
+            const char *record = obj_code->text[section][i];
+            int length = hex_field(record + 7, 2);
+
+            const unsigned char *mask = obj_code->text_mask[section][i];
+
+            payload.length = 0;
+            err |= buffer_put_varint(&payload, hex_field(record + 1, 6));
+            if (mask != NULL) {
+                err |= buffer_put_varint(&payload, length);
+                err |= buffer_put(&payload, mask, (length + 7) / 8);
+            }
+            for (int j = 0; j < length; j++) {
+                unsigned char byte = (unsigned char)hex_field(record + 9 + j * 2, 2);
+                err |= buffer_put(&payload, &byte, 1);
+            }
+            err |= buffer_put_record(&body, mask != NULL ? BITMASK_TEXT_RECORD : TEXT_RECORD, &payload);
+        }
+
+        // Modification 레코드: M주소(6)길이(2)부호(1)이름
+        for (int i = 0; i < obj_code->modify_count[section]; i++) {
+            const char *record = obj_code->modification[section][i];
+            unsigned char half_bytes = (unsigned char)hex_field(record + 7, 2);
+            int name_index = intern_name(names, &name_count, record + 10);
+
+            payload.length = 0;
+            err |= buffer_put_varint(&payload, hex_field(record + 1, 6));
+            err |= buffer_put(&payload, &half_bytes, 1);
+            err |= buffer_put_varint(&payload, (name_index << 1) | (record[9] == '-'));
+            err |= buffer_put_record(&body, MODIFY_RECORD, &payload);
+        }
+
+        // End 레코드: E[실행 주소(6)]
+        for (int i = 0; i < obj_code->end_count[section]; i++) {
+            const char *record = obj_code->end[section][i];
+            unsigned char has_addr = record[1] != '\0';
+
+            payload.length = 0;
+            err |= buffer_put(&payload, &has_addr, 1);
+            if (has_addr) {
+                err |= buffer_put_varint(&payload, hex_field(record + 1, 6));
+            }
+            err |= buffer_put_record(&body, END_RECORD, &payload);
+        }
+    }
+
+    // 이름 테이블(N 레코드)은 모든 레코드를 만든 뒤 파일 맨 앞에 기록한다
+    payload.length = 0;
+    err |= buffer_put_varint(&payload, name_count);
+    for (int i = 0; i < name_count; i++) {
+        unsigned char length = (unsigned char)strlen(names[i]);
+        err |= buffer_put(&payload, &length, 1);
+        err |= buffer_put(&payload, names[i], length);
+    }
+    err |= buffer_put_record(&names_record, NAME_RECORD, &payload);
+
+    unsigned char version = BINARY_OBJECT_VERSION;
+    err |= buffer_put(&file_header, BINARY_OBJECT_MAGIC, 4);
+    err |= buffer_put(&file_header, &version, 1);
+
+    if (err != 0 || name_count < 0) {
+        fprintf(stderr, "메모리 할당 실패\n");
+        err = -1;
+    } else if ((fp = fopen(objectcode_dir, "wb")) == NULL) {
+        perror("바이너리 오브젝트 파일 열기 실패");
+        err = -1;
+    } else {
+        fwrite(file_header.data, 1, file_header.length, fp);
+        fwrite(names_record.data, 1, names_record.length, fp);
+        fwrite(body.data, 1, body.length, fp);
+        run_stats.bytes_written += ftell(fp);
         fclose(fp);
     }
 
+    free(file_header.data);
+    free(names_record.data);
+    free(payload.data);
+    free(body.data);
+    free(names);
+
+    return err;
+}
+
+/**
+ * @brief 바이트 버퍼 뒤에 데이터를 덧붙인다. 공간이 부족하면 두 배로 늘린다.
+ * @return 오류 코드 (정상 종료 = 0)
+ */
+static int buffer_put(byte_buffer *buf, const void *data, int length) {
+    if (buf->length + length > buf->capacity) {
+        int capacity = buf->capacity ? buf->capacity : 256;
+        while (capacity < buf->length + length) capacity *= 2;
+
+        unsigned char *grown = (unsigned char *)realloc(buf->data, capacity);
+        if (grown == NULL) {
+            return -1;
+        }
+        buf->data = grown;
+        buf->capacity = capacity;
+    }
+
+    memcpy(buf->data + buf->length, data, length);
+    buf->length += length;
+
     return 0;
-}
\ No newline at end of file
+}
+
+/**
+ * @brief 부호 없는 정수를 LEB128 varint로 덧붙인다.
+ */
+static int buffer_put_varint(byte_buffer *buf, unsigned int value) {
+    unsigned char encoded[5];
+    int length = 0;
+
+    do {
+        encoded[length] = value & 0x7F;
+        value >>= 7;
+        if (value != 0) encoded[length] |= 0x80;
+        length++;
+    } while (value != 0);
+
+    return buffer_put(buf, encoded, length);
+}
+
+/**
+ * @brief 레코드 종류, payload 길이, payload를 차례로 덧붙인다.
+ */
+static int buffer_put_record(byte_buffer *buf, char record_type, const byte_buffer *payload) {
+    int err = 0;
+    err |= buffer_put(buf, &record_type, 1);
+    err |= buffer_put_varint(buf, payload->length);
+    err |= buffer_put(buf, payload->data, payload->length);
+    return err;
+}
+
+/**
+ * @brief 이름 테이블에서 이름을 찾고, 없으면 새로 추가한다.
+ * @return 이름의 인덱스 (테이블이 가득 찬 경우 -1)
+ */
+static int intern_name(char (*names)[MAX_OBJECT_CODE_STRING + 1], int *name_count, const char *name) {
+    if (*name_count < 0) {
+        return -1;
+    }
+
+    for (int i = 0; i < *name_count; i++) {
+        if (strcmp(names[i], name) == 0) {
+            return i;
+        }
+    }
+
+    if (*name_count == MAX_TABLE_LENGTH) {
+        fprintf(stderr, "이름 테이블이 가득 찼습니다.\n");
+        *name_count = -1;
+        return -1;
+    }
+
+    strncpy(names[*name_count], name, MAX_OBJECT_CODE_STRING);
+    names[*name_count][MAX_OBJECT_CODE_STRING] = '\0';
+    return (*name_count)++;
+}
+
+/**
+ * @brief 레코드 문자열의 고정 길이 16진수 필드를 정수로 변환한다.
+ */
+static int hex_field(const char *str, int length) {
+    char field[9];
+    int i = 0;
+    for (; i < length && i < 8 && str[i] != '\0'; i++) {
+        field[i] = str[i];
+    }
+    field[i] = '\0';
+    return (int)strtol(field, NULL, 16);
+}
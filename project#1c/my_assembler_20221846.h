@@ -19,6 +19,51 @@
 
 
 #define MAX_RECORDS 100
+#define DEFAULT_TEXT_RECORD_LENGTH 0x1E /** T 레코드 하나의 기본 최대 바이트 수 */
+#define MAX_TEXT_RECORD_LENGTH 0xFF     /** --text-length로 지정 가능한 최대값 */
+#define TEXT_GAP_FILL_LIMIT 4           /** --pack-text가 0으로 채워 합칠 최대 빈 구간 */
+#define RELOCATION_MASK_SIZE ((MAX_TEXT_RECORD_LENGTH + 7) / 8)
+
+/**
+ * --reloc-bitmask 모드의 B 레코드 형식. T 레코드와 같지만 길이 필드 뒤에 바이트당
+ * 1비트씩인 재배치 비트마스크가 (길이 + 3) / 4자리의 hex로 붙는다.
+ *    ==============================================================
+ *     B | 시작 주소 (6) | 길이 (2) | 비트마스크 | 데이터 |
+ *    ==============================================================
+ * 비트마스크의 최상위 비트가 레코드의 첫 바이트에 해당하며, 비트가 1인 바이트에서
+ * 시작하는 3바이트 필드에 로더가 컨트롤 섹션의 로드 주소를 더한다. 같은 섹션 안의
+ * 주소를 위한 재배치만 비트마스크로 표현하고, 외부 참조는 M 레코드를 사용한다.
+ */
+
+#define HEADER_RECORD 'H'
+#define TEXT_RECORD 'T'
+#define END_RECORD 'E'
+#define DEFINE_RECORD 'D'
+#define REFERENCE_RECORD 'R'
+#define MODIFY_RECORD 'M'
+#define BITMASK_TEXT_RECORD 'B' /** 재배치 비트마스크가 붙은 T 레코드 (--reloc-bitmask) */
+
+/**
+ * 바이너리 오브젝트 파일(--binary)의 형식. 파일은 magic "SXOB"(4)와
+ * version(1)으로 시작하고, 이후 레코드가 이어진다. 각 레코드는
+ *    ==============================================================
+ *           | 레코드 종류 (1) | payload 길이 (varint) | payload |
+ *    ==============================================================
+ * 로 구성되며, varint는 하위 7비트씩 기록하는 LEB128 형식이다. 외부 심볼
+ * 이름은 파일 맨 앞의 N 레코드에 한 번씩만 기록하고 다른 레코드에서는
+ * 이름 인덱스로 참조한다.
+ *    N: 개수, { 이름 길이 (1), 이름 }
+ *    H: 이름 인덱스, 시작 주소, 길이
+ *    D: 개수, { 이름 인덱스, 주소 }
+ *    R: 개수, { 이름 인덱스 }
+ *    T: 시작 주소, 원본 바이트 (hex 인코딩 없음)
+ *    B: 시작 주소, 길이, 재배치 비트마스크 ((길이 + 7) / 8), 원본 바이트
+ *    M: 주소, half-byte 길이 (1), (이름 인덱스 << 1 | 부호가 '-'이면 1)
+ *    E: 실행 주소 유무 (1), [실행 주소]
+ */
+#define BINARY_OBJECT_MAGIC "SXOB"
+#define BINARY_OBJECT_VERSION 1
+#define NAME_RECORD 'N'
 
 /**
  * @brief 한 개의 SIC/XE instruction을 저장하는 구조체
@@ -35,6 +80,44 @@ typedef struct _inst {
     int ops;          /** instruction이 가지는 operator 개수 */
 } inst;
 
+#define MAX_EXPRESSION_ITEMS 32 /** 컴파일한 수식 하나의 최대 항목 수 */
+
+/**
+ * 후위 표기식 항목의 종류. 이항 연산자는 '+', '-', '*', '/' 문자를 그대로 쓴다.
+ */
+#define EXPR_NUMBER 'n' /** 10진 상수 */
+#define EXPR_SYMBOL 's' /** 심볼 (같은 섹션이면 절대/상대, 없으면 외부 참조) */
+#define EXPR_LOCCTR 'l' /** 현재 LOCCTR ('*') */
+#define EXPR_NEGATE '~' /** 단항 '-' */
+
+/**
+ * @brief EQU/WORD 피연산자를 후위 표기식으로 컴파일한 결과
+ *
+ * @details
+ * 패스 1에서 한 번만 파싱하여 토큰에 저장하고, 패스 1의 값 계산과 패스 2의
+ * 오브젝트 코드 및 M 레코드 생성은 모두 이 표기식을 평가하여 얻는다.
+ */
+typedef struct _expr_item {
+    char kind;     /** 항목 종류 (EXPR_* 또는 이항 연산자 문자) */
+    int value;     /** EXPR_NUMBER의 값 */
+    char name[10]; /** EXPR_SYMBOL의 이름 */
+} expr_item;
+
+typedef struct _expression {
+    expr_item items[MAX_EXPRESSION_ITEMS];
+    int length;
+} expression;
+
+/**
+ * @brief 수식을 평가한 결과와 항 분류
+ */
+typedef struct _expr_value {
+    int value;    /** 외부 참조 항을 0으로 본 값 */
+    int relative; /** 섹션 상대 항의 부호 합 (0 = 절대값, 1 = 섹션 상대 주소) */
+    int externals; /** 외부 참조 항 수 */
+    signed char external_sign[MAX_EXPRESSION_ITEMS]; /** 항목별 외부 참조 부호 (외부 참조가 아니면 0) */
+} expr_value;
+
 /**
  * @brief 소스코드 한 줄을 분해하여 저장하는 구조체
  *
@@ -49,8 +132,71 @@ typedef struct _token {
                                             가리키는 포인터 배열 */
     char *comment; /** comment를 가리키는 포인터 */
     char nixbpe;   /** 특수 bit 정보 */
+    expression *expr; /** EQU/WORD 피연산자를 컴파일한 수식 (그 외에는 NULL) */
 } token;
 
+#define MAX_MACRO_PARAMS 16  /** 매크로 하나의 최대 매개변수 수 */
+#define MAX_MACRO_DEPTH 16   /** 매크로 안에서 다른 매크로를 호출할 수 있는 최대 깊이 */
+#define MACRO_FIELD_COPY -1  /** 템플릿 필드를 그대로 복사 */
+#define MACRO_FIELD_SCAN -2  /** 템플릿 필드 안의 &매개변수와 $라벨을 치환 */
+
+/**
+ * @brief 매크로 정의의 본문 라인 하나
+ *
+ * @details
+ * 본문은 정의할 때 한 번만 토큰으로 나누어 두고, 호출할 때는 필드별로 미리 정해 둔
+ * 방법(`field`)에 따라 토큰을 복사하거나 매개변수 값으로 바꾸어 새 토큰을 만든다.
+ * 필드가 매개변수 하나("&BUF")뿐이면 `field`에 매개변수 인덱스를 저장한다.
+ */
+typedef struct _macro_line {
+    token tok;       /** 본문 라인의 토큰 (매개변수는 치환하지 않은 상태) */
+    char *arguments; /** 피연산자 원문 (본문에서 다른 매크로를 호출할 때 사용) */
+    signed char field[2 + MAX_OPERAND_PER_INST]; /** label, operator, operand별 치환 방법 */
+} macro_line;
+
+/**
+ * @brief MACRO ~ MEND로 정의한 매크로 하나
+ */
+typedef struct _macro {
+    char name[10];                              /** 매크로 이름 */
+    char params[MAX_MACRO_PARAMS][10];          /** 매개변수 이름 ('&' 제외) */
+    char *defaults[MAX_MACRO_PARAMS];           /** 키워드 매개변수의 기본값 (위치 매개변수는 NULL) */
+    int param_count;
+    macro_line *lines;                          /** 본문 라인 */
+    int line_count;
+    int line_capacity;
+} macro;
+
+/**
+ * @brief 패스 1의 매크로 처리 상태
+ */
+typedef struct _macro_table {
+    macro *macros;
+    int count;
+    int capacity;
+    macro *defining; /** MACRO ~ MEND 사이에서 정의 중인 매크로 (없으면 NULL) */
+    int expansions;  /** 전개 횟수 ('$' 라벨을 전개마다 다르게 만드는 데 사용) */
+} macro_table;
+
+/**
+ * @brief 매크로 처리 결과
+ */
+typedef struct _macro_result {
+    int definitions;     /** 정의한 매크로 수 */
+    int invocations;     /** 매크로 호출 수 (매크로 안의 호출 포함) */
+    int generated_lines; /** 전개로 만든 토큰 라인 수 */
+} macro_result;
+
+#define MAX_PROGRAM_BLOCKS 16 /** 컨트롤 섹션 하나의 최대 프로그램 블록 수 (기본 블록 포함) */
+
+/**
+ * @brief 프로그램 블록(USE) 배치 결과
+ */
+typedef struct _block_result {
+    int blocks;      /** 이름 있는 프로그램 블록 수 (모든 컨트롤 섹션 합계) */
+    int moved_lines; /** 기본 블록 뒤로 옮긴 라인 수 */
+} block_result;
+
 /**
  * @brief 하나의 심볼에 대한 정보를 저장하는 구조체
  *
@@ -63,6 +209,8 @@ typedef struct _symbol {
     char name[10]; /** 심볼의 이름 */
     int addr;      /** 심볼의 주소 */
     char csect[20]; /** 컨트롤 섹션 이름 */
+    bool absolute;  /** EQU로 정의한 절대값 심볼인지 여부 (재배치하지 않는다) */
+    bool pending;   /** EQU 값을 아직 계산하지 않았는지 여부 (addr는 EQU 라인의 LOCCTR) */
 } symbol;
 
 /**
@@ -78,8 +226,32 @@ typedef struct _literal {
     char literal[20]; /** 리터럴의 표현식 */
     int addr;         /** 리터럴의 주소 */
     bool isProcessed; 
+    char csect[20];   /** 리터럴을 사용한 컨트롤 섹션 이름 (리터럴 풀은 섹션마다 따로 둔다) */
 } literal;
 
+/**
+ * @brief 컨트롤 섹션 하나에서 assem_pass2가 센 명령어 통계 (--module-stats)
+ *
+ * @details
+ * 주소 지정 방식은 만든 오브젝트 코드의 nixbpe 비트로 센다. n/i 조합(immediate,
+ * indirect, simple)은 서로 겹치지 않고, x/b/p/e 비트는 한 명령어에서 함께 셀 수 있다.
+ */
+typedef struct _module_stats {
+    int mnemonics[MAX_INST_TABLE_LENGTH]; /** inst_table 인덱스별 명령어 수 (+ 접두사는 같은 명령어로 센다) */
+    int formats[5];          /** 형식(1~4)별 명령어 수 (0번은 쓰지 않는다) */
+    int immediate;           /** n=0, i=1 */
+    int indirect;            /** n=1, i=0 */
+    int simple;              /** n=1, i=1 */
+    int indexed;             /** x=1 */
+    int pc_relative;         /** p=1 */
+    int base_relative;       /** b=1 */
+    int extended;            /** e=1 */
+    int direct;              /** n=i=1, b=p=e=0 (변위가 곧 주소인 단순 주소 지정) */
+    int literal_refs;        /** 리터럴을 피연산자로 쓰는 명령어 수 */
+    int literals;            /** 이 섹션에 배치한 리터럴 수 */
+    int bitmask_relocations; /** --reloc-bitmask로 재배치한 필드 수 */
+} module_stats;
+
 /**
  * @brief 오브젝트 코드 전체에 대한 정보를 담는 구조체
  *
@@ -94,7 +266,8 @@ typedef struct _object_code {
     char header[MAX_CONTROL_SECTION_NUM][MAX_RECORDS][MAX_OBJECT_CODE_STRING + 1]; // 헤더 레코드 배열
     char define[MAX_CONTROL_SECTION_NUM][MAX_RECORDS][MAX_OBJECT_CODE_STRING + 1]; // define 레코드 배열
     char reference[MAX_CONTROL_SECTION_NUM][MAX_RECORDS][MAX_OBJECT_CODE_STRING + 1]; // reference 레코드 배열 
-    char text[MAX_CONTROL_SECTION_NUM][MAX_RECORDS][MAX_OBJECT_CODE_STRING + 1];   // 텍스트 레코드 배열
+    char *text[MAX_CONTROL_SECTION_NUM][MAX_RECORDS];   // 텍스트 레코드 배열 (길이가 가변이므로 동적 할당)
+    unsigned char *text_mask[MAX_CONTROL_SECTION_NUM][MAX_RECORDS]; // 텍스트 레코드별 재배치 비트마스크 (없으면 NULL)
     char end[MAX_CONTROL_SECTION_NUM][MAX_RECORDS][MAX_OBJECT_CODE_STRING + 1];    // 엔드 레코드 배열
     char modification[MAX_CONTROL_SECTION_NUM][MAX_RECORDS][MAX_OBJECT_CODE_STRING + 1]; // 모디파이 레코드 배열
 
@@ -105,9 +278,186 @@ typedef struct _object_code {
     int end_count[MAX_CONTROL_SECTION_NUM];    // 엔드 레코드의 개수
     int modify_count[MAX_CONTROL_SECTION_NUM]; // 모디파이 레코드의 개수
 
+    module_stats modules[MAX_CONTROL_SECTION_NUM]; // 섹션별 명령어 통계 (--module-stats)
+
     int num_sections; // Control Section의 개수
 } object_code;
 
+/**
+ * @brief 명령행으로 지정하는 어셈블러 옵션을 저장하는 구조체
+ */
+typedef struct _assem_option {
+    bool binary_object;     /** 오브젝트 코드를 바이너리 형식으로 출력할지 여부 */
+    int text_record_length; /** T 레코드 하나의 최대 바이트 수 */
+    bool pack_text;         /** 패스 2 이후 인접한 T 레코드를 합칠지 여부 */
+    bool relocation_bitmask; /** 섹션 내 재배치를 M 레코드 대신 비트마스크로 표현할지 여부 */
+    bool relax;             /** 패스 1 이후 3/4형식을 자동으로 고를지 여부 */
+    bool auto_base;         /** 베이스 레지스터 적재 위치를 자동으로 정할지 여부 (--relax 포함) */
+    bool literal_pools;     /** 리터럴 풀(LTORG)을 자동으로 배치할지 여부 */
+    bool peephole;          /** 패스 1에서 LOCCTR 계산 전에 핍홀 최적화를 수행할지 여부 */
+    bool one_pass;          /** 소스를 한 번만 읽으며 오브젝트 코드를 만들지 여부 */
+    bool size_only;         /** 패스 1까지만 수행하고 컨트롤 섹션별 크기 요약만 출력할지 여부 */
+    const char *stats_path; /** 단계별 시간과 카운터를 JSON으로 저장할 파일 경로 (NULL = 저장하지 않음) */
+    bool perf_counters;     /** --stats 보고서에 단계별 하드웨어 카운터(perf_event_open)를 함께 기록할지 여부 */
+    bool alloc_sites;       /** --stats 보고서에 할당 위치별 할당/해제 기록을 함께 기록할지 여부 */
+    bool memory;            /** --stats 보고서에 단계별 RSS와 테이블별 논리 바이트 수를 함께 기록할지 여부 */
+    const char *module_stats_path; /** 컨트롤 섹션별 명령어 통계를 JSON으로 저장할 파일 경로 (NULL = 저장하지 않음) */
+    const char *trace_path; /** 단계, 컨트롤 섹션, 소스 파일별 구간을 Chrome 트레이스 JSON으로 저장할 파일 경로 (NULL = 저장하지 않음) */
+} assem_option;
+
+#define MAX_STATS_PHASES 16 /** --stats로 기록하는 최대 단계 수 */
+#define PERF_COUNTER_COUNT 5 /** --perf-counters로 읽는 하드웨어 카운터 수 */
+#define MAX_ALLOC_SITES 128  /** --alloc-sites로 구분하는 최대 할당 위치 수 (넘치는 위치는 추적하지 않는다) */
+
+/**
+ * @brief 단계 하나가 끝난 시점의 메모리 사용량 (--memory)
+ *
+ * @details
+ * 테이블별 값은 할당한 크기가 아니라 현재 쓰고 있는 항목의 크기(논리 바이트)이다.
+ * 오브젝트 코드는 패스 2(또는 --one-pass)가 채운 뒤부터 센다.
+ */
+typedef struct _memory_snapshot {
+    long rss_kb;            /** 현재 RSS (읽을 수 없으면 -1) */
+    long peak_rss_kb;       /** 지금까지의 최대 RSS (읽을 수 없으면 -1) */
+    long long tokens;       /** 토큰 구조체와 컴파일한 수식 */
+    long long strings;      /** 소스 라인과 토큰 필드 문자열 */
+    long long symbols;      /** 심볼 테이블 항목 */
+    long long literals;     /** 리터럴 테이블 항목 */
+    long long records;      /** object_code 구조체와 T 레코드 문자열, 재배치 비트마스크 */
+    long long records_used; /** 그중 실제로 채운 레코드 문자열 */
+} memory_snapshot;
+
+/**
+ * @brief 단계 하나의 소요 시간
+ */
+typedef struct _phase_timer {
+    const char *name;      /** 단계 이름 (함수 이름) */
+    long long nanoseconds; /** 단조 시계로 잰 소요 시간 (같은 단계를 여러 번 수행하면 합계) */
+    long long counters[PERF_COUNTER_COUNT]; /** --perf-counters: 단계 동안 증가한 하드웨어 카운터 값 */
+    memory_snapshot memory; /** --memory: 단계가 (마지막으로) 끝난 시점의 메모리 사용량 */
+} phase_timer;
+
+/**
+ * @brief 할당 함수를 호출한 위치 하나의 할당 기록 (--alloc-sites)
+ */
+typedef struct _alloc_site {
+    const char *file;     /** 호출한 소스 파일 (__FILE__) */
+    int line;             /** 호출한 줄 (__LINE__) */
+    const char *function; /** 호출한 함수 (__func__) */
+    long allocations;     /** 할당 횟수 (realloc 포함) */
+    long long bytes;      /** 할당을 요청한 바이트 수 */
+    long frees;           /** 이 위치에서 할당한 블록을 해제하거나 realloc으로 옮긴 횟수 */
+    long live;            /** 아직 해제되지 않은 블록 수 */
+    long long live_bytes; /** 아직 해제되지 않은 바이트 수 */
+} alloc_site;
+
+/**
+ * @brief --stats로 출력하는 단계별 시간과 카운터
+ */
+typedef struct _assem_stats {
+    phase_timer phases[MAX_STATS_PHASES]; /** 수행한 순서대로의 단계별 시간 */
+    int phase_count;
+    long long total_nanoseconds; /** 프로그램 시작부터 보고서 작성 직전까지의 시간 */
+    bool counter_available[PERF_COUNTER_COUNT]; /** --perf-counters: 열린 하드웨어 카운터 */
+
+    long lines;           /** 읽은 소스 라인 수 */
+    long tokens;          /** 패스 1이 만든 토큰 라인 수 */
+    long symbols;         /** 심볼 테이블 항목 수 */
+    long literals;        /** 리터럴 테이블 항목 수 */
+    long opcode_lookups;  /** search_opcode 호출 수 */
+    long symbol_lookups;  /** search_symbol 호출 수 */
+    long literal_lookups; /** search_literal 호출 수 */
+    long allocations;     /** malloc/calloc/realloc/strdup 호출 수 */
+    long long allocated_bytes; /** 할당을 요청한 바이트 수 */
+    long long bytes_written;   /** 출력 파일에 쓴 바이트 수 */
+
+    alloc_site alloc_sites[MAX_ALLOC_SITES]; /** --alloc-sites: 처음 할당한 순서대로의 할당 위치 */
+    int alloc_site_count;
+} assem_stats;
+
+#define MAX_TRACE_NAME 64          /** --trace 이벤트 이름의 최대 길이 (넘치면 자른다) */
+#define DEFAULT_TRACE_CAPACITY 256 /** 트레이스 버퍼가 처음 확보하는 이벤트 수 */
+
+/**
+ * @brief --trace로 출력하는 구간 하나 (Chrome 트레이스의 "X" 이벤트)
+ */
+typedef struct _trace_event {
+    char name[MAX_TRACE_NAME]; /** 단계 이름, 컨트롤 섹션 이름 또는 소스 파일 경로 */
+    const char *category;      /** "phase", "csect", "job" */
+    long long start_ns;        /** 단조 시계 기준 시작 시각 */
+    long long duration_ns;
+} trace_event;
+
+/**
+ * @brief 스레드 하나가 기록하는 트레이스 이벤트 버퍼
+ *
+ * @details
+ * 이벤트를 기록할 때는 자기 버퍼에 덧붙이기만 하고, 파일 출력은 프로그램이 끝날 때
+ * make_trace_output이 모든 버퍼를 모아 한 번에 한다. 스레드마다 버퍼를 따로 두므로
+ * 기록할 때 잠금이 필요 없다.
+ */
+typedef struct _trace_buffer {
+    trace_event *events;
+    int count;
+    int capacity;
+    int tid; /** 트레이스 뷰어에서 이벤트를 놓을 스레드 번호 */
+} trace_buffer;
+
+/**
+ * @brief relax_formats의 수행 결과
+ */
+typedef struct _relax_result {
+    int iterations;  /** 고정점에 도달할 때까지 주소를 다시 계산한 횟수 */
+    int shortened;   /** 4형식에서 3형식으로 줄인 명령어 수 */
+    int lengthened;  /** 3형식에서 4형식으로 늘린 명령어 수 */
+    int bytes_saved; /** 줄어든 명령어 바이트 수 (음수면 늘어남) */
+} relax_result;
+
+/**
+ * @brief choose_base_registers의 수행 결과
+ */
+typedef struct _base_result {
+    int sections;    /** BASE를 적용한 컨트롤 섹션 수 */
+    int load_points; /** 추가한 LDB 명령어 수 */
+    int shortened;   /** BASE 상대 주소로 3형식이 된 명령어 수 */
+    int bytes_saved; /** LDB를 포함하여 줄어든 명령어 바이트 수 */
+} base_result;
+
+/**
+ * @brief place_literal_pools의 수행 결과
+ */
+typedef struct _pool_result {
+    int pools;       /** 추가한 LTORG 수 */
+    int far_before;  /** PC 상대 주소로 닿지 않던 리터럴 참조 수 */
+    int far_after;   /** 리터럴 풀 배치 후에도 닿지 않는 리터럴 참조 수 */
+} pool_result;
+
+/**
+ * @brief assem_one_pass의 수행 결과
+ */
+typedef struct _one_pass_result {
+    int lines;            /** 읽은 소스 라인 수 */
+    int forward_refs;     /** 전방 참조로 미뤄 둔 명령어/WORD 수 */
+    int patched_in_place; /** 아직 출력하지 않은 T 레코드를 직접 고친 수 */
+    int patch_records;    /** 이미 출력한 레코드를 덮어쓰기 위해 추가한 T 레코드 수 */
+    int max_pending;      /** 동시에 해결을 기다린 참조 수의 최대값 */
+} one_pass_result;
+
+/**
+ * @brief 핍홀 최적화 규칙 하나와 적용 횟수
+ *
+ * @details
+ * `match`는 주석 라인을 건너뛴 연속된 두 명령어 토큰 `first`, `second`를 보고
+ * 제거할 토큰의 인덱스(first 또는 second)를, 일치하지 않으면 -1을 반환한다.
+ * 라벨을 옮겨야 하는 경우 `match`가 직접 옮긴다.
+ */
+typedef struct _peephole_rule {
+    const char *name; /** 규칙 이름 (보고용) */
+    int (*match)(token *tokens[], int first, int second);
+    int hits;         /** 규칙이 적용된 횟수 */
+    int bytes_saved;  /** 규칙으로 제거한 명령어 바이트 수 */
+} peephole_rule;
+
 int init_inst_table(inst *inst_table[], int *inst_table_length,
                     const char *inst_table_dir);
 int init_input(char *input[], int *input_length, const char *input_dir);
@@ -116,8 +466,38 @@ int assem_pass1(const inst *inst_table[], int inst_table_length,
                 int *tokens_length, symbol *symbol_table[],
                 int *symbol_table_length, literal *literal_table[],
                 int *literal_table_length);
+int assem_size_only(const inst *inst_table[], int inst_table_length,
+                    const char *sources[], int source_count);
+int assem_one_pass(const inst *inst_table[], int inst_table_length,
+                   const char *input_dir, symbol *symbol_table[],
+                   int *symbol_table_length, literal *literal_table[],
+                   int *literal_table_length, const char *objectcode_dir,
+                   one_pass_result *result);
+int relax_formats(token *tokens[], int tokens_length,
+                  const inst *inst_table[], int inst_table_length,
+                  symbol *symbol_table[], int *symbol_table_length,
+                  literal *literal_table[], int *literal_table_length,
+                  relax_result *result);
+int place_literal_pools(token *tokens[], int *tokens_length,
+                        const inst *inst_table[], int inst_table_length,
+                        symbol *symbol_table[], int *symbol_table_length,
+                        literal *literal_table[], int *literal_table_length,
+                        pool_result *result);
+int choose_base_registers(token *tokens[], int *tokens_length,
+                          const inst *inst_table[], int inst_table_length,
+                          symbol *symbol_table[], int *symbol_table_length,
+                          literal *literal_table[], int *literal_table_length,
+                          base_result *result);
+int arrange_program_blocks(token *tokens[], int *tokens_length, block_result *result);
+int optimize_peephole(token *tokens[], int *tokens_length,
+                      const inst *inst_table[], int inst_table_length,
+                      peephole_rule rules[], int rule_count);
 int token_parsing(const char *input, token *tok, const inst *inst_table[],
                   int inst_table_length);
+expression *compile_expression(const char *operand);
+int evaluate_expression(const expression *expr, const symbol *symbol_table[],
+                        int symbol_table_length, const char *current_csect,
+                        int locctr, bool allow_external, expr_value *result);
 int search_opcode(const char *str, const inst *inst_table[],
                   int inst_table_length);
 int make_opcode_output(const char *output_dir, const token *tokens[],
@@ -131,10 +511,23 @@ int assem_pass2(const token *tokens[], int tokens_length,
 int make_symbol_table_output(const char *symbol_table_dir,
                              const symbol *symbol_table[],
                              int symbol_table_length);
+int make_size_summary_output(const char *summary_dir, const char *source,
+                             const token *tokens[], int tokens_length,
+                             const inst *inst_table[], int inst_table_length,
+                             const symbol *symbol_table[], int symbol_table_length,
+                             const literal *literal_table[], int literal_table_length);
+int make_stats_output(const char *stats_dir, const assem_stats *stats);
+int make_module_stats_output(const char *module_stats_dir, const object_code *obj_code,
+                             const inst *inst_table[], int inst_table_length);
+int make_trace_output(const char *trace_dir, const trace_buffer *buffers[], int buffer_count,
+                      long long origin_ns);
 int make_literal_table_output(const char *literal_table_dir,
                               const literal *literal_table[],
                               int literal_table_length);
 int make_objectcode_output(const char *objectcode_dir,
                            const object_code *obj_code);
+int pack_text_records(object_code *obj_code);
+int make_objectcode_binary_output(const char *objectcode_dir,
+                                  const object_code *obj_code);
 
 #endif
\ No newline at end of file
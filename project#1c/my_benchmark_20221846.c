@@ -0,0 +1,474 @@
+/**
+ * @file my_benchmark_20221846.c
+ * @date 2024-06-03
+ * @version 0.1.0
+ *
+ * @brief 생성한 워크로드로 어셈블러의 처리량과 메모리를 측정하는 프로그램
+ *
+ * @details
+ * 소스 라인 수를 바꿔 가며 my_workload_20221846으로 입력을 만들고
+ * my_assembler_20221846을 여러 번 실행해 가장 빠른 실행 시간, 초당 처리 라인 수,
+ * 최대 상주 메모리(peak RSS)를 출력한다. 이전 크기와 비교한 증가 지수
+ * (log(시간 비) / log(라인 비))가 1에 가까우면 선형, 2에 가까우면 이차 시간이므로
+ * 심볼 검색이나 T 레코드 생성에 숨은 이차 동작을 바로 볼 수 있다.
+ * --linker를 주면 크기마다 --pack-text 없이, 그리고 --pack-text로 어셈블한 오브젝트
+ * 프로그램을 링커(my_linker_20221846)로 번갈아 적재하여 T 레코드 묶기 전후의 적재
+ * 시간을 함께 출력한다.
+ * 자식 프로세스의 메모리를 wait4로 얻으므로 POSIX 환경에서만 동작한다.
+ *
+ *    사용법: my_benchmark_20221846 [--assembler 경로] [--generator 경로]
+ *            [--inst-table 경로] [--workdir 디렉터리] [--sizes 500,1000,...]
+ *            [--csects N] [--repeat N] [--csv 파일] [--linker 경로] [생성기 옵션...]
+ *            [-- 어셈블러 옵션...]
+ *
+ * 생성기 옵션(--symbol-density, --literal-density, --extref, --byte-size, --seed)은
+ * 그대로 생성기에 넘긴다.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#include "my_benchmark_20221846.h"
+
+static long long monotonic_ns(void);
+static int parse_sizes(benchmark_config *config, const char *list);
+static int absolute_path(char *dest, const char *path);
+static int copy_file(const char *from, const char *to);
+static long count_lines(const char *path);
+static int measure_load_time(const benchmark_config *config, long long *plain_ns, long long *packed_ns);
+
+/**
+ * @brief 명령행 옵션을 읽어 벤치마크를 수행한다.
+ */
+int main(int argc, char **argv) {
+    static benchmark_config config;
+    const char *assembler = "./my_assembler_20221846";
+    const char *generator = "./my_workload_20221846";
+    const char *inst_table = "inst_table.txt";
+    const char *linker = NULL;
+
+    config.workdir = DEFAULT_BENCHMARK_WORKDIR;
+    config.csects = DEFAULT_BENCHMARK_CSECTS;
+    config.repeat = DEFAULT_BENCHMARK_REPEAT;
+    parse_sizes(&config, "500,1000,2000,4000");
+
+    int i = 1;
+    for (; i < argc; i++) {
+        if (strcmp(argv[i], "--") == 0) {
+            i++;
+            break;
+        }
+
+        if (i + 1 >= argc) {
+            fprintf(stderr, "옵션 %s에 값이 없습니다.\n", argv[i]);
+            return -1;
+        }
+        if (strcmp(argv[i], "--assembler") == 0) {
+            assembler = argv[++i];
+        } else if (strcmp(argv[i], "--generator") == 0) {
+            generator = argv[++i];
+        } else if (strcmp(argv[i], "--inst-table") == 0) {
+            inst_table = argv[++i];
+        } else if (strcmp(argv[i], "--workdir") == 0) {
+            config.workdir = argv[++i];
+        } else if (strcmp(argv[i], "--csv") == 0) {
+            config.csv_path = argv[++i];
+        } else if (strcmp(argv[i], "--linker") == 0) {
+            linker = argv[++i];
+        } else if (strcmp(argv[i], "--sizes") == 0) {
+            if (parse_sizes(&config, argv[++i]) < 0) return -1;
+        } else if (strcmp(argv[i], "--csects") == 0) {
+            config.csects = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--repeat") == 0) {
+            config.repeat = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--symbol-density") == 0 || strcmp(argv[i], "--literal-density") == 0 ||
+                   strcmp(argv[i], "--extref") == 0 || strcmp(argv[i], "--byte-size") == 0 ||
+                   strcmp(argv[i], "--seed") == 0) {
+            if (config.generator_arg_count + 2 > MAX_BENCHMARK_ARGS) {
+                fprintf(stderr, "생성기 옵션이 너무 많습니다.\n");
+                return -1;
+            }
+            config.generator_args[config.generator_arg_count++] = argv[i];
+            config.generator_args[config.generator_arg_count++] = argv[++i];
+        } else {
+            fprintf(stderr, "사용법: %s [--assembler 경로] [--generator 경로] [--inst-table 경로] "
+                            "[--workdir 디렉터리] [--sizes N,N,...] [--csects N] [--repeat N] "
+                            "[--csv 파일] [--linker 경로] [생성기 옵션...] [-- 어셈블러 옵션...]\n", argv[0]);
+            return -1;
+        }
+    }
+    for (; i < argc; i++) {
+        if (config.assembler_arg_count == MAX_BENCHMARK_ARGS) {
+            fprintf(stderr, "어셈블러 옵션이 너무 많습니다.\n");
+            return -1;
+        }
+        config.assembler_args[config.assembler_arg_count++] = argv[i];
+    }
+
+    if (config.repeat < 1) {
+        fprintf(stderr, "반복 횟수는 1 이상이어야 합니다.\n");
+        return -1;
+    }
+    for (int k = 0; linker != NULL && k < config.assembler_arg_count; k++) {
+        if (strcmp(config.assembler_args[k], "--pack-text") == 0) {
+            fprintf(stderr, "--linker는 --pack-text 전후를 직접 비교하므로 어셈블러 옵션에 --pack-text를 줄 수 없습니다.\n");
+            return -1;
+        }
+    }
+
+    // 어셈블러는 작업 디렉터리에서 실행하므로 실행 파일 경로를 미리 절대 경로로 바꾼다
+    if (absolute_path(config.assembler, assembler) < 0 ||
+        absolute_path(config.generator, generator) < 0 ||
+        absolute_path(config.inst_table, inst_table) < 0 ||
+        (linker != NULL && absolute_path(config.linker, linker) < 0)) {
+        return -1;
+    }
+
+    int err = run_benchmark(&config);
+    if (err < 0) {
+        fprintf(stderr, "run_benchmark: 벤치마크 수행에 실패했습니다. (error_code: %d)\n", err);
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief 크기마다 입력을 생성하고 어셈블러를 실행하여 결과 표를 출력한다.
+ * @return 오류 코드 (정상 종료 = 0)
+ */
+int run_benchmark(const benchmark_config *config) {
+    char input_path[MAX_BENCHMARK_PATH];
+    char table_path[MAX_BENCHMARK_PATH];
+    char lines_arg[16];
+    char csects_arg[16];
+    FILE *csv = NULL;
+
+    if (mkdir(config->workdir, 0755) < 0 && errno != EEXIST) {
+        perror("작업 디렉터리 생성 실패");
+        return -1;
+    }
+    snprintf(input_path, sizeof(input_path), "%s/input.txt", config->workdir);
+    snprintf(table_path, sizeof(table_path), "%s/inst_table.txt", config->workdir);
+    if (copy_file(config->inst_table, table_path) < 0) {
+        return -1;
+    }
+
+    if (config->csv_path != NULL) {
+        if ((csv = fopen(config->csv_path, "w")) == NULL) {
+            perror("CSV 파일 열기 실패");
+            return -1;
+        }
+        fprintf(csv, "lines,csects,best_ns,lines_per_sec,peak_rss_kb%s\n",
+                config->linker[0] != '\0' ? ",load_ns,packed_load_ns" : "");
+    }
+
+    printf("%8s %7s %12s %14s %12s %8s", "lines", "csects", "best_ms", "lines/sec", "peak_rss_kb", "growth");
+    if (config->linker[0] != '\0') {
+        printf(" %10s %10s %8s", "load_ms", "packed_ms", "change");
+    }
+    printf("\n");
+
+    long previous_lines = 0;
+    long long previous_ns = 0;
+    int err = 0;
+    for (int s = 0; s < config->size_count && err == 0; s++) {
+        const char *argv[MAX_BENCHMARK_ARGS + 16];
+        int argc = 0;
+        benchmark_sample sample;
+
+        // 입력 생성
+        snprintf(lines_arg, sizeof(lines_arg), "%d", config->sizes[s]);
+        snprintf(csects_arg, sizeof(csects_arg), "%d", config->csects);
+        argv[argc++] = config->generator;
+        argv[argc++] = "--lines";
+        argv[argc++] = lines_arg;
+        argv[argc++] = "--csects";
+        argv[argc++] = csects_arg;
+        for (int k = 0; k < config->generator_arg_count; k++) argv[argc++] = config->generator_args[k];
+        argv[argc++] = "-o";
+        argv[argc++] = input_path;
+        argv[argc] = NULL;
+        if ((err = run_program(argv, NULL, &sample)) < 0) break;
+        if (sample.exit_status != 0) {
+            fprintf(stderr, "%d 라인 입력을 생성하지 못했습니다.\n", config->sizes[s]);
+            err = -1;
+            break;
+        }
+
+        long lines = count_lines(input_path);
+        if (lines <= 0) {
+            err = -1;
+            break;
+        }
+
+        // 어셈블
+        argc = 0;
+        argv[argc++] = config->assembler;
+        for (int k = 0; k < config->assembler_arg_count; k++) argv[argc++] = config->assembler_args[k];
+        argv[argc] = NULL;
+
+        long long best_ns = 0;
+        long peak_rss_kb = 0;
+        for (int r = 0; r < config->repeat; r++) {
+            if ((err = run_program(argv, config->workdir, &sample)) < 0) break;
+            if (sample.exit_status != 0) {
+                fprintf(stderr, "%ld 라인 입력을 어셈블하지 못했습니다. (종료 코드 %d, 입력: %s)\n",
+                        lines, sample.exit_status, input_path);
+                err = -1;
+                break;
+            }
+            if (r == 0 || sample.nanoseconds < best_ns) best_ns = sample.nanoseconds;
+            if (sample.peak_rss_kb > peak_rss_kb) peak_rss_kb = sample.peak_rss_kb;
+        }
+        if (err < 0) break;
+
+        long long load_ns = 0;
+        long long packed_load_ns = 0;
+        if (config->linker[0] != '\0' && (err = measure_load_time(config, &load_ns, &packed_load_ns)) < 0) {
+            break;
+        }
+
+        double lines_per_sec = best_ns > 0 ? lines * 1e9 / best_ns : 0;
+        printf("%8ld %7d %12.3f %14.0f %12ld", lines, config->csects, best_ns / 1e6, lines_per_sec, peak_rss_kb);
+        if (previous_lines > 0 && lines != previous_lines && previous_ns > 0) {
+            printf(" %8.2f", log((double)best_ns / previous_ns) / log((double)lines / previous_lines));
+        } else {
+            printf(" %8s", "-");
+        }
+        if (config->linker[0] != '\0') {
+            printf(" %10.3f %10.3f %+7.1f%%", load_ns / 1e6, packed_load_ns / 1e6,
+                   load_ns > 0 ? (packed_load_ns - load_ns) * 100.0 / load_ns : 0);
+        }
+        printf("\n");
+        if (csv != NULL) {
+            fprintf(csv, "%ld,%d,%lld,%.0f,%ld", lines, config->csects, best_ns, lines_per_sec, peak_rss_kb);
+            if (config->linker[0] != '\0') {
+                fprintf(csv, ",%lld,%lld", load_ns, packed_load_ns);
+            }
+            fprintf(csv, "\n");
+        }
+
+        previous_lines = lines;
+        previous_ns = best_ns;
+    }
+
+    if (csv != NULL) {
+        fclose(csv);
+    }
+
+    return err;
+}
+
+/**
+ * @brief 작업 디렉터리의 입력을 --pack-text 없이, 그리고 --pack-text로 어셈블하고 두
+ * 오브젝트 프로그램을 링커로 번갈아 --repeat번씩 적재하여 각각 가장 빠른 시간을 잰다.
+ *
+ * @param config 벤치마크 설정 (linker가 지정되어 있어야 한다)
+ * @param plain_ns --pack-text 없이 만든 오브젝트 프로그램의 적재 시간을 저장할 변수 주소
+ * @param packed_ns --pack-text로 만든 오브젝트 프로그램의 적재 시간을 저장할 변수 주소
+ * @return 오류 코드 (정상 종료 = 0)
+ *
+ * @details
+ * 링커는 메모리 이미지(-f image)를 만들도록 실행하므로 레코드 해석, 적재, 재배치를
+ * 모두 거친다. 링커 프로세스의 시작 비용도 함께 재므로 작은 입력에서는 차이가 묻힌다.
+ */
+static int measure_load_time(const benchmark_config *config, long long *plain_ns, long long *packed_ns) {
+    static const char *const objects[2] = {"plain_objectcode.txt", "packed_objectcode.txt"};
+    char from[MAX_BENCHMARK_PATH + 32];
+    char to[MAX_BENCHMARK_PATH + 32];
+    const char *argv[MAX_BENCHMARK_ARGS + 8];
+    long long best[2] = {0, 0};
+    benchmark_sample sample;
+
+    for (int v = 0; v < 2; v++) {
+        int argc = 0;
+        argv[argc++] = config->assembler;
+        for (int k = 0; k < config->assembler_arg_count; k++) argv[argc++] = config->assembler_args[k];
+        if (v == 1) argv[argc++] = "--pack-text";
+        argv[argc] = NULL;
+        if (run_program(argv, config->workdir, &sample) < 0) return -1;
+        if (sample.exit_status != 0) {
+            fprintf(stderr, "적재 시간을 잴 오브젝트 프로그램을 만들지 못했습니다. (종료 코드 %d)\n",
+                    sample.exit_status);
+            return -1;
+        }
+        snprintf(from, sizeof(from), "%s/output_objectcode.txt", config->workdir);
+        snprintf(to, sizeof(to), "%s/%s", config->workdir, objects[v]);
+        if (rename(from, to) < 0) {
+            perror(to);
+            return -1;
+        }
+    }
+
+    for (int r = 0; r < config->repeat; r++) {
+        for (int v = 0; v < 2; v++) {
+            const char *link_argv[] = {config->linker, "-f", "image", "-o", "load_image.bin", objects[v], NULL};
+            if (run_program(link_argv, config->workdir, &sample) < 0) return -1;
+            if (sample.exit_status != 0) {
+                fprintf(stderr, "%s를 링커로 적재하지 못했습니다. (종료 코드 %d)\n", objects[v],
+                        sample.exit_status);
+                return -1;
+            }
+            if (r == 0 || sample.nanoseconds < best[v]) best[v] = sample.nanoseconds;
+        }
+    }
+
+    *plain_ns = best[0];
+    *packed_ns = best[1];
+
+    return 0;
+}
+
+/**
+ * @brief 프로그램을 자식 프로세스로 실행하고 실행 시간과 최대 상주 메모리를 잰다.
+ *
+ * @param argv 실행할 프로그램과 인자 (NULL로 끝난다)
+ * @param workdir 자식 프로세스의 작업 디렉터리 (NULL이면 현재 디렉터리)
+ * @param sample 결과를 저장할 구조체 주소
+ * @return 오류 코드 (정상 종료 = 0, 프로그램의 종료 코드는 sample에 저장한다)
+ *
+ * @details
+ * 자식 프로세스의 표준 출력은 버린다. 오류 메시지는 표준 에러로 그대로 보인다.
+ */
+int run_program(const char *const argv[], const char *workdir, benchmark_sample *sample) {
+    struct rusage usage;
+    int status;
+
+    fflush(stdout);
+    long long started = monotonic_ns();
+    pid_t pid = fork();
+    if (pid < 0) {
+        perror("fork 실패");
+        return -1;
+    }
+
+    if (pid == 0) {
+        if (workdir != NULL && chdir(workdir) < 0) {
+            perror("작업 디렉터리 이동 실패");
+            _exit(127);
+        }
+        if (freopen("/dev/null", "w", stdout) == NULL) {
+            _exit(127);
+        }
+        execv(argv[0], (char *const *)argv);
+        perror(argv[0]);
+        _exit(127);
+    }
+
+    if (wait4(pid, &status, 0, &usage) < 0) {
+        perror("wait4 실패");
+        return -1;
+    }
+
+    sample->nanoseconds = monotonic_ns() - started;
+    sample->peak_rss_kb = usage.ru_maxrss;
+    sample->exit_status = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+
+    return 0;
+}
+
+/**
+ * @brief 단조 시계의 현재 시각을 나노초 단위로 반환한다.
+ */
+static long long monotonic_ns(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (long long)now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+/**
+ * @brief 쉼표로 구분한 라인 수 목록을 읽는다.
+ * @return 오류 코드 (정상 종료 = 0)
+ */
+static int parse_sizes(benchmark_config *config, const char *list) {
+    config->size_count = 0;
+
+    for (const char *st = list; *st != '\0';) {
+        char *end;
+        long size = strtol(st, &end, 10);
+        if (end == st || size < 1 || config->size_count == MAX_BENCHMARK_SIZES) {
+            fprintf(stderr, "라인 수 목록 %s이(가) 올바르지 않습니다.\n", list);
+            return -1;
+        }
+        config->sizes[config->size_count++] = (int)size;
+        st = *end == ',' ? end + 1 : end;
+    }
+
+    return config->size_count > 0 ? 0 : -1;
+}
+
+/**
+ * @brief path를 절대 경로로 바꾸어 dest에 저장한다.
+ * @return 오류 코드 (정상 종료 = 0)
+ */
+static int absolute_path(char *dest, const char *path) {
+    if (realpath(path, dest) == NULL) {
+        perror(path);
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief 파일을 복사한다.
+ * @return 오류 코드 (정상 종료 = 0)
+ */
+static int copy_file(const char *from, const char *to) {
+    char buffer[4096];
+    size_t length;
+
+    FILE *in = fopen(from, "rb");
+    if (in == NULL) {
+        perror(from);
+        return -1;
+    }
+    FILE *out = fopen(to, "wb");
+    if (out == NULL) {
+        perror(to);
+        fclose(in);
+        return -1;
+    }
+
+    while ((length = fread(buffer, 1, sizeof(buffer), in)) > 0) {
+        fwrite(buffer, 1, length, out);
+    }
+
+    int err = ferror(in) || ferror(out) ? -1 : 0;
+    fclose(in);
+    fclose(out);
+
+    return err;
+}
+
+/**
+ * @brief 파일의 라인 수를 센다.
+ * @return 라인 수 (파일을 열 수 없으면 -1)
+ */
+static long count_lines(const char *path) {
+    FILE *fp = fopen(path, "r");
+    long lines = 0;
+    int ch;
+
+    if (fp == NULL) {
+        perror(path);
+        return -1;
+    }
+    while ((ch = fgetc(fp)) != EOF) {
+        if (ch == '\n') lines++;
+    }
+    fclose(fp);
+
+    return lines;
+}
@@ -0,0 +1,55 @@
+/**
+ * @file my_benchmark_20221846.h
+ * @date 2024-06-03
+ * @version 0.1.0
+ *
+ * @brief my_benchmark_20221846.c를 위한 매크로 및 구조체 선언부
+ */
+
+#ifndef __MY_BENCHMARK_H__
+#define __MY_BENCHMARK_H__
+
+#include <stdbool.h>
+
+#define MAX_BENCHMARK_SIZES 32
+#define MAX_BENCHMARK_ARGS 64
+#define MAX_BENCHMARK_PATH 4096
+#define DEFAULT_BENCHMARK_REPEAT 3
+#define DEFAULT_BENCHMARK_CSECTS 10
+#define DEFAULT_BENCHMARK_WORKDIR "bench_work"
+
+/**
+ * @brief 벤치마크 설정
+ */
+typedef struct _benchmark_config {
+    char assembler[MAX_BENCHMARK_PATH]; /** 측정할 어셈블러의 절대 경로 */
+    char generator[MAX_BENCHMARK_PATH]; /** 워크로드 생성기의 절대 경로 */
+    char inst_table[MAX_BENCHMARK_PATH]; /** 작업 디렉터리로 복사할 기계어 목록 파일 */
+    char linker[MAX_BENCHMARK_PATH];    /** --pack-text 전후의 적재 시간을 잴 링커 (빈 문자열 = 재지 않음) */
+    const char *workdir;                /** 입력을 만들고 어셈블러를 실행할 디렉터리 */
+    const char *csv_path;               /** 결과를 CSV로도 저장할 경로 (NULL = 저장하지 않음) */
+
+    int sizes[MAX_BENCHMARK_SIZES];     /** 측정할 소스 라인 수 목록 */
+    int size_count;
+    int csects;                         /** 생성할 컨트롤 섹션 수 */
+    int repeat;                         /** 크기마다 어셈블러를 실행할 횟수 (가장 빠른 값을 쓴다) */
+
+    const char *generator_args[MAX_BENCHMARK_ARGS]; /** 생성기에 그대로 넘길 옵션 */
+    int generator_arg_count;
+    const char *assembler_args[MAX_BENCHMARK_ARGS]; /** 어셈블러에 그대로 넘길 옵션 ("--" 뒤) */
+    int assembler_arg_count;
+} benchmark_config;
+
+/**
+ * @brief 자식 프로세스 한 번의 실행 결과
+ */
+typedef struct _benchmark_sample {
+    long long nanoseconds; /** 실행 시간 (단조 시계) */
+    long peak_rss_kb;      /** 최대 상주 메모리 (KB, getrusage의 ru_maxrss) */
+    int exit_status;       /** 종료 코드 (시그널로 종료되면 -1) */
+} benchmark_sample;
+
+int run_program(const char *const argv[], const char *workdir, benchmark_sample *sample);
+int run_benchmark(const benchmark_config *config);
+
+#endif
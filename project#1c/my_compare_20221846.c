@@ -0,0 +1,554 @@
+/**
+ * @file my_compare_20221846.c
+ * @date 2024-06-05
+ * @version 0.1.0
+ *
+ * @brief project#1a와 project#1c 어셈블러를 같은 입력으로 비교하는 프로그램
+ *
+ * @details
+ * 두 구현의 소스를 작업 디렉터리로 복사해 같은 컴파일러로 빌드하고, 교재 예제
+ * (project#1c의 input.txt)와 my_workload_20221846으로 만든 입력들을 차례로 어셈블한다.
+ * 입력마다 가장 빠른 실행 시간, 초당 처리 라인 수, 최대 상주 메모리와 종료 상태를
+ * 표로 출력하고, 오브젝트 프로그램은 컨트롤 섹션과 레코드 종류(H/D/R/T/M/E)별로
+ * 순서대로 짝지어 다른 레코드를 보여 준다. 심볼/리터럴 테이블은 이름과 주소만
+ * 비교한다 (project#1c는 심볼 테이블에 섹션 이름 열을 더 출력한다).
+ *
+ * 비정상 종료한 실행은 시간과 처리량을 출력하지 않고 ("-"), 그 입력의 출력도 비교하지
+ * 않는다. 두 구현이 모두 정상 종료한 입력이 하나도 없으면 비교하지 않았다고 알리고
+ * -1을 반환한다.
+ *
+ * 실행 시간 측정과 자식 프로세스 실행은 my_benchmark_20221846.c의 함수를 그대로
+ * 쓰기 위해 그 파일을 포함하여 컴파일한다 (main은 benchmark_main으로 이름을 바꾼다).
+ *
+ *    컴파일: gcc -O2 -o my_compare_20221846 my_compare_20221846.c -lm
+ *    사용법: my_compare_20221846 [--project-a 디렉터리] [--project-c 디렉터리]
+ *            [--generator 경로] [--cc 컴파일러] [--workdir 디렉터리] [--sizes N,N,...]
+ *            [--csects N] [--repeat N] [--max-diffs N] [생성기 옵션...]
+ */
+
+#define main benchmark_main
+#include "my_benchmark_20221846.c"
+#undef main
+
+#include "my_compare_20221846.h"
+
+static int remove_outputs(const char *workdir);
+static const char *status_name(const benchmark_sample *sample, char *buffer);
+static int collect_records(const record_listing *listing, int section, char type, int indices[]);
+static void print_record(const char *name, const record_listing *listing, int index);
+
+/**
+ * @brief 명령행 옵션을 읽어 두 구현을 빌드하고 비교한다.
+ */
+int main(int argc, char **argv) {
+    static compare_config config;
+    static assembler_impl impls[2] = {
+        {.name = "1a", .source = "my_assembler_a.c", .header = "my_assembler_a.h",
+         .header_alias = "my_assembler_00000000.h"},
+        {.name = "1c", .source = "my_assembler_20221846.c", .header = "my_assembler_20221846.h"},
+    };
+    const char *project_a = "../project#1a";
+    const char *project_c = ".";
+    const char *generator = "./my_workload_20221846";
+    char copy_input[MAX_BENCHMARK_PATH];
+    char input_path[MAX_BENCHMARK_PATH * 2];
+    char lines_arg[16];
+    char csects_arg[16];
+
+    config.cc = "cc";
+    config.max_diffs = DEFAULT_COMPARE_MAX_DIFFS;
+    config.sweep.workdir = DEFAULT_COMPARE_WORKDIR;
+    config.sweep.csects = DEFAULT_COMPARE_CSECTS;
+    config.sweep.repeat = DEFAULT_BENCHMARK_REPEAT;
+    parse_sizes(&config.sweep, "200,1000,2000");
+
+    for (int i = 1; i < argc; i++) {
+        if (i + 1 >= argc) {
+            fprintf(stderr, "옵션 %s에 값이 없습니다.\n", argv[i]);
+            return -1;
+        }
+        if (strcmp(argv[i], "--project-a") == 0) {
+            project_a = argv[++i];
+        } else if (strcmp(argv[i], "--project-c") == 0) {
+            project_c = argv[++i];
+        } else if (strcmp(argv[i], "--generator") == 0) {
+            generator = argv[++i];
+        } else if (strcmp(argv[i], "--cc") == 0) {
+            config.cc = argv[++i];
+        } else if (strcmp(argv[i], "--workdir") == 0) {
+            config.sweep.workdir = argv[++i];
+        } else if (strcmp(argv[i], "--sizes") == 0) {
+            if (parse_sizes(&config.sweep, argv[++i]) < 0) return -1;
+        } else if (strcmp(argv[i], "--csects") == 0) {
+            config.sweep.csects = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--repeat") == 0) {
+            config.sweep.repeat = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--max-diffs") == 0) {
+            config.max_diffs = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--symbol-density") == 0 || strcmp(argv[i], "--literal-density") == 0 ||
+                   strcmp(argv[i], "--extref") == 0 || strcmp(argv[i], "--byte-size") == 0 ||
+                   strcmp(argv[i], "--seed") == 0) {
+            if (config.sweep.generator_arg_count + 2 > MAX_BENCHMARK_ARGS) {
+                fprintf(stderr, "생성기 옵션이 너무 많습니다.\n");
+                return -1;
+            }
+            config.sweep.generator_args[config.sweep.generator_arg_count++] = argv[i];
+            config.sweep.generator_args[config.sweep.generator_arg_count++] = argv[++i];
+        } else {
+            fprintf(stderr, "사용법: %s [--project-a 디렉터리] [--project-c 디렉터리] [--generator 경로] "
+                            "[--cc 컴파일러] [--workdir 디렉터리] [--sizes N,N,...] [--csects N] "
+                            "[--repeat N] [--max-diffs N] [생성기 옵션...]\n", argv[0]);
+            return -1;
+        }
+    }
+
+    if (config.sweep.repeat < 1 || config.max_diffs < 0) {
+        fprintf(stderr, "반복 횟수는 1 이상, 불일치 출력 수는 0 이상이어야 합니다.\n");
+        return -1;
+    }
+
+    if (absolute_path(impls[0].dir, project_a) < 0 || absolute_path(impls[1].dir, project_c) < 0 ||
+        absolute_path(config.sweep.generator, generator) < 0) {
+        return -1;
+    }
+    snprintf(input_path, sizeof(input_path), "%s/input.txt", impls[1].dir);
+    if (absolute_path(copy_input, input_path) < 0) {
+        return -1;
+    }
+
+    if (mkdir(config.sweep.workdir, 0755) < 0 && errno != EEXIST) {
+        perror("작업 디렉터리 생성 실패");
+        return -1;
+    }
+    for (int k = 0; k < 2; k++) {
+        if (build_impl(&config, &impls[k]) < 0) {
+            fprintf(stderr, "build_impl: project#%s를 빌드하지 못했습니다.\n", impls[k].name);
+            return -1;
+        }
+    }
+
+    printf("%-10s %7s %5s %-10s %10s %12s %12s %8s\n",
+           "input", "lines", "impl", "status", "best_ms", "lines/sec", "peak_rss_kb", "records");
+
+    int identical = 0;
+    int compared = 0;
+    int err = 0;
+    for (int c = 0; c <= config.sweep.size_count && err == 0; c++) {
+        static impl_result results[2];
+        char label[32];
+        const char *input = copy_input;
+
+        // 첫 입력은 교재 예제, 나머지는 크기별로 생성한 입력
+        if (c == 0) {
+            snprintf(label, sizeof(label), "copy");
+        } else {
+            const char *argv_gen[MAX_BENCHMARK_ARGS + 16];
+            int argc_gen = 0;
+            benchmark_sample sample;
+
+            snprintf(label, sizeof(label), "gen%d", config.sweep.sizes[c - 1]);
+            snprintf(input_path, sizeof(input_path), "%s/%s.txt", config.sweep.workdir, label);
+            snprintf(lines_arg, sizeof(lines_arg), "%d", config.sweep.sizes[c - 1]);
+            snprintf(csects_arg, sizeof(csects_arg), "%d", config.sweep.csects);
+            argv_gen[argc_gen++] = config.sweep.generator;
+            argv_gen[argc_gen++] = "--lines";
+            argv_gen[argc_gen++] = lines_arg;
+            argv_gen[argc_gen++] = "--csects";
+            argv_gen[argc_gen++] = csects_arg;
+            for (int k = 0; k < config.sweep.generator_arg_count; k++) {
+                argv_gen[argc_gen++] = config.sweep.generator_args[k];
+            }
+            argv_gen[argc_gen++] = "-o";
+            argv_gen[argc_gen++] = input_path;
+            argv_gen[argc_gen] = NULL;
+            if (run_program(argv_gen, NULL, &sample) < 0 || sample.exit_status != 0) {
+                fprintf(stderr, "%s 입력을 생성하지 못했습니다.\n", label);
+                err = -1;
+                break;
+            }
+            input = input_path;
+        }
+
+        long lines = count_lines(input);
+        for (int k = 0; k < 2 && err == 0; k++) {
+            char status[16];
+            impl_result *result = &results[k];
+
+            if ((err = run_impl(&config, &impls[k], input, result)) < 0) {
+                break;
+            }
+            if (result->best.exit_status != 0) {
+                printf("%-10s %7ld %5s %-10s %10s %12s %12ld %8d\n", label, lines, impls[k].name,
+                       status_name(&result->best, status), "-", "-", result->best.peak_rss_kb,
+                       result->objects.count);
+                continue;
+            }
+            double seconds = result->best.nanoseconds / 1e9;
+            printf("%-10s %7ld %5s %-10s %10.3f %12.0f %12ld %8d\n", label, lines, impls[k].name,
+                   status_name(&result->best, status), seconds * 1e3, seconds > 0 ? lines / seconds : 0,
+                   result->best.peak_rss_kb, result->objects.count);
+        }
+
+        // 비정상 종료한 구현의 출력은 중간 단계까지만 만들어졌을 수 있으므로 비교하지 않는다
+        if (err == 0 && (results[0].best.exit_status != 0 || results[1].best.exit_status != 0)) {
+            char status[16];
+            int failed = results[0].best.exit_status != 0 ? 0 : 1;
+            printf("  [%s] %s: 비정상 종료 (%s), 출력을 비교하지 않음\n", label, impls[failed].name,
+                   status_name(&results[failed].best, status));
+        } else if (err == 0) {
+            char name[48];
+            int differ = 0;
+            int count;
+
+            snprintf(name, sizeof(name), "%s objectcode", label);
+            if ((count = diff_records(name, impls, &results[0].objects, &results[1].objects, config.max_diffs)) < 0) {
+                err = -1;
+            }
+            differ += count;
+            snprintf(name, sizeof(name), "%s symtab", label);
+            if ((count = diff_records(name, impls, &results[0].symbols, &results[1].symbols, config.max_diffs)) < 0) {
+                err = -1;
+            }
+            differ += count;
+            snprintf(name, sizeof(name), "%s littab", label);
+            if ((count = diff_records(name, impls, &results[0].literals, &results[1].literals, config.max_diffs)) < 0) {
+                err = -1;
+            }
+            differ += count;
+
+            compared++;
+            if (differ == 0) {
+                identical++;
+            }
+        }
+
+        for (int k = 0; k < 2; k++) {
+            free_records(&results[k].objects);
+            free_records(&results[k].symbols);
+            free_records(&results[k].literals);
+        }
+    }
+
+    if (err < 0) {
+        fprintf(stderr, "비교를 완료하지 못했습니다.\n");
+        return -1;
+    }
+
+    if (compared == 0) {
+        fflush(stdout);
+        fprintf(stderr, "두 구현이 모두 정상 종료한 입력이 없어 출력을 비교하지 않았습니다.\n");
+        return -1;
+    }
+    printf("출력이 같은 입력: %d / %d (비교하지 않은 입력 %d개)\n", identical, compared,
+           config.sweep.size_count + 1 - compared);
+
+    return 0;
+}
+
+/**
+ * @brief 구현 하나의 소스와 기계어 목록을 작업 디렉터리로 복사하고 빌드한다.
+ * @return 오류 코드 (정상 종료 = 0)
+ *
+ * @details
+ * 두 구현을 같은 컴파일러와 같은 최적화 옵션(-O2)으로 빌드해 실행 시간을 공정하게
+ * 비교한다. 경고는 project#1a의 것이 많으므로 끈다.
+ */
+int build_impl(const compare_config *config, assembler_impl *impl) {
+    char from[MAX_BENCHMARK_PATH * 2];
+    char to[MAX_BENCHMARK_PATH * 2];
+    char source[MAX_BENCHMARK_PATH * 2];
+    int status;
+
+    // 실행할 때는 작업 디렉터리를 바꾸므로 절대 경로로 저장한다
+    snprintf(source, sizeof(source), "%s/%s", config->sweep.workdir, impl->name);
+    if (mkdir(source, 0755) < 0 && errno != EEXIST) {
+        perror(source);
+        return -1;
+    }
+    if (absolute_path(impl->workdir, source) < 0) {
+        return -1;
+    }
+
+    const char *files[] = {impl->source, impl->header, "inst_table.txt"};
+    for (int i = 0; i < 3; i++) {
+        snprintf(from, sizeof(from), "%s/%s", impl->dir, files[i]);
+        snprintf(to, sizeof(to), "%s/%s", impl->workdir, files[i]);
+        if (copy_file(from, to) < 0) {
+            return -1;
+        }
+    }
+    if (impl->header_alias != NULL) {
+        snprintf(from, sizeof(from), "%s/%s", impl->dir, impl->header);
+        snprintf(to, sizeof(to), "%s/%s", impl->workdir, impl->header_alias);
+        if (copy_file(from, to) < 0) {
+            return -1;
+        }
+    }
+
+    snprintf(source, sizeof(source), "%s/%s", impl->workdir, impl->source);
+    snprintf(impl->binary, sizeof(impl->binary), "%s/assembler", impl->workdir);
+    const char *argv[] = {config->cc, "-O2", "-w", "-o", impl->binary, source, NULL};
+
+    // 컴파일러는 PATH에서 찾아야 하므로 run_program(execv) 대신 execvp로 실행한다
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid < 0) {
+        perror("fork 실패");
+        return -1;
+    }
+    if (pid == 0) {
+        execvp(argv[0], (char *const *)argv);
+        perror(argv[0]);
+        _exit(127);
+    }
+    if (waitpid(pid, &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief 입력 하나를 구현의 작업 디렉터리에서 여러 번 어셈블하고 출력 파일을 읽는다.
+ *
+ * @param config 비교 설정
+ * @param impl 실행할 구현
+ * @param input 어셈블할 소스 파일
+ * @param result 실행 결과를 저장할 구조체
+ * @return 오류 코드 (정상 종료 = 0, 어셈블러 자체의 실패는 result에 기록한다)
+ *
+ * @details
+ * 실행 전에 이전 출력 파일을 지워 비정상 종료한 구현의 결과가 앞 입력의 출력과
+ * 섞이지 않게 한다. 비정상 종료하면 반복하지 않는다.
+ */
+int run_impl(const compare_config *config, const assembler_impl *impl, const char *input, impl_result *result) {
+    char path[MAX_BENCHMARK_PATH * 2];
+    const char *argv[] = {impl->binary, NULL};
+    benchmark_sample sample;
+
+    snprintf(path, sizeof(path), "%s/input.txt", impl->workdir);
+    if (copy_file(input, path) < 0) {
+        return -1;
+    }
+
+    for (int r = 0; r < config->sweep.repeat; r++) {
+        if (remove_outputs(impl->workdir) < 0 || run_program(argv, impl->workdir, &sample) < 0) {
+            return -1;
+        }
+        if (r == 0 || sample.nanoseconds < result->best.nanoseconds) {
+            long peak_rss_kb = r == 0 ? 0 : result->best.peak_rss_kb;
+            result->best = sample;
+            result->best.peak_rss_kb = peak_rss_kb;
+        }
+        if (sample.peak_rss_kb > result->best.peak_rss_kb) {
+            result->best.peak_rss_kb = sample.peak_rss_kb;
+        }
+        if (sample.exit_status != 0) {
+            result->best.exit_status = sample.exit_status;
+            break;
+        }
+    }
+
+    snprintf(path, sizeof(path), "%s/output_objectcode.txt", impl->workdir);
+    if (read_records(path, &result->objects, true) < 0) return -1;
+    snprintf(path, sizeof(path), "%s/output_symtab.txt", impl->workdir);
+    if (read_records(path, &result->symbols, false) < 0) return -1;
+    snprintf(path, sizeof(path), "%s/output_littab.txt", impl->workdir);
+    if (read_records(path, &result->literals, false) < 0) return -1;
+
+    return 0;
+}
+
+/**
+ * @brief 출력 파일을 한 줄에 레코드 하나씩 읽는다.
+ *
+ * @param path 읽을 파일 (없으면 레코드가 없는 것으로 본다)
+ * @param listing 결과를 저장할 구조체
+ * @param object_program 오브젝트 프로그램이면 H 레코드마다 섹션 번호를 늘리고,
+ *                       아니면 (심볼/리터럴 테이블) 각 줄의 첫 두 열만 남긴다.
+ * @return 오류 코드 (정상 종료 = 0)
+ */
+int read_records(const char *path, record_listing *listing, bool object_program) {
+    char line[MAX_COMPARE_LINE];
+    int capacity = 0;
+    int section = -1;
+
+    listing->lines = NULL;
+    listing->section = NULL;
+    listing->count = 0;
+    listing->object_program = object_program;
+
+    FILE *fp = fopen(path, "r");
+    if (fp == NULL) {
+        return 0;
+    }
+
+    while (fgets(line, sizeof(line), fp) != NULL) {
+        line[strcspn(line, "\r\n")] = '\0';
+        if (line[0] == '\0') {
+            continue;
+        }
+
+        if (object_program) {
+            if (line[0] == 'H') section++;
+        } else {
+            char *tab = strchr(line, '\t');
+            if (tab != NULL && (tab = strchr(tab + 1, '\t')) != NULL) *tab = '\0';
+        }
+
+        if (listing->count == capacity) {
+            capacity = capacity == 0 ? 64 : capacity * 2;
+            char (*lines)[MAX_COMPARE_LINE] = realloc(listing->lines, capacity * sizeof(*lines));
+            int *sections = (int *)realloc(listing->section, capacity * sizeof(int));
+            if (lines != NULL) listing->lines = lines;
+            if (sections != NULL) listing->section = sections;
+            if (lines == NULL || sections == NULL) {
+                fprintf(stderr, "메모리 할당 실패\n");
+                fclose(fp);
+                return -1;
+            }
+        }
+        strcpy(listing->lines[listing->count], line);
+        listing->section[listing->count++] = section < 0 ? 0 : section;
+    }
+
+    fclose(fp);
+
+    return 0;
+}
+
+void free_records(record_listing *listing) {
+    free(listing->lines);
+    free(listing->section);
+    listing->lines = NULL;
+    listing->section = NULL;
+    listing->count = 0;
+}
+
+/**
+ * @brief 두 구현의 출력을 레코드 단위로 비교하여 다른 레코드를 출력한다.
+ *
+ * @param label 출력에 붙일 이름 ("gen1000 objectcode" 등)
+ * @param impls 두 구현 (이름 출력용)
+ * @param a 첫 구현의 레코드
+ * @param b 둘째 구현의 레코드
+ * @param max_diffs 출력할 최대 불일치 수 (센 수는 모두 반환한다)
+ * @return 다른 레코드 수 (오류 시 -1)
+ *
+ * @details
+ * 오브젝트 프로그램은 T 레코드를 나누는 위치나 M 레코드의 위치가 달라도 나머지
+ * 레코드가 모두 어긋나지 않도록 컨트롤 섹션과 레코드 종류마다 k번째 레코드끼리
+ * 비교한다. 심볼/리터럴 테이블은 줄 순서대로 비교한다. 한쪽이 출력 파일을 만들지
+ * 못했으면 레코드를 하나씩 나열하지 않고 한 줄로 알린다.
+ */
+int diff_records(const char *label, const assembler_impl impls[], const record_listing *a,
+                 const record_listing *b, int max_diffs) {
+    static const char types[] = "HDRTME";
+    int sections = 1;
+    int differ = 0;
+
+    if ((a->count == 0) != (b->count == 0)) {
+        const char *missing = a->count == 0 ? impls[0].name : impls[1].name;
+        printf("  [%s] %s: 출력 없음 (상대 구현은 %d개)\n", label, missing, a->count + b->count);
+        return a->count + b->count;
+    }
+
+    for (int i = 0; i < a->count; i++) if (a->section[i] + 1 > sections) sections = a->section[i] + 1;
+    for (int i = 0; i < b->count; i++) if (b->section[i] + 1 > sections) sections = b->section[i] + 1;
+
+    int *a_indices = (int *)malloc((a->count + 1) * sizeof(int));
+    int *b_indices = (int *)malloc((b->count + 1) * sizeof(int));
+    if (a_indices == NULL || b_indices == NULL) {
+        fprintf(stderr, "메모리 할당 실패\n");
+        free(a_indices);
+        free(b_indices);
+        return -1;
+    }
+
+    int type_count = a->object_program ? (int)strlen(types) : 1;
+    for (int s = 0; s < sections; s++) {
+        for (int t = 0; t < type_count; t++) {
+            char type = a->object_program ? types[t] : '\0';
+            int a_count = collect_records(a, s, type, a_indices);
+            int b_count = collect_records(b, s, type, b_indices);
+            int count = a_count > b_count ? a_count : b_count;
+
+            for (int k = 0; k < count; k++) {
+                int ia = k < a_count ? a_indices[k] : -1;
+                int ib = k < b_count ? b_indices[k] : -1;
+                if (ia >= 0 && ib >= 0 && strcmp(a->lines[ia], b->lines[ib]) == 0) {
+                    continue;
+                }
+
+                if (differ++ < max_diffs) {
+                    if (a->object_program) {
+                        printf("  [%s] 섹션 %d %c#%d\n", label, s, type, k);
+                    } else {
+                        printf("  [%s] %d번째 줄\n", label, k + 1);
+                    }
+                    print_record(impls[0].name, a, ia);
+                    print_record(impls[1].name, b, ib);
+                }
+            }
+        }
+    }
+    if (differ > max_diffs) {
+        printf("  [%s] ... 외 %d개 레코드가 다릅니다.\n", label, differ - max_diffs);
+    }
+
+    free(a_indices);
+    free(b_indices);
+
+    return differ;
+}
+
+/**
+ * @brief 이전 실행의 출력 파일을 지운다.
+ * @return 오류 코드 (정상 종료 = 0)
+ */
+static int remove_outputs(const char *workdir) {
+    static const char *const outputs[] = {"output_objectcode.txt", "output_symtab.txt", "output_littab.txt"};
+    char path[MAX_BENCHMARK_PATH * 2];
+
+    for (int i = 0; i < 3; i++) {
+        snprintf(path, sizeof(path), "%s/%s", workdir, outputs[i]);
+        if (unlink(path) < 0 && errno != ENOENT) {
+            perror(path);
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief 종료 상태를 표에 쓸 문자열로 바꾼다.
+ */
+static const char *status_name(const benchmark_sample *sample, char *buffer) {
+    if (sample->exit_status == 0) return "ok";
+    if (sample->exit_status < 0) return "crash";
+
+    // main에서 -1을 반환하면 종료 코드는 255가 된다
+    sprintf(buffer, "exit %d", sample->exit_status);
+    return buffer;
+}
+
+/**
+ * @brief 섹션 section의 type 레코드 인덱스를 순서대로 모은다 (type이 0이면 모든 줄).
+ * @return 모은 레코드 수
+ */
+static int collect_records(const record_listing *listing, int section, char type, int indices[]) {
+    int count = 0;
+
+    for (int i = 0; i < listing->count; i++) {
+        if (listing->section[i] == section && (type == '\0' || listing->lines[i][0] == type)) {
+            indices[count++] = i;
+        }
+    }
+
+    return count;
+}
+
+static void print_record(const char *name, const record_listing *listing, int index) {
+    printf("      %-3s %s\n", name, index < 0 ? "(없음)" : listing->lines[index]);
+}
@@ -0,0 +1,75 @@
+/**
+ * @file my_compare_20221846.h
+ * @date 2024-06-05
+ * @version 0.1.0
+ *
+ * @brief my_compare_20221846.c를 위한 매크로 및 구조체 선언부
+ */
+
+#ifndef __MY_COMPARE_H__
+#define __MY_COMPARE_H__
+
+#include <stdbool.h>
+
+#include "my_benchmark_20221846.h"
+
+#define MAX_COMPARE_CASES (MAX_BENCHMARK_SIZES + 1) /** 예제 입력(input.txt) + 생성한 입력 */
+#define MAX_COMPARE_LINE 256
+#define DEFAULT_COMPARE_CSECTS 3
+#define DEFAULT_COMPARE_MAX_DIFFS 5
+#define DEFAULT_COMPARE_WORKDIR "compare_work"
+
+/**
+ * @brief 비교할 어셈블러 구현 하나
+ *
+ * @details
+ * project#1a는 헤더를 "my_assembler_00000000.h"라는 이름으로 포함하므로 빌드할 때
+ * header를 header_alias 이름으로도 복사한다.
+ */
+typedef struct _assembler_impl {
+    const char *name;         /** 결과 표에 쓰는 이름 */
+    const char *source;       /** 소스 파일 이름 */
+    const char *header;       /** 헤더 파일 이름 */
+    const char *header_alias; /** 소스가 포함하는 헤더 이름 (header와 같으면 NULL) */
+    char dir[MAX_BENCHMARK_PATH];    /** 소스가 있는 디렉터리 */
+    char workdir[MAX_BENCHMARK_PATH]; /** 빌드하고 실행하는 디렉터리 */
+    char binary[MAX_BENCHMARK_PATH + 16]; /** 빌드한 실행 파일 */
+} assembler_impl;
+
+/**
+ * @brief 비교 설정
+ */
+typedef struct _compare_config {
+    benchmark_config sweep; /** 생성기, 입력 크기, 반복 횟수, 작업 디렉터리 */
+    const char *cc;         /** 두 구현을 빌드할 C 컴파일러 */
+    int max_diffs;          /** 입력마다 출력할 최대 불일치 레코드 수 */
+} compare_config;
+
+/**
+ * @brief 오브젝트 프로그램 파일 하나를 레코드 단위로 읽은 결과
+ */
+typedef struct _record_listing {
+    char (*lines)[MAX_COMPARE_LINE];
+    int *section;        /** 레코드가 속한 컨트롤 섹션 번호 (H 레코드마다 1씩 증가) */
+    int count;
+    bool object_program; /** 오브젝트 프로그램이면 섹션과 레코드 종류별로 비교한다 */
+} record_listing;
+
+/**
+ * @brief 입력 하나에 대한 한 구현의 실행 결과
+ */
+typedef struct _impl_result {
+    benchmark_sample best; /** 가장 빠른 실행 (peak_rss_kb는 최댓값) */
+    record_listing objects;
+    record_listing symbols;
+    record_listing literals;
+} impl_result;
+
+int build_impl(const compare_config *config, assembler_impl *impl);
+int run_impl(const compare_config *config, const assembler_impl *impl, const char *input, impl_result *result);
+int read_records(const char *path, record_listing *listing, bool object_program);
+void free_records(record_listing *listing);
+int diff_records(const char *label, const assembler_impl impls[], const record_listing *a,
+                 const record_listing *b, int max_diffs);
+
+#endif
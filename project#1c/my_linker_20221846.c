@@ -0,0 +1,1049 @@
+/**
+ * @file my_linker_20221846.c
+ * @date 2024-05-20
+ * @version 0.1.0
+ *
+ * @brief 여러 개의 object program을 하나의 절대 로드 이미지로 링크하는 프로그램
+ *
+ * @details
+ * my_assembler_20221846이 출력한 object program(H/D/R/T/M/E 레코드)을 텍스트
+ * 혹은 바이너리(--binary) 형식으로 여러 개 입력받아 외부 심볼 테이블(ESTAB)을 만들고, 모든 수정 레코드를 적용한 뒤
+ * 하나의 절대 로드 이미지(H/T/E 레코드) 혹은 시뮬레이터가 파싱 없이 바로 매핑할
+ * 수 있는 바이너리 메모리 이미지를 출력한다. 패스 1에서는 컨트롤 섹션의
+ * 주소(CSADDR)를 정하고 D 레코드로 ESTAB을 만들며, 패스 2에서는 T 레코드를
+ * 메모리 이미지에 적재하고 섹션 단위로 모은 M 레코드를 한꺼번에 적용한다.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <ctype.h>
+
+#include "my_linker_20221846.h"
+
+static int hex_value(const char *str, int length);
+static void copy_external_name(char *dest, const char *src, int length);
+static unsigned int estab_hash(const char *name);
+static int push_modification(modification **mods, int *mod_count, int *mod_capacity,
+                             int addr, int half_bytes, int value);
+static bool relocation_bit(const object_file *file, const object_record *rec, int index);
+static int apply_modifications(link_context *ctx, const modification *mods,
+                               int mod_count);
+static void put_u32(unsigned char *buffer, unsigned int value);
+static int split_lines(object_file *file);
+static int read_binary_names(object_file *file);
+static int next_record(const object_file *file, int *cursor, object_record *rec);
+static int parse_text_record(const char *line, object_record *rec);
+static int next_define(const object_file *file, const unsigned char **cursor,
+                       const unsigned char *end, char *name, int *addr);
+static int read_varint(const unsigned char **cursor, const unsigned char *end,
+                       unsigned int *value);
+
+/**
+ * @brief 명령행으로 받은 object program들을 링크하여 로드 이미지를 출력한다.
+ *
+ * @details
+ * 사용법: my_linker_20221846 [-a 로드주소(16진수)] [-f text|image] [-o 출력파일]
+ *         오브젝트파일...
+ * 오브젝트 파일을 지정하지 않으면 output_objectcode.txt를 링크한다. `-f text`
+ * (기본값)는 H/T/E 레코드로 된 로드 이미지를, `-f image`는 바이너리 메모리
+ * 이미지를 출력한다. 출력 파일을 지정하지 않으면 각각 output_loadimage.txt,
+ * output_memimage.bin에 결과를 저장한다.
+ */
+int main(int argc, char **argv) {
+    /** 링크 과정 전체의 상태 */
+    link_context *ctx = (link_context *)malloc(sizeof(link_context));
+    const char *output_dir = NULL;
+    bool memory_image = false;
+    int progaddr = 0;
+    int err = 0;
+
+    if (ctx == NULL) {
+        fprintf(stderr, "메모리 할당 실패\n");
+        return -1;
+    }
+
+    // 로드 주소와 출력 파일 옵션 처리
+    int argi = 1;
+    for (; argi < argc && argv[argi][0] == '-'; argi++) {
+        if (strcmp(argv[argi], "-a") == 0 && argi + 1 < argc) {
+            progaddr = (int)strtol(argv[++argi], NULL, 16);
+        } else if (strcmp(argv[argi], "-o") == 0 && argi + 1 < argc) {
+            output_dir = argv[++argi];
+        } else if (strcmp(argv[argi], "-f") == 0 && argi + 1 < argc &&
+                   (strcmp(argv[argi + 1], "text") == 0 || strcmp(argv[argi + 1], "image") == 0)) {
+            memory_image = strcmp(argv[++argi], "image") == 0;
+        } else {
+            fprintf(stderr,
+                    "사용법: %s [-a 로드주소] [-f text|image] [-o 출력파일] "
+                    "오브젝트파일...\n",
+                    argv[0]);
+            return -1;
+        }
+    }
+    if (output_dir == NULL) {
+        output_dir = memory_image ? "output_memimage.bin" : "output_loadimage.txt";
+    }
+
+    if ((err = init_link_context(ctx, progaddr)) < 0) {
+        fprintf(stderr,
+                "init_link_context: 링커 초기화에 실패했습니다. "
+                "(error_code: %d)\n",
+                err);
+        return -1;
+    }
+
+    if (argi == argc) {
+        err = read_object_file(ctx, "output_objectcode.txt");
+    }
+    for (; argi < argc && err == 0; argi++) {
+        err = read_object_file(ctx, argv[argi]);
+    }
+    if (err < 0) {
+        fprintf(stderr,
+                "read_object_file: 오브젝트 파일 입력에 실패했습니다. "
+                "(error_code: %d)\n",
+                err);
+        return -1;
+    }
+
+    if ((err = link_pass1(ctx)) < 0) {
+        fprintf(stderr,
+                "link_pass1: 링커 패스1 과정에서 실패했습니다. "
+                "(error_code: %d)\n",
+                err);
+        return -1;
+    }
+
+    if ((err = link_pass2(ctx)) < 0) {
+        fprintf(stderr,
+                "link_pass2: 링커 패스2 과정에서 실패했습니다. "
+                "(error_code: %d)\n",
+                err);
+        return -1;
+    }
+
+    if (memory_image) {
+        if ((err = make_memory_image_output(output_dir,
+                                            (const link_context *)ctx)) < 0) {
+            fprintf(stderr,
+                    "make_memory_image_output: 메모리 이미지 파일 출력 과정에서 "
+                    "실패했습니다. (error_code: %d)\n",
+                    err);
+            return -1;
+        }
+    } else if ((err = make_load_image_output(output_dir,
+                                             (const link_context *)ctx)) < 0) {
+        fprintf(stderr,
+                "make_load_image_output: 로드 이미지 파일 출력 과정에서 "
+                "실패했습니다. (error_code: %d)\n",
+                err);
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief 링크 상태 구조체를 초기화한다.
+ *
+ * @param ctx 링크 상태 구조체 주소
+ * @param progaddr 프로그램이 로드될 시작 주소
+ * @return 오류 코드 (정상 종료 = 0)
+ */
+int init_link_context(link_context *ctx, int progaddr) {
+    if (progaddr < 0 || progaddr >= SIC_XE_MEMORY_SIZE) {
+        fprintf(stderr, "잘못된 로드 주소입니다. %X\n", progaddr);
+        return -1;
+    }
+
+    ctx->file_count = 0;
+    ctx->section_count = 0;
+    ctx->sections = (load_section *)malloc(MAX_LINK_SECTIONS * sizeof(load_section));
+    if (ctx->sections == NULL) {
+        fprintf(stderr, "메모리 할당 실패\n");
+        return -2;
+    }
+
+    // ESTAB 초기화: 모든 버킷을 비어 있는 상태(-1)로 만든다
+    for (int i = 0; i < ESTAB_BUCKET_COUNT; i++) {
+        ctx->symtab.buckets[i] = -1;
+    }
+    ctx->symtab.length = 0;
+    ctx->symtab.capacity = 256;
+    ctx->symtab.entries = (estab_entry *)malloc(ctx->symtab.capacity * sizeof(estab_entry));
+    if (ctx->symtab.entries == NULL) {
+        fprintf(stderr, "메모리 할당 실패\n");
+        return -2;
+    }
+
+    ctx->progaddr = progaddr;
+    ctx->program_length = 0;
+    ctx->exec_addr = -1;
+    ctx->memory = NULL;
+    ctx->loaded = NULL;
+
+    return 0;
+}
+
+/**
+ * @brief 오브젝트 파일 하나를 통째로 읽어 레코드 단위로 읽을 준비를 한다.
+ *
+ * @param ctx 링크 상태 구조체 주소
+ * @param path 오브젝트 파일 경로
+ * @return 오류 코드 (정상 종료 = 0)
+ *
+ * @details
+ * 파일이 BINARY_OBJECT_MAGIC으로 시작하면 바이너리 오브젝트 파일로, 그렇지
+ * 않으면 텍스트 오브젝트 파일로 취급한다.
+ */
+int read_object_file(link_context *ctx, const char *path) {
+    FILE *fp;
+    long size;
+
+    if (ctx->file_count == MAX_LINK_FILES) {
+        fprintf(stderr, "오브젝트 파일이 너무 많습니다. (최대 %d개)\n", MAX_LINK_FILES);
+        return -1;
+    }
+
+    fp = fopen(path, "rb");
+    if (fp == NULL) {
+        perror(path);
+        return -1;
+    }
+
+    // 파일 크기만큼 버퍼를 할당하여 한 번에 읽는다
+    fseek(fp, 0, SEEK_END);
+    size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+
+    object_file *file = &ctx->files[ctx->file_count];
+    file->path = path;
+    file->size = size;
+    file->buffer = (char *)malloc(size + 1);
+    if (file->buffer == NULL) {
+        fprintf(stderr, "메모리 할당 실패\n");
+        fclose(fp);
+        return -2;
+    }
+    if (fread(file->buffer, 1, size, fp) != (size_t)size) {
+        fprintf(stderr, "%s 읽기 실패\n", path);
+        fclose(fp);
+        return -1;
+    }
+    file->buffer[size] = '\0';
+    fclose(fp);
+
+    file->binary = size >= 5 && memcmp(file->buffer, BINARY_OBJECT_MAGIC, 4) == 0;
+    file->lines = NULL;
+    file->line_count = 0;
+    file->names = NULL;
+    file->name_count = 0;
+    file->record_start = 0;
+
+    int err = file->binary ? read_binary_names(file) : split_lines(file);
+    if (err < 0) {
+        return err;
+    }
+
+    ctx->file_count++;
+
+    return 0;
+}
+
+/**
+ * @brief 텍스트 오브젝트 파일을 라인 단위로 나눈다.
+ */
+static int split_lines(object_file *file) {
+    // 라인 개수를 먼저 센 뒤 라인 포인터 배열을 만든다
+    int line_capacity = 1;
+    for (long i = 0; i < file->size; i++) {
+        if (file->buffer[i] == '\n') line_capacity++;
+    }
+    file->lines = (char **)malloc(line_capacity * sizeof(char *));
+    if (file->lines == NULL) {
+        fprintf(stderr, "메모리 할당 실패\n");
+        return -2;
+    }
+
+    char *line = file->buffer;
+    while (*line != '\0') {
+        char *end = line;
+        while (*end != '\0' && *end != '\n') end++;
+
+        char *next = (*end == '\n') ? end + 1 : end;
+        *end = '\0';
+        // 줄 끝의 '\r' 및 공백 제거 (R 레코드의 패딩 공백 포함)
+        while (end > line && (end[-1] == '\r' || end[-1] == ' ')) {
+            *--end = '\0';
+        }
+
+        if (end > line) {
+            file->lines[file->line_count++] = line;
+        }
+        line = next;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief 바이너리 오브젝트 파일의 버전을 확인하고 N 레코드의 이름 테이블을
+ * 읽는다.
+ */
+static int read_binary_names(object_file *file) {
+    const unsigned char *data = (const unsigned char *)file->buffer;
+    const unsigned char *cursor = data + 5;
+    const unsigned char *end = data + file->size;
+    unsigned int length;
+    unsigned int count;
+
+    if (data[4] != BINARY_OBJECT_VERSION) {
+        fprintf(stderr, "%s: 지원하지 않는 바이너리 오브젝트 버전입니다. (%d)\n",
+                file->path, data[4]);
+        return -1;
+    }
+
+    file->record_start = 5;
+    if (cursor == end || *cursor != NAME_RECORD) {
+        return 0;
+    }
+
+    cursor++;
+    if (read_varint(&cursor, end, &length) < 0 || length > (unsigned int)(end - cursor)) {
+        fprintf(stderr, "%s: 잘못된 N 레코드입니다.\n", file->path);
+        return -1;
+    }
+    end = cursor + length;
+    file->record_start = (int)(end - data);
+
+    if (read_varint(&cursor, end, &count) < 0 || count > length) {
+        fprintf(stderr, "%s: 잘못된 N 레코드입니다.\n", file->path);
+        return -1;
+    }
+    file->names = malloc((count + 1) * sizeof(*file->names));
+    if (file->names == NULL) {
+        fprintf(stderr, "메모리 할당 실패\n");
+        return -2;
+    }
+
+    for (unsigned int i = 0; i < count; i++) {
+        if (cursor == end || *cursor > end - cursor - 1) {
+            fprintf(stderr, "%s: 잘못된 N 레코드입니다.\n", file->path);
+            return -1;
+        }
+        int name_length = *cursor++;
+        copy_external_name(file->names[i], (const char *)cursor,
+                           name_length < MAX_EXTERNAL_NAME ? name_length : MAX_EXTERNAL_NAME);
+        cursor += name_length;
+    }
+    file->name_count = count;
+
+    return 0;
+}
+
+/**
+ * @brief `cursor` 위치의 레코드 하나를 해석하고 다음 레코드로 이동한다.
+ *
+ * @return 1 = 레코드를 읽음, 0 = 파일의 끝, 음수 = 잘못된 레코드
+ */
+static int next_record(const object_file *file, int *cursor, object_record *rec) {
+    rec->position = *cursor;
+
+    if (!file->binary) {
+        if (*cursor >= file->line_count) {
+            return 0;
+        }
+        rec->position = *cursor + 1;
+        return parse_text_record(file->lines[(*cursor)++], rec);
+    }
+
+    const unsigned char *data = (const unsigned char *)file->buffer;
+    const unsigned char *p = data + *cursor;
+    const unsigned char *end = data + file->size;
+    unsigned int length;
+    unsigned int value;
+
+    if (p == end) {
+        return 0;
+    }
+
+    rec->type = (char)*p++;
+    if (read_varint(&p, end, &length) < 0 || length > (unsigned int)(end - p)) {
+        return -1;
+    }
+    end = p + length;
+    *cursor = (int)(end - data);
+
+    switch (rec->type) {
+        case HEADER_RECORD:
+            if (read_varint(&p, end, &value) < 0 || value >= (unsigned int)file->name_count) return -1;
+            strcpy(rec->name, file->names[value]);
+            if (read_varint(&p, end, &value) < 0) return -1;
+            rec->addr = value;
+            if (read_varint(&p, end, &value) < 0) return -1;
+            rec->length = value;
+            break;
+        case DEFINE_RECORD:
+            if (read_varint(&p, end, &value) < 0) return -1;
+            rec->length = value;
+            rec->data = p;
+            rec->data_end = end;
+            break;
+        case TEXT_RECORD:
+            if (read_varint(&p, end, &value) < 0) return -1;
+            rec->addr = value;
+            rec->data = p;
+            rec->length = (int)(end - p);
+            break;
+        case BITMASK_TEXT_RECORD:
+            if (read_varint(&p, end, &value) < 0) return -1;
+            rec->addr = value;
+            if (read_varint(&p, end, &value) < 0 || value > (unsigned int)(end - p)) return -1;
+            rec->length = value;
+            if ((unsigned int)(end - p) != (value + 7) / 8 + value) return -1;
+            rec->mask = p;
+            rec->data = p + (value + 7) / 8;
+            break;
+        case MODIFY_RECORD:
+            if (read_varint(&p, end, &value) < 0 || p == end) return -1;
+            rec->addr = value;
+            rec->length = *p++;
+            if (read_varint(&p, end, &value) < 0 || (value >> 1) >= (unsigned int)file->name_count) return -1;
+            strcpy(rec->name, file->names[value >> 1]);
+            rec->negative = value & 1;
+            break;
+        case END_RECORD:
+            rec->addr = -1;
+            if (p < end && *p++ != 0) {
+                if (read_varint(&p, end, &value) < 0) return -1;
+                rec->addr = value;
+            }
+            break;
+        default:
+            // R, N 등 링크에 필요 없는 레코드는 건너뛴다
+            break;
+    }
+
+    return 1;
+}
+
+/**
+ * @brief 텍스트 레코드 한 줄을 해석한다.
+ * @return 1 = 정상, -1 = 잘못된 레코드
+ */
+static int parse_text_record(const char *line, object_record *rec) {
+    int length = strlen(line);
+
+    rec->type = line[0];
+    switch (rec->type) {
+        case HEADER_RECORD:
+            if (length < 19) return -1;
+            copy_external_name(rec->name, line + 1, MAX_EXTERNAL_NAME);
+            rec->addr = hex_value(line + 7, 6);
+            rec->length = hex_value(line + 13, 6);
+            break;
+        case DEFINE_RECORD:
+            // 이름(6) + 주소(6) 쌍의 반복
+            rec->length = (length - 1) / 12;
+            rec->data = (const unsigned char *)line + 1;
+            rec->data_end = (const unsigned char *)line + length;
+            break;
+        case TEXT_RECORD:
+            if (length < 9) return -1;
+            rec->addr = hex_value(line + 1, 6);
+            rec->length = hex_value(line + 7, 2);
+            rec->data = (const unsigned char *)line + 9;
+            if (length - 9 < rec->length * 2) return -1;
+            break;
+        case BITMASK_TEXT_RECORD:
+            // 길이 필드 뒤에 (길이 + 3) / 4자리의 비트마스크가 온다
+            if (length < 9) return -1;
+            rec->addr = hex_value(line + 1, 6);
+            rec->length = hex_value(line + 7, 2);
+            rec->mask = (const unsigned char *)line + 9;
+            rec->data = rec->mask + (rec->length + 3) / 4;
+            if (length - 9 < (rec->length + 3) / 4 + rec->length * 2) return -1;
+            break;
+        case MODIFY_RECORD:
+            if (length < 11) return -1;
+            rec->addr = hex_value(line + 1, 6);
+            rec->length = hex_value(line + 7, 2);
+            rec->negative = line[9] == '-';
+            copy_external_name(rec->name, line + 10, MAX_EXTERNAL_NAME);
+            break;
+        case END_RECORD:
+            rec->addr = (line[1] != '\0') ? hex_value(line + 1, 6) : -1;
+            break;
+        case REFERENCE_RECORD:
+            break;
+        default:
+            return -1;
+    }
+
+    return 1;
+}
+
+/**
+ * @brief D 레코드의 다음 엔트리(이름, 주소)를 읽는다.
+ * @return 1 = 엔트리를 읽음, 0 = 엔트리의 끝, -1 = 잘못된 엔트리
+ */
+static int next_define(const object_file *file, const unsigned char **cursor,
+                       const unsigned char *end, char *name, int *addr) {
+    if (*cursor >= end) {
+        return 0;
+    }
+
+    if (!file->binary) {
+        if (end - *cursor < 12) return 0;
+        copy_external_name(name, (const char *)*cursor, MAX_EXTERNAL_NAME);
+        *addr = hex_value((const char *)*cursor + 6, 6);
+        *cursor += 12;
+        return 1;
+    }
+
+    unsigned int value;
+    if (read_varint(cursor, end, &value) < 0 || value >= (unsigned int)file->name_count) return -1;
+    strcpy(name, file->names[value]);
+    if (read_varint(cursor, end, &value) < 0) return -1;
+    *addr = value;
+
+    return 1;
+}
+
+/**
+ * @brief LEB128 varint 하나를 읽는다.
+ * @return 오류 코드 (정상 종료 = 0)
+ */
+static int read_varint(const unsigned char **cursor, const unsigned char *end,
+                       unsigned int *value) {
+    unsigned int result = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+        if (*cursor >= end) {
+            return -1;
+        }
+        unsigned char byte = *(*cursor)++;
+        result |= (unsigned int)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            *value = result;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief 링커 패스 1 과정을 수행한다.
+ *
+ * @param ctx 링크 상태 구조체 주소
+ * @return 오류 코드 (정상 종료 = 0)
+ *
+ * @details
+ * 모든 오브젝트 파일의 H, D, E 레코드만 읽어 각 컨트롤 섹션의 로드 주소를
+ * 정하고, 컨트롤 섹션 이름과 외부 정의 심볼을 ESTAB에 등록한다.
+ */
+int link_pass1(link_context *ctx) {
+    int csaddr = ctx->progaddr;
+    load_section *section = NULL;
+    object_record rec;
+
+    for (int f = 0; f < ctx->file_count; f++) {
+        const object_file *file = &ctx->files[f];
+        int cursor = file->record_start;
+        int status;
+
+        while ((status = next_record(file, &cursor, &rec)) > 0) {
+            if (rec.type == HEADER_RECORD) {
+                if (ctx->section_count == MAX_LINK_SECTIONS) {
+                    fprintf(stderr, "컨트롤 섹션이 너무 많습니다. (최대 %d개)\n",
+                            MAX_LINK_SECTIONS);
+                    return -1;
+                }
+
+                section = &ctx->sections[ctx->section_count];
+                strcpy(section->name, rec.name);
+                section->start_addr = rec.addr;
+                section->length = rec.length;
+                section->csaddr = csaddr;
+                section->file = f;
+                section->first_record = cursor;
+                section->end_record = file->binary ? file->size : file->line_count;
+
+                if (estab_insert(&ctx->symtab, section->name, csaddr, ctx->section_count) < 0) {
+                    fprintf(stderr, "%s:%d: 컨트롤 섹션 %s이(가) 중복 정의되었습니다.\n",
+                            file->path, rec.position, section->name);
+                    return -1;
+                }
+
+                csaddr += section->length;
+                ctx->section_count++;
+                continue;
+            }
+
+            if (section == NULL) {
+                fprintf(stderr, "%s:%d: H 레코드 이전에 %c 레코드가 있습니다.\n",
+                        file->path, rec.position, rec.type);
+                return -1;
+            }
+
+            int offset = section->csaddr - section->start_addr;
+
+            if (rec.type == DEFINE_RECORD) {
+                const unsigned char *entry = rec.data;
+                char name[MAX_EXTERNAL_NAME + 1];
+                int addr;
+                int found;
+
+                while ((found = next_define(file, &entry, rec.data_end, name, &addr)) > 0) {
+                    if (estab_insert(&ctx->symtab, name, addr + offset,
+                                     ctx->section_count - 1) < 0) {
+                        fprintf(stderr, "%s:%d: 외부 심볼 %s이(가) 중복 정의되었습니다.\n",
+                                file->path, rec.position, name);
+                        return -1;
+                    }
+                }
+                if (found < 0) {
+                    fprintf(stderr, "%s:%d: 잘못된 D 레코드입니다.\n", file->path, rec.position);
+                    return -1;
+                }
+            } else if (rec.type == END_RECORD) {
+                section->end_record = cursor;
+                // 처음으로 실행 주소가 지정된 섹션에서 실행을 시작한다
+                if (ctx->exec_addr == -1 && rec.addr != -1) {
+                    ctx->exec_addr = rec.addr + offset;
+                }
+                section = NULL;
+            }
+        }
+
+        if (status < 0) {
+            fprintf(stderr, "%s:%d: 잘못된 레코드입니다.\n", file->path, rec.position);
+            return -1;
+        }
+
+        // 파일이 E 레코드 없이 끝난 경우 다음 파일로 섹션이 이어지지 않게 한다
+        section = NULL;
+    }
+
+    ctx->program_length = csaddr - ctx->progaddr;
+    if (csaddr > SIC_XE_MEMORY_SIZE) {
+        fprintf(stderr, "프로그램이 메모리 크기를 초과합니다. (%X > %X)\n",
+                csaddr, SIC_XE_MEMORY_SIZE);
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief 링커 패스 2 과정을 수행한다.
+ *
+ * @param ctx 링크 상태 구조체 주소
+ * @return 오류 코드 (정상 종료 = 0)
+ *
+ * @details
+ * 컨트롤 섹션 단위로 T 레코드를 메모리 이미지에 적재하고, 같은 섹션의 M
+ * 레코드는 ESTAB에서 심볼 값을 찾아 배열에 모아 두었다가 섹션의 E 레코드에
+ * 도달했을 때 한꺼번에 적용한다. 정의되지 않은 외부 심볼은 모두 보고한 뒤
+ * 오류를 반환한다.
+ */
+int link_pass2(link_context *ctx) {
+    int err = 0;
+    int mod_capacity = 256;
+    modification *mods = (modification *)malloc(mod_capacity * sizeof(modification));
+    object_record rec;
+
+    ctx->memory = (unsigned char *)calloc(ctx->program_length + 1, 1);
+    ctx->loaded = (bool *)calloc(ctx->program_length + 1, sizeof(bool));
+    if (mods == NULL || ctx->memory == NULL || ctx->loaded == NULL) {
+        fprintf(stderr, "메모리 할당 실패\n");
+        return -2;
+    }
+    // 적재되지 않은 영역(RESB/RESW 등)은 시뮬레이터의 초기 메모리 값으로 둔다
+    memset(ctx->memory, MEMORY_IMAGE_FILL, ctx->program_length + 1);
+
+    for (int s = 0; s < ctx->section_count; s++) {
+        const load_section *section = &ctx->sections[s];
+        const object_file *file = &ctx->files[section->file];
+        int offset = section->csaddr - section->start_addr;
+        int section_end = section->csaddr + section->length;
+        int mod_count = 0;
+        int cursor = section->first_record;
+
+        while (cursor < section->end_record && next_record(file, &cursor, &rec) > 0) {
+            if (rec.type == TEXT_RECORD || rec.type == BITMASK_TEXT_RECORD) {
+                int addr = rec.addr + offset;
+
+                if (addr < section->csaddr || addr + rec.length > section_end) {
+                    fprintf(stderr, "%s:%d: T 레코드가 섹션 범위를 벗어납니다.\n",
+                            file->path, rec.position);
+                    err = -1;
+                    continue;
+                }
+
+                int index = addr - ctx->progaddr;
+                if (file->binary) {
+                    memcpy(ctx->memory + index, rec.data, rec.length);
+                } else {
+                    for (int j = 0; j < rec.length; j++) {
+                        ctx->memory[index + j] = (unsigned char)hex_value((const char *)rec.data + j * 2, 2);
+                    }
+                }
+                memset(ctx->loaded + index, true, rec.length * sizeof(bool));
+
+                // 비트마스크가 가리키는 3바이트 필드에는 섹션의 로드 주소를 더한다
+                for (int j = 0; rec.type == BITMASK_TEXT_RECORD && j < rec.length; j++) {
+                    if (relocation_bit(file, &rec, j) &&
+                        push_modification(&mods, &mod_count, &mod_capacity, addr + j, 6, offset) < 0) {
+                        return -2;
+                    }
+                }
+            } else if (rec.type == MODIFY_RECORD) {
+                const estab_entry *entry = estab_search(&ctx->symtab, rec.name);
+                if (entry == NULL) {
+                    fprintf(stderr, "%s:%d: 외부 심볼 %s을(를) 찾을 수 없습니다.\n",
+                            file->path, rec.position, rec.name);
+                    err = -1;
+                    continue;
+                }
+
+                if (push_modification(&mods, &mod_count, &mod_capacity, rec.addr + offset,
+                                      rec.length, rec.negative ? -entry->addr : entry->addr) < 0) {
+                    return -2;
+                }
+            }
+        }
+
+        // 섹션의 수정 레코드를 한꺼번에 적용
+        if (apply_modifications(ctx, mods, mod_count) < 0) {
+            err = -1;
+        }
+    }
+
+    free(mods);
+
+    return err;
+}
+
+/**
+ * @brief 수정 레코드 배열에 엔트리 하나를 추가한다. 배열이 가득 차면 두 배로 늘린다.
+ * @return 0 = 정상, -2 = 메모리 할당 실패 (배열은 해제된다)
+ */
+static int push_modification(modification **mods, int *mod_count, int *mod_capacity,
+                             int addr, int half_bytes, int value) {
+    if (*mod_count == *mod_capacity) {
+        *mod_capacity *= 2;
+        modification *grown = (modification *)realloc(*mods, *mod_capacity * sizeof(modification));
+        if (grown == NULL) {
+            fprintf(stderr, "메모리 할당 실패\n");
+            free(*mods);
+            return -2;
+        }
+        *mods = grown;
+    }
+
+    modification *mod = &(*mods)[(*mod_count)++];
+    mod->addr = addr;
+    mod->half_bytes = half_bytes;
+    mod->value = value;
+
+    return 0;
+}
+
+/**
+ * @brief B 레코드의 `index`번째 바이트에 재배치 비트가 켜져 있는지 확인한다.
+ */
+static bool relocation_bit(const object_file *file, const object_record *rec, int index) {
+    if (file->binary) {
+        return rec->mask[index / 8] & (0x80 >> (index % 8));
+    }
+    return hex_value((const char *)rec->mask + index / 4, 1) & (0x08 >> (index % 4));
+}
+
+/**
+ * @brief 모아 둔 수정 레코드를 메모리 이미지에 적용한다.
+ */
+static int apply_modifications(link_context *ctx, const modification *mods,
+                               int mod_count) {
+    int err = 0;
+
+    for (int i = 0; i < mod_count; i++) {
+        int half_bytes = mods[i].half_bytes;
+        int byte_count = (half_bytes + 1) / 2;
+        int index = mods[i].addr - ctx->progaddr;
+
+        if (half_bytes <= 0 || half_bytes > 8 || index < 0 ||
+            index + byte_count > ctx->program_length) {
+            fprintf(stderr, "잘못된 M 레코드입니다. (주소 %06X, 길이 %02X)\n",
+                    mods[i].addr, half_bytes);
+            err = -1;
+            continue;
+        }
+
+        // 필드를 빅 엔디언으로 읽고, 하위 half_bytes 자리만 수정한다
+        unsigned int field = 0;
+        for (int j = 0; j < byte_count; j++) {
+            field = (field << 8) | ctx->memory[index + j];
+        }
+
+        unsigned int mask = (half_bytes == 8) ? 0xFFFFFFFFu : ((1u << (half_bytes * 4)) - 1);
+        field = (field & ~mask) | ((field + (unsigned int)mods[i].value) & mask);
+
+        for (int j = byte_count - 1; j >= 0; j--) {
+            ctx->memory[index + j] = (unsigned char)(field & 0xFF);
+            field >>= 8;
+        }
+    }
+
+    return err;
+}
+
+/**
+ * @brief ESTAB에 심볼을 추가한다.
+ * @return 오류 코드 (정상 종료 = 0, 이미 정의된 심볼 = -1)
+ */
+int estab_insert(estab *symtab, const char *name, int addr, int section) {
+    unsigned int bucket = estab_hash(name) & (ESTAB_BUCKET_COUNT - 1);
+
+    for (int i = symtab->buckets[bucket]; i != -1; i = symtab->entries[i].next) {
+        if (strcmp(symtab->entries[i].name, name) == 0) {
+            return -1;
+        }
+    }
+
+    if (symtab->length == symtab->capacity) {
+        int capacity = symtab->capacity * 2;
+        estab_entry *grown = (estab_entry *)realloc(symtab->entries, capacity * sizeof(estab_entry));
+        if (grown == NULL) {
+            fprintf(stderr, "메모리 할당 실패\n");
+            return -2;
+        }
+        symtab->entries = grown;
+        symtab->capacity = capacity;
+    }
+
+    estab_entry *entry = &symtab->entries[symtab->length];
+    strcpy(entry->name, name);
+    entry->addr = addr;
+    entry->section = section;
+    entry->next = symtab->buckets[bucket];
+    symtab->buckets[bucket] = symtab->length;
+    symtab->length++;
+
+    return 0;
+}
+
+/**
+ * @brief ESTAB에서 주어진 이름의 심볼을 검색한다.
+ * @return 찾은 엔트리의 포인터, 찾지 못하면 NULL 반환
+ */
+const estab_entry *estab_search(const estab *symtab, const char *name) {
+    unsigned int bucket = estab_hash(name) & (ESTAB_BUCKET_COUNT - 1);
+
+    for (int i = symtab->buckets[bucket]; i != -1; i = symtab->entries[i].next) {
+        if (strcmp(symtab->entries[i].name, name) == 0) {
+            return &symtab->entries[i];
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief 심볼 이름의 FNV-1a 해시 값을 계산한다.
+ */
+static unsigned int estab_hash(const char *name) {
+    unsigned int hash = 2166136261u;
+    for (; *name != '\0'; name++) {
+        hash ^= (unsigned char)*name;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * @brief 16진수 문자열 앞부분 `length` 글자를 정수로 변환한다.
+ * 16진수가 아닌 문자를 만나면 그 앞까지만 변환한다.
+ */
+static int hex_value(const char *str, int length) {
+    int value = 0;
+    for (int i = 0; i < length; i++) {
+        char ch = str[i];
+        int digit;
+        if (ch >= '0' && ch <= '9') {
+            digit = ch - '0';
+        } else if (ch >= 'A' && ch <= 'F') {
+            digit = ch - 'A' + 10;
+        } else if (ch >= 'a' && ch <= 'f') {
+            digit = ch - 'a' + 10;
+        } else {
+            break;
+        }
+        value = (value << 4) | digit;
+    }
+    return value;
+}
+
+/**
+ * @brief 고정 길이 레코드 필드에서 이름을 복사하고 뒤쪽 공백을 제거한다.
+ */
+static void copy_external_name(char *dest, const char *src, int length) {
+    int i = 0;
+    for (; i < length && src[i] != '\0'; i++) {
+        dest[i] = src[i];
+    }
+    while (i > 0 && dest[i - 1] == ' ') i--;
+    dest[i] = '\0';
+}
+
+/**
+ * @brief 링크된 절대 로드 이미지를 파일로 출력한다. `load_image_dir`이 NULL인
+ * 경우 결과를 stdout으로 출력한다.
+ *
+ * @param load_image_dir 로드 이미지를 저장할 파일 경로, 혹은 NULL
+ * @param ctx 링크 상태 구조체 주소
+ * @return 오류 코드 (정상 종료 = 0)
+ *
+ * @details
+ * 프로그램 전체에 대한 H 레코드 하나, 실제로 적재된 바이트 구간만을 담은 절대
+ * 주소 T 레코드들, 그리고 실행 시작 주소를 담은 E 레코드를 출력한다. D/R/M
+ * 레코드는 출력하지 않는다.
+ */
+int make_load_image_output(const char *load_image_dir,
+                           const link_context *ctx) {
+    static const char hex_digits[] = "0123456789ABCDEF";
+    FILE *fp;
+    char record[10 + LOAD_IMAGE_TEXT_LENGTH * 2 + 2];
+
+    if (load_image_dir == NULL) {
+        fp = stdout;
+    } else {
+        fp = fopen(load_image_dir, "w");
+        if (fp == NULL) {
+            perror(load_image_dir);
+            return -1;
+        }
+    }
+
+    const char *name = ctx->section_count > 0 ? ctx->sections[0].name : "";
+    fprintf(fp, "H%-6s%06X%06X\n", name, ctx->progaddr, ctx->program_length);
+
+    // 적재된 바이트가 연속된 구간마다 최대 LOAD_IMAGE_TEXT_LENGTH 바이트씩 출력
+    int index = 0;
+    while (index < ctx->program_length) {
+        if (!ctx->loaded[index]) {
+            index++;
+            continue;
+        }
+
+        int length = 0;
+        char *cursor = record + 9;
+        while (index + length < ctx->program_length && ctx->loaded[index + length] &&
+               length < LOAD_IMAGE_TEXT_LENGTH) {
+            unsigned char byte = ctx->memory[index + length];
+            *cursor++ = hex_digits[byte >> 4];
+            *cursor++ = hex_digits[byte & 0x0F];
+            length++;
+        }
+        *cursor++ = '\n';
+        *cursor = '\0';
+
+        // 레코드 헤더는 데이터를 채운 뒤 앞부분에 기록한다
+        char header[10];
+        snprintf(header, sizeof(header), "T%06X%02X", ctx->progaddr + index, length);
+        memcpy(record, header, 9);
+        fputs(record, fp);
+
+        index += length;
+    }
+
+    fprintf(fp, "E%06X\n", ctx->exec_addr == -1 ? ctx->progaddr : ctx->exec_addr);
+
+    if (load_image_dir != NULL) {
+        fclose(fp);
+    }
+
+    return 0;
+}
+
+/**
+ * @brief 링크된 프로그램을 바이너리 메모리 이미지 파일로 출력한다.
+ *
+ * @param memory_image_dir 메모리 이미지를 저장할 파일 경로
+ * @param ctx 링크 상태 구조체 주소
+ * @return 오류 코드 (정상 종료 = 0)
+ *
+ * @details
+ * 헤더, 섹션 테이블, 심볼 테이블(ESTAB) 뒤에 재배치가 끝난 메모리 내용을
+ * MEMORY_IMAGE_PAGE_SIZE 경계에 맞추어 그대로 기록한다. 형식은
+ * my_linker_20221846.h에 정리되어 있다. 로더는 메모리 영역을 파일에서 곧바로
+ * 매핑할 수 있으므로 레코드 수와 무관하게 일정한 시간에 적재를 마칠 수 있다.
+ */
+int make_memory_image_output(const char *memory_image_dir,
+                             const link_context *ctx) {
+    FILE *fp;
+    int table_size = MEMORY_IMAGE_HEADER_SIZE +
+                     (ctx->section_count + ctx->symtab.length) * MEMORY_IMAGE_ENTRY_SIZE;
+    int memory_offset = (table_size + MEMORY_IMAGE_PAGE_SIZE - 1) /
+                        MEMORY_IMAGE_PAGE_SIZE * MEMORY_IMAGE_PAGE_SIZE;
+
+    // 헤더와 테이블 영역을 페이지 경계까지 한 번에 만든다 (남는 부분은 0)
+    unsigned char *table = (unsigned char *)calloc(memory_offset, 1);
+    if (table == NULL) {
+        fprintf(stderr, "메모리 할당 실패\n");
+        return -2;
+    }
+
+    memcpy(table, MEMORY_IMAGE_MAGIC, 4);
+    table[4] = (MEMORY_IMAGE_VERSION >> 8) & 0xFF;
+    table[5] = MEMORY_IMAGE_VERSION & 0xFF;
+    put_u32(table + 8, ctx->exec_addr == -1 ? ctx->progaddr : ctx->exec_addr);
+    put_u32(table + 12, ctx->progaddr);
+    put_u32(table + 16, ctx->program_length);
+    put_u32(table + 20, memory_offset);
+    put_u32(table + 24, ctx->section_count);
+    put_u32(table + 28, ctx->symtab.length);
+
+    unsigned char *entry = table + MEMORY_IMAGE_HEADER_SIZE;
+    for (int i = 0; i < ctx->section_count; i++, entry += MEMORY_IMAGE_ENTRY_SIZE) {
+        strncpy((char *)entry, ctx->sections[i].name, MEMORY_IMAGE_NAME_LENGTH);
+        put_u32(entry + 8, ctx->sections[i].csaddr);
+        put_u32(entry + 12, ctx->sections[i].length);
+    }
+    for (int i = 0; i < ctx->symtab.length; i++, entry += MEMORY_IMAGE_ENTRY_SIZE) {
+        strncpy((char *)entry, ctx->symtab.entries[i].name, MEMORY_IMAGE_NAME_LENGTH);
+        put_u32(entry + 8, ctx->symtab.entries[i].addr);
+        put_u32(entry + 12, ctx->symtab.entries[i].section);
+    }
+
+    fp = fopen(memory_image_dir, "wb");
+    if (fp == NULL) {
+        perror(memory_image_dir);
+        free(table);
+        return -1;
+    }
+
+    if (fwrite(table, 1, memory_offset, fp) != (size_t)memory_offset ||
+        fwrite(ctx->memory, 1, ctx->program_length, fp) != (size_t)ctx->program_length) {
+        fprintf(stderr, "%s 쓰기 실패\n", memory_image_dir);
+        fclose(fp);
+        free(table);
+        return -1;
+    }
+
+    fclose(fp);
+    free(table);
+
+    return 0;
+}
+
+/**
+ * @brief 32비트 정수를 빅 엔디언으로 버퍼에 기록한다.
+ */
+static void put_u32(unsigned char *buffer, unsigned int value) {
+    buffer[0] = (value >> 24) & 0xFF;
+    buffer[1] = (value >> 16) & 0xFF;
+    buffer[2] = (value >> 8) & 0xFF;
+    buffer[3] = value & 0xFF;
+}
@@ -0,0 +1,159 @@
+/**
+ * @file my_linker_20221846.h
+ * @date 2024-05-20
+ * @version 0.1.0
+ *
+ * @brief my_linker_20221846.c를 위한 매크로 및 구조체 선언부
+ */
+
+#ifndef __MY_LINKER_H__
+#define __MY_LINKER_H__
+
+#include <stdbool.h>
+
+#include "my_assembler_20221846.h"
+
+#define MAX_LINK_FILES 1024
+#define MAX_LINK_SECTIONS 4096
+#define MAX_EXTERNAL_NAME 6
+#define ESTAB_BUCKET_COUNT 4096 /** 2의 거듭제곱이어야 한다 */
+#define SIC_XE_MEMORY_SIZE 0x100000
+#define LOAD_IMAGE_TEXT_LENGTH 0x1E
+
+/**
+ * 메모리 이미지 파일(-f image)의 형식. 모든 정수는 빅 엔디언으로 저장한다.
+ *    =================================================================
+ *     0  | magic "SXIM" (4) | version (2) | reserved (2)             |
+ *     8  | entry (4) | progaddr (4) | memory_length (4)              |
+ *     20 | memory_offset (4) | section_count (4) | symbol_count (4)   |
+ *     32 | section table: name (8) | csaddr (4) | length (4)  x N    |
+ *        | symbol table : name (8) | addr (4)   | section (4) x M    |
+ *        | (MEMORY_IMAGE_PAGE_SIZE 경계까지 0으로 채움)               |
+ *     memory_offset | progaddr부터 memory_length 바이트의 메모리 내용 |
+ *    =================================================================
+ */
+#define MEMORY_IMAGE_MAGIC "SXIM"
+#define MEMORY_IMAGE_VERSION 1
+#define MEMORY_IMAGE_HEADER_SIZE 32
+#define MEMORY_IMAGE_ENTRY_SIZE 16
+#define MEMORY_IMAGE_NAME_LENGTH 8
+#define MEMORY_IMAGE_PAGE_SIZE 4096
+#define MEMORY_IMAGE_FILL 0xFF /** 적재되지 않은 바이트의 값 */
+
+/**
+ * @brief 외부 심볼 테이블(ESTAB)의 엔트리 하나를 저장하는 구조체
+ *
+ * @details
+ * H 레코드의 컨트롤 섹션 이름과 D 레코드의 외부 정의 심볼을 저장한다. 같은
+ * 버킷에 속한 엔트리는 `next` 인덱스로 연결된다.
+ */
+typedef struct _estab_entry {
+    char name[MAX_EXTERNAL_NAME + 1]; /** 심볼 이름 */
+    int addr;                         /** 심볼의 절대 주소 */
+    int section;                      /** 심볼이 정의된 섹션의 인덱스 */
+    int next;                         /** 같은 버킷의 다음 엔트리 (-1 = 끝) */
+} estab_entry;
+
+/**
+ * @brief 해시 기반 외부 심볼 테이블
+ */
+typedef struct _estab {
+    int buckets[ESTAB_BUCKET_COUNT]; /** 버킷별 첫 엔트리 인덱스 */
+    estab_entry *entries;            /** 엔트리 배열 */
+    int length;                      /** 엔트리 개수 */
+    int capacity;                    /** 엔트리 배열의 크기 */
+} estab;
+
+/**
+ * @brief 로드 시점에 한꺼번에 적용할 수정 레코드 하나를 저장하는 구조체
+ */
+typedef struct _modification {
+    int addr;       /** 수정할 필드의 절대 주소 */
+    int half_bytes; /** 수정할 필드의 길이 (half-byte 단위) */
+    int value;      /** 더하거나 뺄 값 (부호 포함) */
+} modification;
+
+/**
+ * @brief 링크 대상 컨트롤 섹션 하나에 대한 정보를 저장하는 구조체
+ */
+typedef struct _load_section {
+    char name[MAX_EXTERNAL_NAME + 1]; /** 컨트롤 섹션 이름 */
+    int start_addr;                   /** H 레코드의 시작 주소 */
+    int length;                       /** 컨트롤 섹션의 길이 */
+    int csaddr;                       /** 컨트롤 섹션이 로드될 절대 주소 */
+    int file;                         /** 섹션이 속한 오브젝트 파일 인덱스 */
+    int first_record;                 /** H 레코드 다음 레코드의 위치 */
+    int end_record;                   /** E 레코드 다음 레코드의 위치 */
+} load_section;
+
+/**
+ * @brief 읽어 들인 오브젝트 파일 하나를 저장하는 구조체
+ *
+ * @details
+ * 파일 전체를 한 번에 읽는다. 텍스트 파일은 개행 문자를 '\0'으로 바꾸어
+ * 라인 단위로 나누고, `lines`의 각 원소는 `buffer` 내부를 가리킨다. 바이너리
+ * 오브젝트 파일은 N 레코드의 이름 테이블만 미리 읽어 두고 나머지 레코드는
+ * `buffer`에서 곧바로 해석한다. 레코드의 위치는 텍스트 파일에서는 라인 번호,
+ * 바이너리 파일에서는 바이트 오프셋이다.
+ */
+typedef struct _object_file {
+    const char *path; /** 파일 경로 */
+    char *buffer;     /** 파일 전체 내용 */
+    long size;        /** 파일 크기 */
+    bool binary;      /** 바이너리 오브젝트 파일 여부 */
+
+    char **lines;   /** 각 라인의 시작 주소 (텍스트) */
+    int line_count; /** 라인 개수 (텍스트) */
+
+    char (*names)[MAX_EXTERNAL_NAME + 1]; /** 이름 테이블 (바이너리) */
+    int name_count;                       /** 이름 개수 (바이너리) */
+    int record_start;                     /** 첫 레코드의 위치 */
+} object_file;
+
+/**
+ * @brief 텍스트/바이너리 형식과 무관하게 해석한 레코드 하나
+ */
+typedef struct _object_record {
+    char type;                        /** 레코드 종류 (H/D/R/T/B/M/E) */
+    int position;                     /** 오류 메시지용 레코드 위치 */
+    char name[MAX_EXTERNAL_NAME + 1]; /** H: 섹션 이름, M: 심볼 이름 */
+    int addr;                         /** H/T/M: 주소, E: 실행 주소 (-1 = 없음) */
+    int length;                       /** H: 섹션 길이, T/B: 바이트 수, M: half-byte 수 */
+    bool negative;                    /** M: 부호가 '-'인지 여부 */
+    const unsigned char *data;        /** T/B: 데이터, D: 첫 엔트리 */
+    const unsigned char *data_end;    /** D: 엔트리의 끝 */
+    const unsigned char *mask;        /** B: 재배치 비트마스크 (텍스트 파일에서는 hex) */
+} object_record;
+
+/**
+ * @brief 링크 과정 전체의 상태를 저장하는 구조체
+ */
+typedef struct _link_context {
+    object_file files[MAX_LINK_FILES]; /** 입력 오브젝트 파일 */
+    int file_count;
+
+    load_section *sections; /** 입력된 모든 컨트롤 섹션 */
+    int section_count;
+
+    estab symtab; /** 외부 심볼 테이블 */
+
+    int progaddr;       /** 프로그램이 로드될 시작 주소 */
+    int program_length; /** 모든 섹션 길이의 합 */
+    int exec_addr;      /** 실행 시작 주소 (-1 = 지정되지 않음) */
+
+    unsigned char *memory; /** 절대 로드 이미지 */
+    bool *loaded;          /** 바이트별로 T 레코드가 채워졌는지 여부 */
+} link_context;
+
+int init_link_context(link_context *ctx, int progaddr);
+int read_object_file(link_context *ctx, const char *path);
+int link_pass1(link_context *ctx);
+int link_pass2(link_context *ctx);
+int estab_insert(estab *symtab, const char *name, int addr, int section);
+const estab_entry *estab_search(const estab *symtab, const char *name);
+int make_load_image_output(const char *load_image_dir,
+                           const link_context *ctx);
+int make_memory_image_output(const char *memory_image_dir,
+                             const link_context *ctx);
+
+#endif
@@ -0,0 +1,565 @@
+/**
+ * @file my_microbench_20221846.c
+ * @date 2024-06-04
+ * @version 0.1.0
+ *
+ * @brief 어셈블러의 검색/인코딩 함수를 따로 떼어 호출당 시간을 재는 프로그램
+ *
+ * @details
+ * search_opcode, search_symbol, search_literal, add_literal, reg_code, format3or4,
+ * token_parsing, generate_directive_object_code를 고정 시드로 만든 입력으로 반복
+ * 호출하여 호출당 나노초(ns/op)를 출력한다. 측정마다 한 번 미리 실행해 캐시와 분기
+ * 예측기를 데운 뒤, 최소 측정 시간을 넘는 반복 횟수를 찾아 여러 번 재고 최솟값과
+ * 중앙값을 보고한다. 테이블 구조나 함수 구현을 바꾼 뒤 같은 시드와 테이블 크기로
+ * 다시 실행하면 결과를 그대로 비교할 수 있다.
+ *
+ * 어셈블러의 현재 구현을 그대로 재기 위해 my_assembler_20221846.c를 함께 포함하여
+ * 컴파일한다 (main은 assembler_main으로 이름을 바꾼다). 이때 NO_ASSEMBLER_INSTRUMENTATION을
+ * 정의하여 --stats/--alloc-sites용 검색 횟수 카운터와 할당 함수 래퍼를 빼고 함수
+ * 본체만 잰다 (어셈블러 실행 파일에서는 할당 횟수를 세는 래퍼가 항상 동작한다).
+ *
+ *    컴파일: gcc -O2 -o my_microbench_20221846 my_microbench_20221846.c
+ *    사용법: my_microbench_20221846 [--filter 이름] [--table-size N] [--seed N]
+ *            [--min-time 밀리초] [--repeat N] [--inst-table 경로]
+ */
+
+#define NO_ASSEMBLER_INSTRUMENTATION
+#define main assembler_main
+#include "my_assembler_20221846.c"
+#undef main
+
+#include "my_microbench_20221846.h"
+
+static unsigned int next_random(unsigned int *state);
+static void clear_token(token *tok);
+static int compare_ns(const void *a, const void *b);
+
+static void prepare_opcode_hit(microbench_state *state);
+static void prepare_opcode_miss(microbench_state *state);
+static void prepare_symbol_hit(microbench_state *state);
+static void prepare_symbol_miss(microbench_state *state);
+static void prepare_literal_hit(microbench_state *state);
+static void prepare_literal_miss(microbench_state *state);
+static void prepare_literal_new(microbench_state *state);
+static void prepare_registers(microbench_state *state);
+static void prepare_lines(microbench_state *state);
+static long run_search_opcode(microbench_state *state, long iterations);
+static long run_search_symbol(microbench_state *state, long iterations);
+static long run_search_literal(microbench_state *state, long iterations);
+static long run_add_literal_new(microbench_state *state, long iterations);
+static long run_add_literal_dup(microbench_state *state, long iterations);
+static long run_reg_code(microbench_state *state, long iterations);
+static long run_format3or4(microbench_state *state, long iterations);
+static long run_token_parsing(microbench_state *state, long iterations);
+static long run_directive(microbench_state *state, long iterations);
+
+static volatile long microbench_sink; /** 측정 결과를 모아 호출이 최적화로 사라지지 않게 한다 */
+
+/**
+ * 측정에 쓰는 예제 라인. format3or4와 token_parsing은 아래 명령어 라인을,
+ * generate_directive_object_code는 BYTE/WORD 라인을 차례로 사용한다.
+ */
+static const char *const sample_instructions[] = {
+    "FIRST\tSTL\tRETADR",
+    "\tLDB\t#LENGTH",
+    "CLOOP\t+JSUB\tRDREC",
+    "\tLDA\tLENGTH",
+    "\tCOMP\t#0",
+    "\tJEQ\tENDFIL",
+    "\tLDT\t=X'000010'",
+    "\tSTCH\tBUFFER,X",
+    "\tJ\t@RETADR",
+    "\tLDA\t=C'EOF'",
+    "\t+STA\tBUFFER",
+    "\tRSUB",
+};
+static const char *const sample_directives[] = {
+    "EOF\tBYTE\tC'EOF'",
+    "OUTPUT\tBYTE\tX'05'",
+    "MSG\tBYTE\tC'SYNTHETIC SIC/XE WORKLOAD PAYLOAD'",
+    "MAXLEN\tWORD\t4096",
+};
+static const char *const sample_lines[] = {
+    "COPY\tSTART\t0",
+    "\tEXTDEF\tBUFFER,BUFEND,LENGTH",
+    "\tEXTREF\tRDREC,WRREC",
+    "FIRST\tSTL\tRETADR",
+    "CLOOP\t+JSUB\tRDREC",
+    "\tLDA\tLENGTH",
+    "\tCOMP\t#0",
+    "\tLDT\t=X'000010'",
+    "\tSTCH\tBUFFER,X",
+    "\tCOMPR\tA,S",
+    "BUFEND\tEQU\t*",
+    "MAXLEN\tEQU\tBUFEND-BUFFER",
+    ".\tSUBROUTINE TO READ RECORD INTO BUFFER",
+    "EOF\tBYTE\tC'EOF'",
+    "RETADR\tRESW\t1",
+    "\tRSUB",
+};
+
+static const microbench_case microbench_cases[] = {
+    {"search_opcode/hit", prepare_opcode_hit, run_search_opcode},
+    {"search_opcode/miss", prepare_opcode_miss, run_search_opcode},
+    {"search_symbol/hit", prepare_symbol_hit, run_search_symbol},
+    {"search_symbol/miss", prepare_symbol_miss, run_search_symbol},
+    {"search_literal/hit", prepare_literal_hit, run_search_literal},
+    {"search_literal/miss", prepare_literal_miss, run_search_literal},
+    {"add_literal/new", prepare_literal_new, run_add_literal_new},
+    {"add_literal/dup", prepare_literal_hit, run_add_literal_dup},
+    {"reg_code", prepare_registers, run_reg_code},
+    {"format3or4", NULL, run_format3or4},
+    {"token_parsing", prepare_lines, run_token_parsing},
+    {"generate_directive_object_code", NULL, run_directive},
+};
+
+/**
+ * @brief 명령행 옵션을 읽어 선택한 측정을 수행한다.
+ */
+int main(int argc, char **argv) {
+    static microbench_state state;
+    const char *inst_table_dir = "inst_table.txt";
+    const char *filter = NULL;
+    int table_size = DEFAULT_MICROBENCH_TABLE_SIZE;
+    unsigned int seed = DEFAULT_MICROBENCH_SEED;
+    long long min_time_ms = DEFAULT_MICROBENCH_MIN_TIME_MS;
+    int repeat = DEFAULT_MICROBENCH_REPEAT;
+
+    for (int i = 1; i < argc; i++) {
+        if (i + 1 >= argc) {
+            fprintf(stderr, "옵션 %s에 값이 없습니다.\n", argv[i]);
+            return -1;
+        }
+        if (strcmp(argv[i], "--filter") == 0) {
+            filter = argv[++i];
+        } else if (strcmp(argv[i], "--table-size") == 0) {
+            table_size = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0) {
+            seed = (unsigned int)strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--min-time") == 0) {
+            min_time_ms = atoll(argv[++i]);
+        } else if (strcmp(argv[i], "--repeat") == 0) {
+            repeat = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--inst-table") == 0) {
+            inst_table_dir = argv[++i];
+        } else {
+            fprintf(stderr, "사용법: %s [--filter 이름] [--table-size N] [--seed N] "
+                            "[--min-time 밀리초] [--repeat N] [--inst-table 경로]\n", argv[0]);
+            return -1;
+        }
+    }
+
+    if (table_size < 1 || table_size > MAX_TABLE_LENGTH) {
+        fprintf(stderr, "테이블 크기는 1 ~ %d 사이여야 합니다.\n", MAX_TABLE_LENGTH);
+        return -1;
+    }
+    if (repeat < 1 || repeat > MAX_MICROBENCH_REPEAT || min_time_ms < 1) {
+        fprintf(stderr, "반복 횟수는 1 ~ %d, 최소 측정 시간은 1ms 이상이어야 합니다.\n", MAX_MICROBENCH_REPEAT);
+        return -1;
+    }
+
+    if (init_microbench_state(&state, inst_table_dir, table_size, seed) < 0) {
+        fprintf(stderr, "init_microbench_state: 측정 입력을 만들지 못했습니다.\n");
+        free_microbench_state(&state);
+        return -1;
+    }
+
+    printf("# seed %u, table size %d, repeat %d, min time %lldms\n", seed, table_size, repeat, min_time_ms);
+    printf("%-32s %12s %10s %10s\n", "benchmark", "iterations", "min_ns/op", "med_ns/op");
+
+    int err = 0;
+    for (size_t i = 0; i < sizeof(microbench_cases) / sizeof(microbench_cases[0]); i++) {
+        if (filter != NULL && strstr(microbench_cases[i].name, filter) == NULL) {
+            continue;
+        }
+        if ((err = run_microbench(&state, &microbench_cases[i], min_time_ms * 1000000LL, repeat)) < 0) {
+            fprintf(stderr, "run_microbench: %s 측정에 실패했습니다.\n", microbench_cases[i].name);
+            break;
+        }
+    }
+
+    free_microbench_state(&state);
+
+    return err < 0 ? -1 : 0;
+}
+
+/**
+ * @brief 측정 경우 하나를 수행하고 결과 한 줄을 출력한다.
+ *
+ * @param state 측정 입력
+ * @param bench 측정 경우
+ * @param min_time_ns 측정 한 번의 최소 시간
+ * @param repeat 측정 횟수
+ * @return 오류 코드 (정상 종료 = 0)
+ *
+ * @details
+ * 입력을 준비한 뒤 한 번 실행하여 캐시를 데우고, 반복 횟수를 두 배씩 늘려 한 번의
+ * 측정이 min_time_ns를 넘는 횟수를 찾는다. 그 횟수로 repeat번 측정하여 호출당
+ * 시간의 최솟값과 중앙값을 출력한다.
+ */
+int run_microbench(microbench_state *state, const microbench_case *bench, long long min_time_ns,
+                   int repeat) {
+    long long samples[MAX_MICROBENCH_REPEAT];
+    long iterations = 1;
+
+    if (bench->prepare != NULL) {
+        bench->prepare(state);
+    }
+
+    // 캐시를 데우고 최소 측정 시간을 넘는 반복 횟수를 찾는다
+    for (;;) {
+        long long started = monotonic_ns();
+        microbench_sink += bench->run(state, iterations);
+        long long elapsed = monotonic_ns() - started;
+        if (elapsed >= min_time_ns || iterations >= (1L << 40)) {
+            break;
+        }
+        iterations *= elapsed * 2 < min_time_ns ? 2 : (long)(min_time_ns * 1.2 / (elapsed + 1)) + 1;
+    }
+
+    for (int r = 0; r < repeat; r++) {
+        long long started = monotonic_ns();
+        microbench_sink += bench->run(state, iterations);
+        samples[r] = monotonic_ns() - started;
+    }
+    qsort(samples, repeat, sizeof(samples[0]), compare_ns);
+
+    printf("%-32s %12ld %10.2f %10.2f\n", bench->name, iterations,
+           (double)samples[0] / iterations, (double)samples[repeat / 2] / iterations);
+    fflush(stdout);
+
+    return 0;
+}
+
+/**
+ * @brief 기계어 목록과 심볼/리터럴 테이블, 예제 토큰을 만든다.
+ *
+ * @param state 채울 측정 입력
+ * @param inst_table_dir 기계어 목록 파일 경로
+ * @param table_size 심볼/리터럴 테이블에 넣을 항목 수
+ * @param seed 키를 고르는 난수 시드
+ * @return 오류 코드 (정상 종료 = 0)
+ *
+ * @details
+ * 심볼은 "S0000"부터, 리터럴은 "=X'000000'"부터 차례로 만들고 컨트롤 섹션 4개에
+ * 번갈아 배정한다. format3or4에는 교재의 COPY 프로그램과 같은 주소의 작은 심볼
+ * 테이블을 따로 두어 인코딩 비용만 재도록 한다.
+ */
+int init_microbench_state(microbench_state *state, const char *inst_table_dir, int table_size,
+                          unsigned int seed) {
+    static const struct {
+        const char *name;
+        int addr;
+    } copy_symbols[] = {
+        {"FIRST", 0x0000}, {"CLOOP", 0x0003}, {"ENDFIL", 0x0015}, {"RETADR", 0x0030},
+        {"LENGTH", 0x0033}, {"BUFFER", 0x0036}, {"BUFEND", 0x1036},
+    };
+    char csect[20];
+
+    state->table_size = table_size;
+    state->seed = seed;
+
+    if (init_inst_table(state->inst_table, &state->inst_table_length, inst_table_dir) < 0) {
+        return -1;
+    }
+
+    for (int i = 0; i < table_size; i++) {
+        char name[20];
+        sprintf(csect, "SEC%d", i % 4);
+        sprintf(name, "S%04d", i);
+        add_symbol(state->symbol_table, &state->symbol_table_length, name, i * 3, csect);
+        sprintf(name, "=X'%06X'", i);
+        add_literal(state->literal_table, &state->literal_table_length, name, i * 3, csect);
+    }
+    if (state->symbol_table_length != table_size || state->literal_table_length != table_size) {
+        return -1;
+    }
+
+    for (size_t i = 0; i < sizeof(copy_symbols) / sizeof(copy_symbols[0]); i++) {
+        add_symbol(state->copy_symbols, &state->copy_symbol_length, copy_symbols[i].name,
+                   copy_symbols[i].addr, "COPY");
+    }
+    add_literal(state->copy_literals, &state->copy_literal_length, "=X'000010'", 0x002D, "COPY");
+    add_literal(state->copy_literals, &state->copy_literal_length, "=C'EOF'", 0x002A, "COPY");
+
+    for (size_t i = 0; i < sizeof(sample_instructions) / sizeof(sample_instructions[0]); i++) {
+        token *tok = (token *)malloc(sizeof(token));
+        if (tok == NULL) {
+            return -1;
+        }
+        init_token(tok);
+        state->instructions[state->instruction_count++] = tok;
+        if (token_parsing(sample_instructions[i], tok, (const inst **)state->inst_table,
+                          state->inst_table_length) < 0) {
+            return -1;
+        }
+
+        int index = search_opcode(tok->operator, (const inst **)state->inst_table, state->inst_table_length);
+        if (index < 0) {
+            return -1;
+        }
+        state->instruction_opcode[i] = state->inst_table[index]->op;
+        state->instruction_format[i] = tok->operator[0] == '+' ? 4 : state->inst_table[index]->format;
+    }
+
+    for (size_t i = 0; i < sizeof(sample_directives) / sizeof(sample_directives[0]); i++) {
+        token *tok = (token *)malloc(sizeof(token));
+        if (tok == NULL) {
+            return -1;
+        }
+        init_token(tok);
+        state->directives[state->directive_count++] = tok;
+        if (token_parsing(sample_directives[i], tok, (const inst **)state->inst_table,
+                          state->inst_table_length) < 0) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief 측정 입력이 가진 메모리를 모두 해제한다.
+ */
+void free_microbench_state(microbench_state *state) {
+    for (int i = 0; i < state->inst_table_length; i++) free(state->inst_table[i]);
+    for (int i = 0; i < state->symbol_table_length; i++) free(state->symbol_table[i]);
+    for (int i = 0; i < state->literal_table_length; i++) free(state->literal_table[i]);
+    for (int i = 0; i < state->scratch_literal_length; i++) free(state->scratch_literals[i]);
+    for (int i = 0; i < state->copy_symbol_length; i++) free(state->copy_symbols[i]);
+    for (int i = 0; i < state->copy_literal_length; i++) free(state->copy_literals[i]);
+    for (int i = 0; i < state->instruction_count; i++) free_token(state->instructions[i]);
+    for (int i = 0; i < state->directive_count; i++) free_token(state->directives[i]);
+}
+
+/**
+ * @brief xorshift32 난수를 반환한다. 같은 시드는 항상 같은 키를 만든다.
+ */
+static unsigned int next_random(unsigned int *state) {
+    unsigned int x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+/**
+ * @brief 토큰이 가진 문자열을 해제하고 비운다 (토큰 자체는 해제하지 않는다).
+ */
+static void clear_token(token *tok) {
+    free(tok->label);
+    free(tok->operator);
+    for (int i = 0; i < MAX_OPERAND_PER_INST; i++) {
+        free(tok->operand[i]);
+    }
+    free(tok->comment);
+    free(tok->expr);
+    init_token(tok);
+}
+
+static int compare_ns(const void *a, const void *b) {
+    long long x = *(const long long *)a;
+    long long y = *(const long long *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief 기계어 목록의 이름을 무작위로 고른다. 3/4형식은 절반을 '+'로 시작하게 한다.
+ */
+static void prepare_opcode_hit(microbench_state *state) {
+    unsigned int seed = state->seed;
+    for (int i = 0; i < MICROBENCH_KEYS; i++) {
+        const inst *in = state->inst_table[next_random(&seed) % state->inst_table_length];
+        bool extended = in->format == 3 && next_random(&seed) % 2 == 0;
+        snprintf(state->keys[i], MICROBENCH_KEY_LENGTH, "%s%s", extended ? "+" : "", in->str);
+    }
+}
+
+/**
+ * @brief 기계어 목록에 없는 지시어 이름을 고른다 (패스 1, 2에서 지시어마다 일어나는 검색).
+ */
+static void prepare_opcode_miss(microbench_state *state) {
+    static const char *const directives[] = {
+        "START", "END", "BYTE", "WORD", "RESB", "RESW", "EXTDEF", "EXTREF",
+        "CSECT", "LTORG", "EQU", "ORG", "BASE", "NOBASE", "USE",
+    };
+    unsigned int seed = state->seed;
+    int count = sizeof(directives) / sizeof(directives[0]);
+    for (int i = 0; i < MICROBENCH_KEYS; i++) {
+        snprintf(state->keys[i], MICROBENCH_KEY_LENGTH, "%s", directives[next_random(&seed) % count]);
+    }
+}
+
+static void prepare_symbol_hit(microbench_state *state) {
+    unsigned int seed = state->seed;
+    for (int i = 0; i < MICROBENCH_KEYS; i++) {
+        const symbol *sym = state->symbol_table[next_random(&seed) % state->symbol_table_length];
+        snprintf(state->keys[i], MICROBENCH_KEY_LENGTH, "%s", sym->name);
+        snprintf(state->csects[i], MICROBENCH_KEY_LENGTH, "%s", sym->csect);
+    }
+}
+
+/**
+ * @brief 테이블에 없는 심볼을 고른다. 이름이 있는 섹션과 없는 이름을 반씩 섞는다.
+ */
+static void prepare_symbol_miss(microbench_state *state) {
+    unsigned int seed = state->seed;
+    for (int i = 0; i < MICROBENCH_KEYS; i++) {
+        const symbol *sym = state->symbol_table[next_random(&seed) % state->symbol_table_length];
+        if (i % 2 == 0) {
+            snprintf(state->keys[i], MICROBENCH_KEY_LENGTH, "%s", sym->name);
+            snprintf(state->csects[i], MICROBENCH_KEY_LENGTH, "OTHER");
+        } else {
+            snprintf(state->keys[i], MICROBENCH_KEY_LENGTH, "M%04u", next_random(&seed) % 10000);
+            snprintf(state->csects[i], MICROBENCH_KEY_LENGTH, "%s", sym->csect);
+        }
+    }
+}
+
+static void prepare_literal_hit(microbench_state *state) {
+    unsigned int seed = state->seed;
+    for (int i = 0; i < MICROBENCH_KEYS; i++) {
+        const literal *lit = state->literal_table[next_random(&seed) % state->literal_table_length];
+        snprintf(state->keys[i], MICROBENCH_KEY_LENGTH, "%s", lit->literal);
+        snprintf(state->csects[i], MICROBENCH_KEY_LENGTH, "%s", lit->csect);
+    }
+}
+
+static void prepare_literal_miss(microbench_state *state) {
+    unsigned int seed = state->seed;
+    for (int i = 0; i < MICROBENCH_KEYS; i++) {
+        const literal *lit = state->literal_table[next_random(&seed) % state->literal_table_length];
+        snprintf(state->keys[i], MICROBENCH_KEY_LENGTH, "=C'%04u'", next_random(&seed) % 10000);
+        snprintf(state->csects[i], MICROBENCH_KEY_LENGTH, "%s", lit->csect);
+    }
+}
+
+/**
+ * @brief 서로 다른 리터럴 키를 만든다. add_literal/new는 테이블이 table_size개가 될
+ * 때까지 채우고 비우기를 반복하므로 해제 비용도 호출당 시간에 포함된다.
+ */
+static void prepare_literal_new(microbench_state *state) {
+    for (int i = 0; i < MICROBENCH_KEYS; i++) {
+        snprintf(state->keys[i], MICROBENCH_KEY_LENGTH, "=X'%06X'", i);
+        snprintf(state->csects[i], MICROBENCH_KEY_LENGTH, "SEC%d", i % 4);
+    }
+}
+
+static void prepare_registers(microbench_state *state) {
+    static const char *const registers[] = {"A", "X", "L", "B", "S", "T", "F", "SW"};
+    unsigned int seed = state->seed;
+    for (int i = 0; i < MICROBENCH_KEYS; i++) {
+        snprintf(state->keys[i], MICROBENCH_KEY_LENGTH, "%s", registers[next_random(&seed) % 8]);
+    }
+}
+
+static void prepare_lines(microbench_state *state) {
+    int count = sizeof(sample_lines) / sizeof(sample_lines[0]);
+    for (int i = 0; i < MICROBENCH_KEYS; i++) {
+        snprintf(state->keys[i], MICROBENCH_KEY_LENGTH, "%s", sample_lines[i % count]);
+    }
+}
+
+static long run_search_opcode(microbench_state *state, long iterations) {
+    long sum = 0;
+    for (long i = 0; i < iterations; i++) {
+        sum += search_opcode(state->keys[i & (MICROBENCH_KEYS - 1)], (const inst **)state->inst_table,
+                             state->inst_table_length);
+    }
+    return sum;
+}
+
+static long run_search_symbol(microbench_state *state, long iterations) {
+    long sum = 0;
+    for (long i = 0; i < iterations; i++) {
+        int k = i & (MICROBENCH_KEYS - 1);
+        sum += search_symbol(state->symbol_table, state->symbol_table_length,
+                             state->keys[k], state->csects[k]) != NULL;
+    }
+    return sum;
+}
+
+static long run_search_literal(microbench_state *state, long iterations) {
+    long sum = 0;
+    for (long i = 0; i < iterations; i++) {
+        int k = i & (MICROBENCH_KEYS - 1);
+        sum += search_literal(state->literal_table, state->literal_table_length,
+                              state->keys[k], state->csects[k]) != NULL;
+    }
+    return sum;
+}
+
+static long run_add_literal_new(microbench_state *state, long iterations) {
+    long sum = 0;
+    for (long i = 0; i < iterations; i++) {
+        if (state->scratch_literal_length == state->table_size ||
+            state->scratch_literal_length == MICROBENCH_KEYS) {
+            for (int j = 0; j < state->scratch_literal_length; j++) {
+                free(state->scratch_literals[j]);
+            }
+            state->scratch_literal_length = 0;
+        }
+        int k = state->scratch_literal_length;
+        add_literal(state->scratch_literals, &state->scratch_literal_length, state->keys[k], -1, state->csects[k]);
+        sum += state->scratch_literal_length;
+    }
+    return sum;
+}
+
+static long run_add_literal_dup(microbench_state *state, long iterations) {
+    long sum = 0;
+    for (long i = 0; i < iterations; i++) {
+        int k = i & (MICROBENCH_KEYS - 1);
+        add_literal(state->literal_table, &state->literal_table_length, state->keys[k], -1, state->csects[k]);
+        sum += state->literal_table_length;
+    }
+    return sum;
+}
+
+static long run_reg_code(microbench_state *state, long iterations) {
+    long sum = 0;
+    for (long i = 0; i < iterations; i++) {
+        sum += reg_code(state->keys[i & (MICROBENCH_KEYS - 1)]);
+    }
+    return sum;
+}
+
+static long run_format3or4(microbench_state *state, long iterations) {
+    char buffer[20];
+    long sum = 0;
+    for (long i = 0; i < iterations; i++) {
+        int k = i % state->instruction_count;
+        int format = state->instruction_format[k];
+        format3or4(buffer, state->instructions[k], state->instruction_opcode[k], format, 3 * k + format, -1,
+                   (const symbol **)state->copy_symbols, state->copy_symbol_length,
+                   (const literal **)state->copy_literals, state->copy_literal_length, "COPY");
+        sum += buffer[2];
+    }
+    return sum;
+}
+
+static long run_token_parsing(microbench_state *state, long iterations) {
+    token tok;
+    long sum = 0;
+    init_token(&tok);
+    for (long i = 0; i < iterations; i++) {
+        if (token_parsing(state->keys[i & (MICROBENCH_KEYS - 1)], &tok, (const inst **)state->inst_table,
+                          state->inst_table_length) == 0) {
+            sum += tok.nixbpe;
+        }
+        clear_token(&tok);
+    }
+    return sum;
+}
+
+static long run_directive(microbench_state *state, long iterations) {
+    char buffer[100];
+    long sum = 0;
+    for (long i = 0; i < iterations; i++) {
+        buffer[0] = '\0';
+        generate_directive_object_code(buffer, state->directives[i % state->directive_count]);
+        sum += buffer[0];
+    }
+    return sum;
+}
@@ -0,0 +1,79 @@
+/**
+ * @file my_microbench_20221846.h
+ * @date 2024-06-04
+ * @version 0.1.0
+ *
+ * @brief my_microbench_20221846.c를 위한 매크로 및 구조체 선언부
+ */
+
+#ifndef __MY_MICROBENCH_H__
+#define __MY_MICROBENCH_H__
+
+#include <stdbool.h>
+
+#include "my_assembler_20221846.h"
+
+#define DEFAULT_MICROBENCH_SEED 20221846
+#define DEFAULT_MICROBENCH_TABLE_SIZE 1000 /** 심볼/리터럴 테이블 크기 (MAX_TABLE_LENGTH 이하) */
+#define DEFAULT_MICROBENCH_MIN_TIME_MS 100 /** 측정 한 번의 최소 시간 */
+#define DEFAULT_MICROBENCH_REPEAT 5        /** 측정 반복 횟수 (최솟값과 중앙값을 출력한다) */
+#define MAX_MICROBENCH_REPEAT 32
+#define MICROBENCH_KEYS 1024               /** 미리 만들어 두는 검색 키 수 (2의 거듭제곱) */
+#define MICROBENCH_KEY_LENGTH 64
+#define MAX_MICROBENCH_SAMPLES 32           /** format3or4/지시어 측정에 쓰는 예제 라인의 최대 수 */
+
+/**
+ * @brief 측정 대상 함수를 호출하는 데 필요한 테이블과 입력
+ *
+ * @details
+ * 모든 입력은 측정 전에 고정 시드로 한 번만 만들어 두므로 측정 구간에는 대상 함수의
+ * 호출과 결과를 모으는 비용만 들어간다.
+ */
+typedef struct _microbench_state {
+    inst *inst_table[MAX_INST_TABLE_LENGTH];
+    int inst_table_length;
+
+    symbol *symbol_table[MAX_TABLE_LENGTH];   /** table_size개의 심볼 (섹션 4개에 나누어 둔다) */
+    int symbol_table_length;
+    literal *literal_table[MAX_TABLE_LENGTH]; /** table_size개의 리터럴 */
+    int literal_table_length;
+    literal *scratch_literals[MAX_TABLE_LENGTH]; /** add_literal/new가 채우고 비우는 테이블 */
+    int scratch_literal_length;
+
+    symbol *copy_symbols[MAX_MICROBENCH_SAMPLES];   /** format3or4용 작은 심볼 테이블 */
+    int copy_symbol_length;
+    literal *copy_literals[MAX_MICROBENCH_SAMPLES];
+    int copy_literal_length;
+    token *instructions[MAX_MICROBENCH_SAMPLES];    /** format3or4에 넘길 파싱된 명령어 */
+    int instruction_opcode[MAX_MICROBENCH_SAMPLES];
+    int instruction_format[MAX_MICROBENCH_SAMPLES];
+    int instruction_count;
+    token *directives[MAX_MICROBENCH_SAMPLES];      /** generate_directive_object_code에 넘길 BYTE/WORD */
+    int directive_count;
+
+    char keys[MICROBENCH_KEYS][MICROBENCH_KEY_LENGTH];    /** 검색 키 (경우마다 새로 채운다) */
+    char csects[MICROBENCH_KEYS][MICROBENCH_KEY_LENGTH];  /** 키와 짝을 이루는 섹션 이름 */
+    int table_size;
+    unsigned int seed;
+} microbench_state;
+
+/**
+ * @brief 측정 경우 하나
+ *
+ * @details
+ * prepare는 측정 전에 키를 채우고, run은 iterations번 대상 함수를 호출한 뒤 결과를
+ * 모은 값을 반환한다 (컴파일러가 호출을 없애지 못하게 한다).
+ */
+typedef struct _microbench_case {
+    const char *name;
+    void (*prepare)(microbench_state *state);
+    long (*run)(microbench_state *state, long iterations);
+} microbench_case;
+
+int init_microbench_state(microbench_state *state, const char *inst_table_dir, int table_size,
+                          unsigned int seed);
+void free_microbench_state(microbench_state *state);
+int run_microbench(microbench_state *state, const microbench_case *bench, long long min_time_ns,
+                   int repeat);
+
+#endif
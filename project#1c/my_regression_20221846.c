@@ -0,0 +1,436 @@
+/**
+ * @file my_regression_20221846.c
+ * @date 2024-06-06
+ * @version 0.1.0
+ *
+ * @brief 어셈블러 출력과 처리량의 회귀를 검사하는 프로그램
+ *
+ * @details
+ * regression/cases.txt에 적힌 입력(교재 예제, 매크로/프로그램 블록 예제, 생성한 대용량
+ * 입력)을 옵션과 함께 차례로 어셈블하고 output_objectcode.txt, output_symtab.txt,
+ * output_littab.txt를 regression/<이름>/의 기대 출력과 바이트 단위로 비교한다. fail로
+ * 표시한 입력은 어셈블러가 오류 코드로 종료하는지 확인한다.
+ * --baseline-assembler로 비교할 어셈블러(예: 변경 전 커밋으로 빌드한 실행 파일)를 주면
+ * perf로 표시한 입력마다 두 어셈블러를 번갈아 --repeat번씩 실행하고, 짝지은 두 실행의
+ * 시간 비의 중앙값으로 검사할 어셈블러의 처리량이 --threshold(%) 넘게 떨어졌는지 판정한다.
+ * 가장 빠른 시간으로 구한 초당 라인 수는 참고용으로만 출력한다.
+ * 같은 기계에서 같은 때에 번갈아 재므로 기계 사이의 차이나 부하 변화가 결과에 섞이지
+ * 않는다. 절대 처리량은 기계마다 다르므로 기준값을 저장소에 두지 않는다.
+ *
+ * 출력을 의도적으로 바꾼 경우에는 --update로 기대 출력을 다시 만들고 차이를 검토한 뒤
+ * 함께 커밋한다.
+ *
+ *    컴파일: gcc -O2 -o my_regression_20221846 my_regression_20221846.c -lm
+ *    사용법: my_regression_20221846 [--assembler 경로] [--inst-table 경로] [--dir 디렉터리]
+ *            [--workdir 디렉터리] [--filter 이름] [--update]
+ *            [--baseline-assembler 경로 [--threshold %] [--repeat N]]
+ */
+
+#define main benchmark_main
+#include "my_benchmark_20221846.c"
+#undef main
+
+#include "my_regression_20221846.h"
+
+static const char *const golden_outputs[] = {"output_objectcode.txt", "output_symtab.txt", "output_littab.txt"};
+
+/**
+ * @brief 명령행 옵션을 읽어 회귀 테스트를 수행한다.
+ * @return 모두 통과하면 0, 회귀가 있거나 실행에 실패하면 -1
+ */
+int main(int argc, char **argv) {
+    static regression_config config;
+    static regression_case cases[MAX_REGRESSION_CASES];
+    const char *assembler = "./my_assembler_20221846";
+    const char *baseline_assembler = NULL;
+    const char *inst_table = "inst_table.txt";
+    const char *dir = DEFAULT_REGRESSION_DIR;
+    int case_count = 0;
+
+    config.workdir = DEFAULT_REGRESSION_WORKDIR;
+    config.threshold = DEFAULT_REGRESSION_THRESHOLD;
+    config.repeat = DEFAULT_REGRESSION_REPEAT;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--update") == 0) {
+            config.update_golden = true;
+        } else if (i + 1 < argc && strcmp(argv[i], "--assembler") == 0) {
+            assembler = argv[++i];
+        } else if (i + 1 < argc && strcmp(argv[i], "--baseline-assembler") == 0) {
+            baseline_assembler = argv[++i];
+        } else if (i + 1 < argc && strcmp(argv[i], "--inst-table") == 0) {
+            inst_table = argv[++i];
+        } else if (i + 1 < argc && strcmp(argv[i], "--dir") == 0) {
+            dir = argv[++i];
+        } else if (i + 1 < argc && strcmp(argv[i], "--workdir") == 0) {
+            config.workdir = argv[++i];
+        } else if (i + 1 < argc && strcmp(argv[i], "--filter") == 0) {
+            config.filter = argv[++i];
+        } else if (i + 1 < argc && strcmp(argv[i], "--threshold") == 0) {
+            config.threshold = atoi(argv[++i]);
+        } else if (i + 1 < argc && strcmp(argv[i], "--repeat") == 0) {
+            config.repeat = atoi(argv[++i]);
+        } else {
+            fprintf(stderr, "사용법: %s [--assembler 경로] [--inst-table 경로] [--dir 디렉터리] "
+                            "[--workdir 디렉터리] [--filter 이름] [--update] "
+                            "[--baseline-assembler 경로 [--threshold %%] [--repeat N]]\n", argv[0]);
+            return -1;
+        }
+    }
+
+    if (config.threshold < 0 || config.threshold > 100 || config.repeat < 1 ||
+        config.repeat > MAX_REGRESSION_REPEAT) {
+        fprintf(stderr, "허용 감소율은 0 ~ 100, 반복 횟수는 1 ~ %d이어야 합니다.\n", MAX_REGRESSION_REPEAT);
+        return -1;
+    }
+
+    if (absolute_path(config.assembler, assembler) < 0 || absolute_path(config.inst_table, inst_table) < 0 ||
+        absolute_path(config.dir, dir) < 0) {
+        return -1;
+    }
+    if (baseline_assembler != NULL) {
+        if (absolute_path(config.baseline_assembler, baseline_assembler) < 0) {
+            return -1;
+        }
+        config.perf = true;
+    }
+    if (mkdir(config.workdir, 0755) < 0 && errno != EEXIST) {
+        perror("작업 디렉터리 생성 실패");
+        return -1;
+    }
+
+    if (read_manifest(&config, cases, &case_count) < 0) {
+        return -1;
+    }
+
+    int run = 0;
+    int failed = 0;
+    for (int i = 0; i < case_count; i++) {
+        if (config.filter != NULL && strstr(cases[i].name, config.filter) == NULL) {
+            continue;
+        }
+        run++;
+
+        int result = run_case(&config, &cases[i]);
+        if (result < 0) {
+            return -1;
+        }
+
+        if (cases[i].expect_failure) {
+            printf("%-20s %s\n", cases[i].name, result > 0 ? "오류를 검출하지 못함" : "예상대로 실패");
+            failed += result > 0;
+            continue;
+        }
+        printf("%-20s %s", cases[i].name,
+               result > 0 ? "출력 불일치" : config.update_golden ? "기대 출력 갱신" : "출력 일치");
+        // 출력이 맞는 경우에만 처리량을 잰다 (실패한 실행의 시간은 의미가 없다)
+        if (result == 0 && cases[i].perf && config.perf) {
+            double lines_per_sec;
+            double baseline_lines_per_sec;
+            double speedup;
+            if (measure_case(&config, &cases[i], &lines_per_sec, &baseline_lines_per_sec, &speedup) < 0) {
+                return -1;
+            }
+            double change = (speedup - 1) * 100;
+            printf(", %.0f lines/sec (기준 어셈블러 %.0f, %+.1f%%)", lines_per_sec, baseline_lines_per_sec,
+                   change);
+            if (change < -config.threshold) {
+                printf(" 처리량 회귀");
+                result = 1;
+            }
+        }
+        printf("\n");
+        fflush(stdout);
+
+        failed += result > 0;
+    }
+
+    printf("회귀 테스트: %d개 중 %d개 통과\n", run, run - failed);
+
+    return failed > 0 ? -1 : 0;
+}
+
+/**
+ * @brief cases.txt를 읽어 입력 목록을 만든다.
+ *
+ * @param config 회귀 테스트 설정
+ * @param cases 입력 목록을 저장할 배열
+ * @param case_count 읽은 입력 수
+ * @return 오류 코드 (정상 종료 = 0)
+ *
+ * @details
+ * '#'로 시작하는 줄과 빈 줄은 건너뛴다. 어셈블러 옵션은 공백으로 나누어 그대로 넘긴다.
+ */
+int read_manifest(const regression_config *config, regression_case cases[], int *case_count) {
+    char path[MAX_BENCHMARK_PATH * 2];
+    char line[512];
+    int line_number = 0;
+
+    snprintf(path, sizeof(path), "%s/%s", config->dir, REGRESSION_MANIFEST);
+    FILE *fp = fopen(path, "r");
+    if (fp == NULL) {
+        perror(path);
+        return -1;
+    }
+
+    *case_count = 0;
+    while (fgets(line, sizeof(line), fp) != NULL) {
+        char name[64], source[256], check[16], options[256];
+        line_number++;
+        line[strcspn(line, "\r\n")] = '\0';
+        if (line[0] == '#' || line[0] == '\0') {
+            continue;
+        }
+
+        if (sscanf(line, "%63[^\t]\t%255[^\t]\t%15[^\t]\t%255[^\n]", name, source, check, options) != 4 ||
+            strlen(name) >= sizeof(cases[0].name) ||
+            (strcmp(check, "perf") != 0 && strcmp(check, "fail") != 0 && strcmp(check, "-") != 0)) {
+            fprintf(stderr, "%s:%d: \"이름\\t소스\\tperf|fail|-\\t옵션|-\" 형식이 아닙니다.\n", path, line_number);
+            fclose(fp);
+            return -1;
+        }
+        if (*case_count == MAX_REGRESSION_CASES) {
+            fprintf(stderr, "회귀 테스트 입력이 너무 많습니다. (최대 %d개)\n", MAX_REGRESSION_CASES);
+            fclose(fp);
+            return -1;
+        }
+
+        regression_case *rc = &cases[(*case_count)++];
+        memset(rc, 0, sizeof(*rc));
+        strcpy(rc->name, name);
+        snprintf(rc->source, sizeof(rc->source), "%s/%s", config->dir, source);
+        rc->perf = strcmp(check, "perf") == 0;
+        rc->expect_failure = strcmp(check, "fail") == 0;
+        strcpy(rc->options, strcmp(options, "-") == 0 ? "" : options);
+        for (char *arg = strtok(rc->options, " \t"); arg != NULL; arg = strtok(NULL, " \t")) {
+            if (rc->arg_count == MAX_BENCHMARK_ARGS - 2) {
+                fprintf(stderr, "%s:%d: 어셈블러 옵션이 너무 많습니다.\n", path, line_number);
+                fclose(fp);
+                return -1;
+            }
+            rc->args[rc->arg_count++] = arg;
+        }
+    }
+
+    fclose(fp);
+
+    return 0;
+}
+
+/**
+ * @brief 입력 하나를 어셈블하고 기대 출력과 비교한다.
+ *
+ * @param config 회귀 테스트 설정
+ * @param rc 실행할 입력
+ * @return 통과하면 0, 출력이 다르거나 어셈블에 실패하면 (fail 입력은 오류 없이 끝나면) 1,
+ *         실행 오류 시 -1
+ *
+ * @details
+ * 이전 출력 파일을 지우고 실행하므로 어셈블러가 출력을 만들지 못하면 기대 출력과
+ * 다른 것으로 처리된다.
+ */
+int run_case(const regression_config *config, const regression_case *rc) {
+    char workdir[MAX_BENCHMARK_PATH * 2];
+    char expected[MAX_BENCHMARK_PATH * 2];
+    char actual[MAX_BENCHMARK_PATH * 3];
+    const char *argv[MAX_BENCHMARK_ARGS];
+    benchmark_sample sample;
+    int result = 0;
+
+    snprintf(workdir, sizeof(workdir), "%s/%s", config->workdir, rc->name);
+    if (mkdir(workdir, 0755) < 0 && errno != EEXIST) {
+        perror(workdir);
+        return -1;
+    }
+    snprintf(actual, sizeof(actual), "%s/input.txt", workdir);
+    if (copy_file(rc->source, actual) < 0) {
+        return -1;
+    }
+    snprintf(actual, sizeof(actual), "%s/inst_table.txt", workdir);
+    if (copy_file(config->inst_table, actual) < 0) {
+        return -1;
+    }
+    for (int i = 0; i < 3; i++) {
+        snprintf(actual, sizeof(actual), "%s/%s", workdir, golden_outputs[i]);
+        if (unlink(actual) < 0 && errno != ENOENT) {
+            perror(actual);
+            return -1;
+        }
+    }
+
+    argv[0] = config->assembler;
+    for (int i = 0; i < rc->arg_count; i++) {
+        argv[i + 1] = rc->args[i];
+    }
+    argv[rc->arg_count + 1] = NULL;
+
+    if (run_program(argv, workdir, &sample) < 0) {
+        return -1;
+    }
+    // 오류를 검출해야 하는 입력은 기대 출력 없이 오류 코드로 종료했는지만 본다 (시그널로 죽으면 실패)
+    if (rc->expect_failure) {
+        if (sample.exit_status <= 0) {
+            fprintf(stderr, "  [%s] 어셈블러가 %s\n", rc->name,
+                    sample.exit_status == 0 ? "오류 없이 종료했습니다." : "비정상 종료했습니다.");
+            return 1;
+        }
+        return 0;
+    }
+    if (sample.exit_status != 0) {
+        fprintf(stderr, "  [%s] 어셈블러가 실패했습니다. (종료 코드 %d)\n", rc->name, sample.exit_status);
+        return 1;
+    }
+
+    snprintf(expected, sizeof(expected), "%s/%s", config->dir, rc->name);
+    if (config->update_golden && mkdir(expected, 0755) < 0 && errno != EEXIST) {
+        perror(expected);
+        return -1;
+    }
+
+    for (int i = 0; i < 3; i++) {
+        snprintf(expected, sizeof(expected), "%s/%s/%s", config->dir, rc->name, golden_outputs[i]);
+        snprintf(actual, sizeof(actual), "%s/%s", workdir, golden_outputs[i]);
+
+        if (config->update_golden) {
+            if (copy_file(actual, expected) < 0) {
+                return -1;
+            }
+            continue;
+        }
+
+        char label[64];
+        snprintf(label, sizeof(label), "%s/%s", rc->name, golden_outputs[i]);
+        int err = compare_output(expected, actual, label);
+        if (err < 0) {
+            return -1;
+        }
+        result |= err;
+    }
+
+    return result;
+}
+
+/**
+ * @brief double 오름차순 비교 (qsort용)
+ */
+static int compare_doubles(const void *a, const void *b) {
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return x < y ? -1 : x > y ? 1 : 0;
+}
+
+/**
+ * @brief 입력 하나를 검사할 어셈블러와 기준 어셈블러로 번갈아 실행하여 처리량을 잰다.
+ *
+ * @param config 회귀 테스트 설정
+ * @param rc run_case로 작업 디렉터리를 준비한 입력
+ * @param lines_per_sec 검사할 어셈블러의 처리량을 저장할 주소
+ * @param baseline_lines_per_sec 기준 어셈블러의 처리량을 저장할 주소
+ * @param speedup 기준 어셈블러 대비 속도 비 (1보다 작으면 느려짐)를 저장할 주소
+ * @return 오류 코드 (정상 종료 = 0)
+ *
+ * @details
+ * 두 어셈블러를 한 번씩 번갈아 repeat번 실행한다. 처리량은 각각 가장 빠른 시간으로
+ * 계산해 보여 주기만 하고, 판정에는 바로 이어서 잰 두 실행의 시간 비율의 중앙값을 쓴다.
+ * 측정 중에 기계 부하가 바뀌어도 한 쌍 안의 두 실행에는 함께 반영되고, 중앙값이라
+ * 몇 번의 튀는 실행에 흔들리지 않는다. 어느 한쪽이 실패하면 비교할 수 없으므로
+ * 오류로 처리한다.
+ */
+int measure_case(const regression_config *config, const regression_case *rc, double *lines_per_sec,
+                 double *baseline_lines_per_sec, double *speedup) {
+    char workdir[MAX_BENCHMARK_PATH * 2];
+    const char *argv[MAX_BENCHMARK_ARGS];
+    const char *binaries[2] = {config->assembler, config->baseline_assembler};
+    long long best_ns[2] = {0, 0};
+    long long pair_ns[2];
+    double ratios[MAX_REGRESSION_REPEAT];
+    benchmark_sample sample;
+
+    snprintf(workdir, sizeof(workdir), "%s/%s", config->workdir, rc->name);
+    for (int i = 0; i < rc->arg_count; i++) {
+        argv[i + 1] = rc->args[i];
+    }
+    argv[rc->arg_count + 1] = NULL;
+
+    for (int r = 0; r < config->repeat; r++) {
+        for (int b = 0; b < 2; b++) {
+            argv[0] = binaries[b];
+            if (run_program(argv, workdir, &sample) < 0) {
+                return -1;
+            }
+            if (sample.exit_status != 0) {
+                fprintf(stderr, "  [%s] %s이(가) 실패했습니다. (종료 코드 %d)\n", rc->name, binaries[b],
+                        sample.exit_status);
+                return -1;
+            }
+            if (r == 0 || sample.nanoseconds < best_ns[b]) {
+                best_ns[b] = sample.nanoseconds;
+            }
+            pair_ns[b] = sample.nanoseconds;
+        }
+        ratios[r] = (double)pair_ns[1] / pair_ns[0];
+    }
+
+    // 바로 이어서 잰 두 실행의 비율은 그 사이의 부하 변화에 덜 흔들리므로 중앙값을 쓴다
+    qsort(ratios, config->repeat, sizeof(double), compare_doubles);
+    *speedup = config->repeat % 2 == 1 ? ratios[config->repeat / 2] :
+               (ratios[config->repeat / 2 - 1] + ratios[config->repeat / 2]) / 2;
+
+    long lines = count_lines(rc->source);
+    *lines_per_sec = lines * 1e9 / best_ns[0];
+    *baseline_lines_per_sec = lines * 1e9 / best_ns[1];
+
+    return 0;
+}
+
+/**
+ * @brief 기대 출력과 실제 출력을 바이트 단위로 비교한다.
+ *
+ * @param expected 기대 출력 파일
+ * @param actual 실제 출력 파일
+ * @param label 불일치를 알릴 때 쓰는 이름
+ * @return 같으면 0, 다르면 1 (처음 다른 줄을 출력한다), 기대 출력이 없으면 -1
+ */
+int compare_output(const char *expected, const char *actual, const char *label) {
+    char expected_line[MAX_REGRESSION_LINE];
+    char actual_line[MAX_REGRESSION_LINE];
+    int line_number = 1;
+    int result = 0;
+
+    FILE *fe = fopen(expected, "r");
+    if (fe == NULL) {
+        fprintf(stderr, "기대 출력 %s이(가) 없습니다. (--update로 만든다)\n", expected);
+        return -1;
+    }
+    FILE *fa = fopen(actual, "r");
+    if (fa == NULL) {
+        fprintf(stderr, "  [%s] 출력 파일이 없습니다.\n", label);
+        fclose(fe);
+        return 1;
+    }
+
+    for (;;) {
+        char *e = fgets(expected_line, sizeof(expected_line), fe);
+        char *a = fgets(actual_line, sizeof(actual_line), fa);
+        if (e == NULL && a == NULL) {
+            break;
+        }
+        if (e == NULL || a == NULL || strcmp(expected_line, actual_line) != 0) {
+            if (e != NULL) expected_line[strcspn(expected_line, "\n")] = '\0';
+            if (a != NULL) actual_line[strcspn(actual_line, "\n")] = '\0';
+            fprintf(stderr, "  [%s] %d번째 줄이 다릅니다.\n", label, line_number);
+            fprintf(stderr, "      기대: %s\n", e == NULL ? "(파일 끝)" : expected_line);
+            fprintf(stderr, "      실제: %s\n", a == NULL ? "(파일 끝)" : actual_line);
+            result = 1;
+            break;
+        }
+        if (strchr(expected_line, '\n') != NULL) {
+            line_number++;
+        }
+    }
+
+    fclose(fe);
+    fclose(fa);
+
+    return result;
+}
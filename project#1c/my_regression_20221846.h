@@ -0,0 +1,66 @@
+/**
+ * @file my_regression_20221846.h
+ * @date 2024-06-06
+ * @version 0.1.0
+ *
+ * @brief my_regression_20221846.c를 위한 매크로 및 구조체 선언부
+ */
+
+#ifndef __MY_REGRESSION_H__
+#define __MY_REGRESSION_H__
+
+#include <stdbool.h>
+
+#include "my_benchmark_20221846.h"
+
+#define MAX_REGRESSION_CASES 64
+#define MAX_REGRESSION_LINE 1024               /** 기대 출력 비교에 쓰는 줄 버퍼 (--text-length 0xFF의 T 레코드 포함) */
+#define DEFAULT_REGRESSION_DIR "regression"
+#define DEFAULT_REGRESSION_WORKDIR "regression_work"
+#define DEFAULT_REGRESSION_THRESHOLD 10        /** 처리량이 기준 어셈블러보다 이 비율(%) 넘게 떨어지면 실패 */
+#define DEFAULT_REGRESSION_REPEAT 15           /** 두 어셈블러를 번갈아 실행하는 횟수 */
+#define MAX_REGRESSION_REPEAT 101
+#define REGRESSION_MANIFEST "cases.txt"
+
+/**
+ * @brief 회귀 테스트 입력 하나 (cases.txt의 한 줄)
+ *
+ * @details
+ * cases.txt의 각 줄은 탭으로 구분한 "이름, 소스 경로, 검사 종류(perf, fail 또는 -),
+ * 어셈블러 옵션(없으면 -)"이다. 소스 경로는 회귀 테스트 디렉터리 기준이고,
+ * 기대 출력은 "회귀 테스트 디렉터리/이름/" 아래에 둔다. fail로 표시한 입력은 기대
+ * 출력 없이 어셈블러가 오류로 종료하는지만 확인한다.
+ */
+typedef struct _regression_case {
+    char name[32];
+    char source[MAX_BENCHMARK_PATH + 256];  /** 소스 파일 경로 */
+    bool perf;                               /** 처리량 회귀를 검사할지 여부 (--baseline-assembler를 준 경우) */
+    bool expect_failure;                     /** 어셈블러가 오류로 종료해야 하는 입력 (fail) */
+    char options[256];                       /** 어셈블러 옵션 원문 (args가 가리킨다) */
+    const char *args[MAX_BENCHMARK_ARGS];
+    int arg_count;
+} regression_case;
+
+/**
+ * @brief 회귀 테스트 설정
+ */
+typedef struct _regression_config {
+    char assembler[MAX_BENCHMARK_PATH];  /** 검사할 어셈블러의 절대 경로 */
+    char baseline_assembler[MAX_BENCHMARK_PATH]; /** 처리량을 비교할 기준 어셈블러의 절대 경로 */
+    char inst_table[MAX_BENCHMARK_PATH]; /** 기계어 목록 파일 */
+    char dir[MAX_BENCHMARK_PATH];        /** cases.txt, 기대 출력, 기준 처리량이 있는 디렉터리 */
+    const char *workdir;                 /** 어셈블러를 실행할 디렉터리 */
+    const char *filter;                  /** 이름에 이 문자열이 있는 입력만 실행 (NULL = 모두) */
+    int threshold;                       /** 기준 어셈블러 대비 허용하는 처리량 감소율 (%) */
+    int repeat;                          /** 처리량 측정 반복 횟수 (각각 가장 빠른 값을 쓴다) */
+    bool update_golden;                  /** 기대 출력을 현재 출력으로 바꾼다 */
+    bool perf;                           /** 처리량을 검사한다 (--baseline-assembler) */
+} regression_config;
+
+int read_manifest(const regression_config *config, regression_case cases[], int *case_count);
+int run_case(const regression_config *config, const regression_case *rc);
+int measure_case(const regression_config *config, const regression_case *rc, double *lines_per_sec,
+                 double *baseline_lines_per_sec, double *speedup);
+int compare_output(const char *expected, const char *actual, const char *label);
+
+#endif
@@ -0,0 +1,378 @@
+/**
+ * @file my_workload_20221846.c
+ * @date 2024-06-03
+ * @version 0.1.0
+ *
+ * @brief 성능 측정용 SIC/XE 컨트롤 섹션 프로그램을 생성하는 프로그램
+ *
+ * @details
+ * 라인 수, 컨트롤 섹션 수, 심볼/리터럴 밀도, 섹션별 EXTREF 수, BYTE 상수 길이를
+ * 정하면 my_assembler_20221846으로 어셈블하고 my_linker_20221846으로 링크할 수 있는
+ * 프로그램을 출력한다. 같은 설정과 시드는 항상 같은 프로그램을 만든다.
+ *
+ * 각 섹션은 코드 블록의 연속이다. 블록은 명령어 WORKLOAD_BLOCK_INSTRUCTIONS개와
+ * 다음 블록으로의 J(마지막 블록은 RSUB), 그리고 그 블록이 참조하는 데이터(WORD,
+ * RESW, BYTE, 리터럴 풀)로 이루어진다. 데이터를 블록마다 두므로 모든 참조가 PC 상대
+ * 주소 범위(±2K) 안에 들어가고, 4형식은 외부 심볼 호출(+JSUB)에만 쓰인다.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include "my_workload_20221846.h"
+
+#define MAX_WORKLOAD_EXTCALLS 90 /** 섹션 하나의 최대 외부 호출 수 (섹션당 M 레코드 수 제한) */
+
+static unsigned int next_random(unsigned int *state);
+static bool chance(unsigned int *state, int density);
+static void export_name(char *name, int section, int index);
+static int write_names(FILE *fp, const char *directive, char names[][10], int count);
+static int generate_section(FILE *fp, const workload_config *config, int section, int budget,
+                            unsigned int *state, workload_result *result);
+static int estimate_text_records(const workload_config *config);
+
+/**
+ * @brief 명령행 옵션에 따라 프로그램을 생성한다.
+ */
+int main(int argc, char **argv) {
+    workload_config config = {
+        .lines = DEFAULT_WORKLOAD_LINES,
+        .csects = DEFAULT_WORKLOAD_CSECTS,
+        .symbol_density = 30,
+        .literal_density = 20,
+        .extref_fanout = 4,
+        .byte_size = 16,
+        .seed = DEFAULT_WORKLOAD_SEED,
+    };
+    const char *output_dir = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (i + 1 < argc && strcmp(argv[i], "--lines") == 0) {
+            config.lines = atoi(argv[++i]);
+        } else if (i + 1 < argc && strcmp(argv[i], "--csects") == 0) {
+            config.csects = atoi(argv[++i]);
+        } else if (i + 1 < argc && strcmp(argv[i], "--symbol-density") == 0) {
+            config.symbol_density = atoi(argv[++i]);
+        } else if (i + 1 < argc && strcmp(argv[i], "--literal-density") == 0) {
+            config.literal_density = atoi(argv[++i]);
+        } else if (i + 1 < argc && strcmp(argv[i], "--extref") == 0) {
+            config.extref_fanout = atoi(argv[++i]);
+        } else if (i + 1 < argc && strcmp(argv[i], "--byte-size") == 0) {
+            config.byte_size = atoi(argv[++i]);
+        } else if (i + 1 < argc && strcmp(argv[i], "--seed") == 0) {
+            config.seed = (unsigned int)strtoul(argv[++i], NULL, 0);
+        } else if (i + 1 < argc && strcmp(argv[i], "-o") == 0) {
+            output_dir = argv[++i];
+        } else {
+            fprintf(stderr, "사용법: %s [--lines N] [--csects N] [--symbol-density %%] "
+                            "[--literal-density %%] [--extref N] [--byte-size N] [--seed N] "
+                            "[-o 출력파일]\n", argv[0]);
+            return -1;
+        }
+    }
+
+    if (check_workload_config(&config) < 0) {
+        return -1;
+    }
+
+    FILE *fp = stdout;
+    if (output_dir != NULL && (fp = fopen(output_dir, "w")) == NULL) {
+        perror("출력 파일 열기 실패");
+        return -1;
+    }
+
+    workload_result result;
+    int err = generate_workload(fp, &config, &result);
+    if (fp != stdout) {
+        fclose(fp);
+    }
+    if (err < 0) {
+        fprintf(stderr, "generate_workload: 프로그램 생성에 실패했습니다. (error_code: %d)\n", err);
+        return -1;
+    }
+
+    fprintf(stderr, "generate_workload: 라인 %d개, 섹션 %d개, 블록 %d개, 라벨 %d개, "
+                    "리터럴 참조 %d개, 외부 호출 %d개\n",
+            result.lines, config.csects, result.blocks, result.labels, result.literals, result.extcalls);
+
+    return 0;
+}
+
+/**
+ * @brief 설정이 어셈블러의 한도 안에서 유효한 프로그램을 만들 수 있는지 확인한다.
+ * @return 유효하면 0, 아니면 -1
+ *
+ * @details
+ * 섹션당 T 레코드 수는 --text-length에 따라 달라지므로 기본 길이로 추정해 한도를
+ * 넘을 것 같으면 경고만 한다.
+ */
+int check_workload_config(const workload_config *config) {
+    if (config->lines < 1 || config->lines > MAX_INPUT_LINES) {
+        fprintf(stderr, "라인 수는 1 ~ %d 사이여야 합니다.\n", MAX_INPUT_LINES);
+        return -1;
+    }
+    if (config->csects < 1 || config->csects > MAX_CONTROL_SECTION_NUM) {
+        fprintf(stderr, "컨트롤 섹션 수는 1 ~ %d 사이여야 합니다.\n", MAX_CONTROL_SECTION_NUM);
+        return -1;
+    }
+    if (config->symbol_density < 0 || config->symbol_density > 100 ||
+        config->literal_density < 0 || config->literal_density > 100) {
+        fprintf(stderr, "밀도는 0 ~ 100 사이의 백분율이어야 합니다.\n");
+        return -1;
+    }
+    if (config->extref_fanout < 0 || config->extref_fanout > MAX_WORKLOAD_EXTREFS) {
+        fprintf(stderr, "EXTREF 수는 0 ~ %d 사이여야 합니다.\n", MAX_WORKLOAD_EXTREFS);
+        return -1;
+    }
+    if (config->extref_fanout > 0 && config->csects < 2) {
+        fprintf(stderr, "외부 심볼을 참조하려면 컨트롤 섹션이 2개 이상이어야 합니다.\n");
+        return -1;
+    }
+    // 내보내는 심볼은 섹션 앞쪽 명령어의 라벨이므로 섹션마다 그만큼의 명령어가 필요하다
+    if (config->lines / config->csects < 2 * config->extref_fanout + 32) {
+        fprintf(stderr, "섹션당 라인 수(%d)가 EXTREF 수(%d)에 비해 너무 적습니다.\n",
+                config->lines / config->csects, config->extref_fanout);
+        return -1;
+    }
+    if (config->byte_size < 0 || config->byte_size > MAX_WORKLOAD_BYTE_SIZE) {
+        fprintf(stderr, "BYTE 상수 길이는 0 ~ %d 사이여야 합니다.\n", MAX_WORKLOAD_BYTE_SIZE);
+        return -1;
+    }
+
+    int records = estimate_text_records(config);
+    if (records > MAX_RECORDS) {
+        fprintf(stderr, "경고: 섹션당 T 레코드가 약 %d개로 어셈블러의 한도(%d개)를 넘을 수 있습니다. "
+                        "섹션 수를 늘리거나 --text-length를 키우십시오.\n", records, MAX_RECORDS);
+    }
+
+    return 0;
+}
+
+/**
+ * @brief 설정에 맞는 프로그램을 fp에 출력한다.
+ *
+ * @param fp 출력 파일
+ * @param config 생성 설정
+ * @param result 생성 결과를 저장할 구조체 주소
+ * @return 오류 코드 (정상 종료 = 0)
+ */
+int generate_workload(FILE *fp, const workload_config *config, workload_result *result) {
+    unsigned int state = config->seed != 0 ? config->seed : 1;
+    int err = 0;
+
+    memset(result, 0, sizeof(workload_result));
+
+    // 마지막 섹션이 나머지 라인과 END를 맡는다
+    int budget = config->lines / config->csects;
+    for (int section = 0; section < config->csects && err == 0; section++) {
+        if (section == config->csects - 1) {
+            budget = config->lines - result->lines - 1;
+        }
+        err = generate_section(fp, config, section, budget, &state, result);
+    }
+
+    if (err == 0) {
+        fprintf(fp, "\tEND\tFIRST\n");
+        result->lines++;
+    }
+
+    return ferror(fp) ? -1 : err;
+}
+
+/**
+ * @brief 컨트롤 섹션 하나를 출력한다.
+ *
+ * @param budget 이 섹션에 쓸 라인 수
+ * @return 오류 코드 (정상 종료 = 0)
+ */
+static int generate_section(FILE *fp, const workload_config *config, int section, int budget,
+                            unsigned int *state, workload_result *result) {
+    static const char *loads[] = { "LDA", "LDX", "LDT", "LDS" };
+    static const char *arithmetic[] = { "ADD", "SUB", "COMP", "AND", "OR" };
+    static const char *registers[] = { "CLEAR\tX", "COMPR\tA,S", "TIXR\tT", "CLEAR\tA" };
+    static const char *jumps[] = { "JEQ", "JLT", "JGT" };
+
+    char exports[MAX_WORKLOAD_EXTREFS][10];
+    char imports[MAX_WORKLOAD_EXTREFS][10];
+    int fanout = config->extref_fanout;
+    int lines = 0;
+    int labels = 0;
+    int exported = 0;
+    int extcalls = 0;
+
+    // 섹션 s는 다른 섹션들에서 차례로 심볼을 가져온다. k번째로 가져오는 심볼은
+    // 섹션 (s + 1 + k % (섹션 수 - 1))이 내보내는 k / (섹션 수 - 1)번째 심볼이다.
+    for (int k = 0; k < fanout; k++) {
+        int other = (section + 1 + k % (config->csects - 1)) % config->csects;
+        export_name(exports[k], section, k);
+        export_name(imports[k], other, k / (config->csects - 1));
+    }
+
+    fprintf(fp, "SEC%03d\t%s\t0\n", section, section == 0 ? "START" : "CSECT");
+    lines++;
+    lines += write_names(fp, "EXTDEF", exports, fanout);
+    lines += write_names(fp, "EXTREF", imports, fanout);
+
+    for (int block = 0; lines < budget; block++) {
+        char last_label[12];
+        bool literal_used = false;
+
+        // 블록 하나: 라벨 달린 첫 명령어 ~ J, WORD/RESW, BYTE, LTORG
+        int data_lines = 1 + WORKLOAD_BLOCK_WORDS + (config->byte_size > 0) + 1;
+        int count = budget - lines - data_lines;
+        if (count > WORKLOAD_BLOCK_INSTRUCTIONS) count = WORKLOAD_BLOCK_INSTRUCTIONS;
+        if (count < 1) count = 1;
+
+        for (int i = 0; i < count; i++) {
+            // 블록의 첫 명령어에는 J가 가리킬 블록 라벨을, 그 뒤에는 내보낼 심볼을 먼저 붙인다
+            char label[12] = "";
+            if (i == 0) {
+                if (section == 0 && block == 0) strcpy(label, "FIRST");
+                else sprintf(label, "B%d", block);
+            } else if (exported < fanout) {
+                strcpy(label, exports[exported++]);
+            } else if (chance(state, config->symbol_density)) {
+                sprintf(label, "L%d", labels);
+            }
+            if (label[0] != '\0') {
+                labels++;
+                strcpy(last_label, label);
+            }
+
+            int word = block * WORKLOAD_BLOCK_WORDS + next_random(state) % WORKLOAD_BLOCK_WORDS;
+            int kind = next_random(state) % 100;
+            fprintf(fp, "%s\t", label);
+            if (fanout > 0 && kind < 6 && extcalls < MAX_WORKLOAD_EXTCALLS) {
+                fprintf(fp, "+JSUB\t%s\n", imports[extcalls++ % fanout]);
+                result->extcalls++;
+            } else if (kind < 30) {
+                const char *load = loads[next_random(state) % 4];
+                if (chance(state, config->literal_density)) {
+                    // 같은 리터럴은 앞 블록의 풀에서 재사용되어 PC 상대 범위를 벗어나므로 값이 겹치지 않게 한다
+                    fprintf(fp, "%s\t=X'%06X'\n", load, (next_random(state) % 0x100) << 16 | result->literals);
+                    literal_used = true;
+                    result->literals++;
+                } else {
+                    fprintf(fp, "%s\tW%d\n", load, word);
+                }
+            } else if (kind < 45) {
+                fprintf(fp, "STA\tW%d\n", word);
+            } else if (kind < 60) {
+                fprintf(fp, "%s\tW%d\n", arithmetic[next_random(state) % 5], word);
+            } else if (kind < 70) {
+                fprintf(fp, "COMP\t#%d\n", next_random(state) % 4096);
+            } else if (kind < 80) {
+                fprintf(fp, "%s\n", registers[next_random(state) % 4]);
+            } else if (kind < 90 || config->byte_size == 0) {
+                fprintf(fp, "%s\t%s\n", jumps[next_random(state) % 3], last_label);
+            } else {
+                fprintf(fp, "LDCH\tP%d,X\n", block);
+            }
+            lines++;
+        }
+
+        // 다음 블록으로 건너뛰어 데이터 영역을 실행하지 않는다
+        bool last = lines + data_lines - !literal_used >= budget;
+        if (last) {
+            fprintf(fp, "\tRSUB\n");
+        } else {
+            fprintf(fp, "\tJ\tB%d\n", block + 1);
+        }
+        lines++;
+
+        for (int k = 0; k < WORKLOAD_BLOCK_WORDS; k++) {
+            int word = block * WORKLOAD_BLOCK_WORDS + k;
+            if (k == WORKLOAD_BLOCK_WORDS - 1) {
+                fprintf(fp, "W%d\tRESW\t1\n", word);
+            } else {
+                fprintf(fp, "W%d\tWORD\t%d\n", word, next_random(state) % 0x10000);
+            }
+            lines++;
+        }
+
+        if (config->byte_size > 0) {
+            fprintf(fp, "P%d\tBYTE\tC'", block);
+            for (int k = 0; k < config->byte_size; k++) {
+                fputc('A' + next_random(state) % 26, fp);
+            }
+            fprintf(fp, "'\n");
+            lines++;
+        }
+
+        // 블록에서 쓴 리터럴은 블록 바로 뒤에 두어 PC 상대 주소로 닿게 한다
+        if (literal_used) {
+            fprintf(fp, "\tLTORG\n");
+            lines++;
+        }
+        result->blocks++;
+    }
+
+    result->lines += lines;
+    result->labels += labels;
+
+    return 0;
+}
+
+/**
+ * @brief EXTDEF/EXTREF 라인을 한 라인에 WORKLOAD_NAMES_PER_LINE개씩 출력한다.
+ * @return 출력한 라인 수
+ */
+static int write_names(FILE *fp, const char *directive, char names[][10], int count) {
+    int lines = 0;
+
+    for (int i = 0; i < count; i += WORKLOAD_NAMES_PER_LINE) {
+        fprintf(fp, "\t%s\t", directive);
+        for (int j = i; j < count && j < i + WORKLOAD_NAMES_PER_LINE; j++) {
+            fprintf(fp, "%s%s", j > i ? "," : "", names[j]);
+        }
+        fprintf(fp, "\n");
+        lines++;
+    }
+
+    return lines;
+}
+
+/**
+ * @brief 섹션 하나의 T 레코드 수를 기본 레코드 길이(DEFAULT_TEXT_RECORD_LENGTH) 기준으로 추정한다.
+ *
+ * @details
+ * 블록마다 코드와 WORD는 이어지고 RESW에서 레코드가 끊기며, BYTE와 리터럴 풀은
+ * 다음 블록의 코드와 이어진다.
+ */
+static int estimate_text_records(const workload_config *config) {
+    int lines_per_block = WORKLOAD_BLOCK_INSTRUCTIONS + 1 + WORKLOAD_BLOCK_WORDS + (config->byte_size > 0) + 1;
+    int blocks = (config->lines / config->csects + lines_per_block - 1) / lines_per_block;
+    int code_bytes = WORKLOAD_BLOCK_INSTRUCTIONS * 3 + 3 + (WORKLOAD_BLOCK_WORDS - 1) * 3;
+    int data_bytes = config->byte_size + 3;
+
+    return blocks * ((code_bytes + DEFAULT_TEXT_RECORD_LENGTH - 1) / DEFAULT_TEXT_RECORD_LENGTH +
+                     (data_bytes + DEFAULT_TEXT_RECORD_LENGTH - 1) / DEFAULT_TEXT_RECORD_LENGTH);
+}
+
+/**
+ * @brief xorshift32 난수를 반환한다.
+ */
+static unsigned int next_random(unsigned int *state) {
+    unsigned int x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+/**
+ * @brief density 퍼센트의 확률로 true를 반환한다.
+ */
+static bool chance(unsigned int *state, int density) {
+    return (int)(next_random(state) % 100) < density;
+}
+
+/**
+ * @brief 섹션 section이 내보내는 index번째 외부 심볼의 이름을 만든다. (6글자, 예: E01003)
+ */
+static void export_name(char *name, int section, int index) {
+    sprintf(name, "E%02d%03d", section, index);
+}
@@ -0,0 +1,60 @@
+/**
+ * @file my_workload_20221846.h
+ * @date 2024-06-03
+ * @version 0.1.0
+ *
+ * @brief my_workload_20221846.c를 위한 매크로 및 구조체 선언부
+ */
+
+#ifndef __MY_WORKLOAD_H__
+#define __MY_WORKLOAD_H__
+
+#include <stdio.h>
+#include <stdbool.h>
+
+#include "my_assembler_20221846.h"
+
+#define DEFAULT_WORKLOAD_LINES 1000
+#define DEFAULT_WORKLOAD_CSECTS 4
+#define DEFAULT_WORKLOAD_SEED 20221846
+
+#define WORKLOAD_BLOCK_INSTRUCTIONS 24 /** 블록 하나의 명령어 수 */
+#define WORKLOAD_BLOCK_WORDS 4         /** 블록 하나의 WORD/RESW 데이터 수 */
+#define MAX_WORKLOAD_BYTE_SIZE 1024    /** BYTE 상수 하나의 최대 길이 (J가 데이터 영역을 건너뛸 수 있어야 한다) */
+#define MAX_WORKLOAD_EXTREFS 64        /** 섹션 하나가 참조하는 외부 심볼의 최대 수 (M 레코드 수 제한) */
+#define WORKLOAD_NAMES_PER_LINE 3      /** EXTDEF/EXTREF 한 라인의 최대 심볼 수 (MAX_OPERAND_PER_INST) */
+
+/**
+ * @brief 생성할 프로그램의 모양을 정하는 설정
+ *
+ * @details
+ * 밀도는 모두 백분율(0 ~ 100)이다. 생성한 프로그램은 my_assembler_20221846의
+ * 고정 크기 테이블(MAX_INPUT_LINES, 섹션당 MAX_RECORDS개의 T/M 레코드,
+ * MAX_CONTROL_SECTION_NUM개의 섹션) 안에서 어셈블되고 링크될 수 있어야 하므로
+ * 범위를 벗어나는 값은 check_workload_config가 거부한다.
+ */
+typedef struct _workload_config {
+    int lines;            /** 생성할 소스 라인 수 (대략) */
+    int csects;           /** 컨트롤 섹션 수 */
+    int symbol_density;   /** 라벨을 붙일 명령어의 비율 */
+    int literal_density;  /** 리터럴을 피연산자로 쓰는 적재 명령어의 비율 */
+    int extref_fanout;    /** 섹션마다 다른 섹션에서 가져오는 외부 심볼 수 */
+    int byte_size;        /** 블록마다 두는 BYTE C'...' 상수의 길이 (0이면 두지 않음) */
+    unsigned int seed;    /** 난수 시드 (같은 설정과 시드는 항상 같은 프로그램을 만든다) */
+} workload_config;
+
+/**
+ * @brief 생성 결과
+ */
+typedef struct _workload_result {
+    int lines;      /** 실제로 출력한 라인 수 */
+    int blocks;     /** 출력한 코드 블록 수 */
+    int labels;     /** 정의한 라벨 수 */
+    int literals;   /** 리터럴을 사용한 명령어 수 */
+    int extcalls;   /** 외부 심볼을 호출한 명령어 수 */
+} workload_result;
+
+int check_workload_config(const workload_config *config);
+int generate_workload(FILE *fp, const workload_config *config, workload_result *result);
+
+#endif
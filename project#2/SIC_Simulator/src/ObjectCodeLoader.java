@@ -3,6 +3,12 @@ import java.io.FileReader;
 import java.util.ArrayList;
 import java.util.List;
 import java.io.IOException;
+import java.nio.ByteOrder;
+import java.nio.MappedByteBuffer;
+import java.nio.channels.FileChannel;
+import java.nio.charset.StandardCharsets;
+import java.nio.file.Paths;
+import java.nio.file.StandardOpenOption;
 
 public class ObjectCodeLoader {
 	private ResourceManager resourceManager;
@@ -33,7 +39,19 @@ public class ObjectCodeLoader {
         }
     }
 
+    // 링커(my_linker -f image)가 만든 메모리 이미지 파일의 형식 정보
+    private static final byte[] IMAGE_MAGIC = {'S', 'X', 'I', 'M'};
+    private static final int IMAGE_HEADER_SIZE = 32;
+    private static final int IMAGE_ENTRY_SIZE = 16;
+    private static final int IMAGE_NAME_LENGTH = 8;
+
     public void load(String filePath) throws IOException {
+    	 // 메모리 이미지 파일이면 레코드 파싱 없이 바로 적재
+    	 if (isMemoryImage(filePath)) {
+    		 loadImage(filePath);
+    		 return;
+    	 }
+
     	 try (BufferedReader br = new BufferedReader(new FileReader(filePath))) {
              String line;
              while ((line = br.readLine()) != null) {
@@ -50,6 +68,9 @@ public class ObjectCodeLoader {
                      case 'T':
                          handleTextRecord(line);
                          break;
+                     case 'B':
+                         handleBitmaskTextRecord(line);
+                         break;
                      case 'M':
                          handleModificationRecord(line);
                          break;
@@ -120,6 +141,25 @@ public class ObjectCodeLoader {
         }   
     }
     
+    // 재배치 비트마스크가 붙은 T 레코드 (my_assembler --reloc-bitmask)
+    private void handleBitmaskTextRecord(String line) {
+        int byteCount = Integer.parseInt(line.substring(7, 9), 16);
+        int maskDigits = (byteCount + 3) / 4;
+        String mask = line.substring(9, 9 + maskDigits);
+
+        // 마스크를 떼어 낸 나머지는 일반 T 레코드와 같다
+        handleTextRecord("T" + line.substring(1, 9) + line.substring(9 + maskDigits));
+
+        // 비트가 켜진 바이트부터 3바이트에 현재 섹션의 로드 주소를 더한다
+        int address = Integer.parseInt(line.substring(1, 7), 16);
+        for (int i = 0; i < byteCount; i++) {
+            int digit = Character.digit(mask.charAt(i / 4), 16);
+            if ((digit & (0x08 >> (i % 4))) != 0) {
+                modificationRecords.add(new ModificationRecord(address + i, 6, "+", currentSection, currentSection));
+            }
+        }
+    }
+
     private void handleModificationRecord(String line) {
     	 String startAddress = line.substring(1, 7).trim();
          int length = Integer.parseInt(line.substring(7, 9).trim());
@@ -180,6 +220,87 @@ public class ObjectCodeLoader {
             }
         }
     }   
-}
 
+    private boolean isMemoryImage(String filePath) throws IOException {
+        try (FileChannel channel = FileChannel.open(Paths.get(filePath), StandardOpenOption.READ)) {
+            if (channel.size() < IMAGE_HEADER_SIZE) {
+                return false;
+            }
+            MappedByteBuffer buffer = channel.map(FileChannel.MapMode.READ_ONLY, 0, IMAGE_MAGIC.length);
+            for (byte b : IMAGE_MAGIC) {
+                if (buffer.get() != b) {
+                    return false;
+                }
+            }
+            return true;
+        }
+    }
+
+    // 재배치가 끝난 메모리 이미지를 매핑하여 그대로 메모리에 복사한다
+    // 레코드 수와 무관하게 메모리 길이에만 비례하는 시간이 걸린다
+    public void loadImage(String filePath) throws IOException {
+        try (FileChannel channel = FileChannel.open(Paths.get(filePath), StandardOpenOption.READ)) {
+            MappedByteBuffer image = channel.map(FileChannel.MapMode.READ_ONLY, 0, channel.size());
+            image.order(ByteOrder.BIG_ENDIAN);
+
+            int entry = image.getInt(8);
+            int progAddr = image.getInt(12);
+            int memoryLength = image.getInt(16);
+            int memoryOffset = image.getInt(20);
+            int sectionCount = image.getInt(24);
+            int symbolCount = image.getInt(28);
 
+            if (memoryOffset + (long) memoryLength > channel.size()
+                    || progAddr + memoryLength > resourceManager.getMemorySize()) {
+                throw new IllegalArgumentException("Invalid memory image: " + filePath);
+            }
+
+            // 섹션 테이블: 각 컨트롤 섹션을 이미 재배치된 주소에 등록
+            int position = IMAGE_HEADER_SIZE;
+            String firstSection = null;
+            for (int i = 0; i < sectionCount; i++, position += IMAGE_ENTRY_SIZE) {
+                String name = readImageName(image, position);
+                int csAddr = image.getInt(position + 8);
+                int length = image.getInt(position + 12);
+
+                resourceManager.setCurrentControlSection(name);
+                resourceManager.setProgname(name, name);
+                resourceManager.setProgLength(String.format("%06X", length), name);
+                resourceManager.setStartADDR(String.format("%06X", 0), name);
+                resourceManager.setProgramCounter(name, csAddr);
+                resourceManager.updateCurrentLoadAddress(length);
+                if (firstSection == null) {
+                    firstSection = name;
+                }
+            }
+
+            // 심볼 테이블: ESTAB의 절대 주소를 그대로 등록
+            for (int i = 0; i < symbolCount; i++, position += IMAGE_ENTRY_SIZE) {
+                resourceManager.symtabList.putSymbol(readImageName(image, position), image.getInt(position + 8));
+            }
+
+            // 메모리 내용은 파싱 없이 바이트 단위로 복사
+            image.position(memoryOffset);
+            for (int i = 0; i < memoryLength; i++) {
+                resourceManager.setMemory(progAddr + i, image.get() & 0xFF);
+            }
+
+            if (firstSection != null) {
+                resourceManager.setCurrentControlSection(firstSection);
+            }
+            resourceManager.setFirstInstructionAddress(String.format("%06X", entry));
+        }
+    }
+
+    private static String readImageName(MappedByteBuffer image, int position) {
+        byte[] name = new byte[IMAGE_NAME_LENGTH];
+        for (int i = 0; i < IMAGE_NAME_LENGTH; i++) {
+            name[i] = image.get(position + i);
+        }
+        int length = 0;
+        while (length < IMAGE_NAME_LENGTH && name[length] != 0) {
+            length++;
+        }
+        return new String(name, 0, length, StandardCharsets.US_ASCII);
+    }
+}